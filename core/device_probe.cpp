@@ -0,0 +1,446 @@
+#include "device_probe.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <utility>
+
+#include "model_profile.h"
+
+namespace {
+const char kHwmonBase[] = "/sys/class/hwmon";
+const char kThermalBase[] = "/sys/class/thermal";
+const char kDmiBase[] = "/sys/class/dmi/id";
+const char kManifestMagic[8] = {'F', 'A', 'N', 'S', 'C', 'A', 'P', '\0'};
+
+// Header manifest: theo sau la hwmonCount HwmonEntry va thermalCount ThermalZoneEntry.
+struct ManifestHeader {
+  char magic[8];
+  quint32 version;
+  quint32 hwmonEntrySize;
+  quint32 thermalEntrySize;
+  quint32 hwmonCount;
+  quint32 thermalCount;
+  quint32 reserved;
+  quint64 fingerprint;
+  DeviceProbe::DmiInfo dmi;
+};
+
+constexpr quint64 kFnvOffset = 1469598103934665603ULL;
+constexpr quint64 kFnvPrime = 1099511628211ULL;
+
+quint64 fnv1a(quint64 hash, const char *data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+quint64 fnv1a(quint64 hash, const char *text) {
+  // Them ca ky tu ket thuc de "ab"+"c" khac "a"+"bc".
+  return fnv1a(hash, text, std::strlen(text) + 1);
+}
+
+// Doc file sysfs nho vao buf (da cat khoang trang cuoi). Tra ve do dai, -1 neu loi.
+ssize_t readSmallFile(const char *path, char *buf, size_t cap) {
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    buf[0] = '\0';
+    return -1;
+  }
+  ssize_t n = ::read(fd, buf, cap - 1);
+  ::close(fd);
+  if (n < 0) {
+    buf[0] = '\0';
+    return -1;
+  }
+  while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ' || buf[n - 1] == '\t')) {
+    --n;
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+double elapsedMsSince(const timespec &start) {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// Liet ke ten thu muc con co tien to cho truoc, sap xep theo chi so so hoc
+// (hwmon2 truoc hwmon10) de thu tu on dinh giua cac lan chay.
+std::vector<std::string> listIndexed(const char *base, const char *prefix) {
+  std::vector<std::string> names;
+  DIR *dir = ::opendir(base);
+  if (!dir) {
+    return names;
+  }
+  const size_t prefixLen = std::strlen(prefix);
+  while (const dirent *entry = ::readdir(dir)) {
+    if (std::strncmp(entry->d_name, prefix, prefixLen) == 0) {
+      names.emplace_back(entry->d_name);
+    }
+  }
+  ::closedir(dir);
+  std::sort(names.begin(), names.end(), [prefixLen](const std::string &a, const std::string &b) {
+    return std::atoi(a.c_str() + prefixLen) < std::atoi(b.c_str() + prefixLen);
+  });
+  return names;
+}
+
+// Phan tich ten thuoc tinh dang <prefix><N><suffix> (vd. temp3_input). Tra ve N hoac 0.
+int channelOf(const char *name, const char *prefix, const char *suffix) {
+  const size_t prefixLen = std::strlen(prefix);
+  if (std::strncmp(name, prefix, prefixLen) != 0) {
+    return 0;
+  }
+  char *end = nullptr;
+  const long index = std::strtol(name + prefixLen, &end, 10);
+  if (end == name + prefixLen || std::strcmp(end, suffix) != 0) {
+    return 0;
+  }
+  return (index >= 1 && index <= DeviceProbe::kMaxChannels) ? static_cast<int>(index) : 0;
+}
+
+void readDmi(DeviceProbe::DmiInfo *dmi) {
+  char path[128];
+  std::snprintf(path, sizeof(path), "%s/product_name", kDmiBase);
+  readSmallFile(path, dmi->productName, sizeof(dmi->productName));
+  std::snprintf(path, sizeof(path), "%s/sys_vendor", kDmiBase);
+  readSmallFile(path, dmi->sysVendor, sizeof(dmi->sysVendor));
+  std::snprintf(path, sizeof(path), "%s/board_name", kDmiBase);
+  readSmallFile(path, dmi->boardName, sizeof(dmi->boardName));
+}
+
+// Truong chuoi co dinh cua manifest phai co '\0' trong pham vi cua no (file hong/sua tay
+// co the khong co, khi do strlen/fromUtf8 doc tran sang truong sau).
+template <size_t N>
+bool terminated(const char (&field)[N]) {
+  return std::memchr(field, '\0', N) != nullptr;
+}
+
+void appendMask(QByteArray *out, const char *prefix, quint32 mask) {
+  for (int i = 0; i < DeviceProbe::kMaxChannels; ++i) {
+    if (mask & (1u << i)) {
+      out->append(' ').append(prefix).append(QByteArray::number(i + 1));
+    }
+  }
+}
+}  // namespace
+
+DeviceProbe::Capabilities DeviceProbe::load(const QString &manifestPath) {
+  timespec start{};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  const quint64 fingerprint = computeFingerprint();
+  Capabilities caps;
+  if (!manifestPath.isEmpty() && readManifest(manifestPath, fingerprint, &caps)) {
+    // Quyen ghi co the doi (udev, chmod) ma khong lam doi van tay: kiem tra lai rieng.
+    char path[192];
+    for (HwmonEntry &entry : caps.hwmons) {
+      entry.pwmWritableMask = 0;
+      for (int i = 0; i < kMaxChannels; ++i) {
+        if (entry.pwmMask & (1u << i)) {
+          std::snprintf(path, sizeof(path), "%s/pwm%d", entry.path, i + 1);
+          if (::access(path, W_OK) == 0) {
+            entry.pwmWritableMask |= 1u << i;
+          }
+        }
+      }
+    }
+    caps.fromManifest = true;
+    caps.elapsedMs = elapsedMsSince(start);
+    return caps;
+  }
+
+  caps = probe();
+  caps.fingerprint = fingerprint;
+  if (!manifestPath.isEmpty()) {
+    writeManifest(manifestPath, caps);  // Loi ghi cache khong anh huong ket qua do.
+  }
+  caps.elapsedMs = elapsedMsSince(start);
+  return caps;
+}
+
+DeviceProbe::Capabilities DeviceProbe::probe() {
+  timespec start{};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  Capabilities caps;
+  readDmi(&caps.dmi);
+
+  char path[192];
+  for (const std::string &dirName : listIndexed(kHwmonBase, "hwmon")) {
+    HwmonEntry entry{};
+    std::snprintf(entry.path, sizeof(entry.path), "%s/%s", kHwmonBase, dirName.c_str());
+    std::snprintf(path, sizeof(path), "%s/name", entry.path);
+    readSmallFile(path, entry.name, sizeof(entry.name));
+
+    DIR *dir = ::opendir(entry.path);
+    if (!dir) {
+      continue;
+    }
+    while (const dirent *attr = ::readdir(dir)) {
+      int channel = 0;
+      if ((channel = channelOf(attr->d_name, "temp", "_input")) > 0) {
+        entry.tempMask |= 1u << (channel - 1);
+      } else if ((channel = channelOf(attr->d_name, "fan", "_input")) > 0) {
+        entry.fanMask |= 1u << (channel - 1);
+      } else if ((channel = channelOf(attr->d_name, "pwm", "_enable")) > 0) {
+        entry.pwmEnableMask |= 1u << (channel - 1);
+      } else if ((channel = channelOf(attr->d_name, "pwm", "")) > 0) {
+        entry.pwmMask |= 1u << (channel - 1);
+        std::snprintf(path, sizeof(path), "%s/%s", entry.path, attr->d_name);
+        if (::access(path, W_OK) == 0) {
+          entry.pwmWritableMask |= 1u << (channel - 1);
+        }
+      }
+    }
+    ::closedir(dir);
+    caps.hwmons.push_back(entry);
+  }
+
+  for (const std::string &dirName : listIndexed(kThermalBase, "thermal_zone")) {
+    ThermalZoneEntry zone{};
+    std::snprintf(zone.path, sizeof(zone.path), "%s/%s", kThermalBase, dirName.c_str());
+    std::snprintf(path, sizeof(path), "%s/type", zone.path);
+    readSmallFile(path, zone.type, sizeof(zone.type));
+    caps.thermalZones.push_back(zone);
+  }
+
+  caps.elapsedMs = elapsedMsSince(start);
+  return caps;
+}
+
+quint64 DeviceProbe::computeFingerprint() {
+  quint64 hash = kFnvOffset;
+  hash = fnv1a(hash, reinterpret_cast<const char *>(&kManifestVersion), sizeof(kManifestVersion));
+
+  utsname uts{};
+  if (::uname(&uts) == 0) {
+    hash = fnv1a(hash, uts.release);
+    hash = fnv1a(hash, uts.version);
+  }
+
+  DmiInfo dmi{};
+  readDmi(&dmi);
+  hash = fnv1a(hash, dmi.productName);
+  hash = fnv1a(hash, dmi.sysVendor);
+  hash = fnv1a(hash, dmi.boardName);
+
+  // Tap hwmon: chi so thu muc co the doi sau khi nap lai driver nen lay ca name.
+  char path[192];
+  char name[64];
+  for (const std::string &dirName : listIndexed(kHwmonBase, "hwmon")) {
+    std::snprintf(path, sizeof(path), "%s/%s/name", kHwmonBase, dirName.c_str());
+    readSmallFile(path, name, sizeof(name));
+    hash = fnv1a(hash, dirName.c_str());
+    hash = fnv1a(hash, name);
+  }
+  for (const std::string &dirName : listIndexed(kThermalBase, "thermal_zone")) {
+    hash = fnv1a(hash, dirName.c_str());
+  }
+  return hash;
+}
+
+QByteArray DeviceProbe::encodeManifest(const Capabilities &caps) {
+  ManifestHeader header{};
+  std::memcpy(header.magic, kManifestMagic, sizeof(header.magic));
+  header.version = kManifestVersion;
+  header.hwmonEntrySize = sizeof(HwmonEntry);
+  header.thermalEntrySize = sizeof(ThermalZoneEntry);
+  header.hwmonCount = static_cast<quint32>(caps.hwmons.size());
+  header.thermalCount = static_cast<quint32>(caps.thermalZones.size());
+  header.fingerprint = caps.fingerprint;
+  header.dmi = caps.dmi;
+
+  QByteArray data(reinterpret_cast<const char *>(&header), sizeof(header));
+  data.append(reinterpret_cast<const char *>(caps.hwmons.data()),
+              static_cast<qsizetype>(caps.hwmons.size() * sizeof(HwmonEntry)));
+  data.append(reinterpret_cast<const char *>(caps.thermalZones.data()),
+              static_cast<qsizetype>(caps.thermalZones.size() * sizeof(ThermalZoneEntry)));
+  return data;
+}
+
+bool DeviceProbe::decodeManifest(const char *bytes, size_t size, Capabilities *caps) {
+  if (size < sizeof(ManifestHeader)) {
+    return false;
+  }
+  ManifestHeader header{};
+  std::memcpy(&header, bytes, sizeof(header));
+  const size_t expectedSize = sizeof(ManifestHeader) +
+                              size_t(header.hwmonCount) * sizeof(HwmonEntry) +
+                              size_t(header.thermalCount) * sizeof(ThermalZoneEntry);
+  if (std::memcmp(header.magic, kManifestMagic, sizeof(kManifestMagic)) != 0 ||
+      header.version != kManifestVersion || header.hwmonEntrySize != sizeof(HwmonEntry) ||
+      header.thermalEntrySize != sizeof(ThermalZoneEntry) || size != expectedSize) {
+    return false;
+  }
+  const char *cursor = bytes + sizeof(ManifestHeader);
+  Capabilities decoded;
+  decoded.dmi = header.dmi;
+  decoded.fingerprint = header.fingerprint;
+  decoded.hwmons.resize(header.hwmonCount);
+  std::memcpy(decoded.hwmons.data(), cursor, header.hwmonCount * sizeof(HwmonEntry));
+  cursor += header.hwmonCount * sizeof(HwmonEntry);
+  decoded.thermalZones.resize(header.thermalCount);
+  std::memcpy(decoded.thermalZones.data(), cursor,
+              header.thermalCount * sizeof(ThermalZoneEntry));
+
+  // Chuoi khong ket thuc: coi nhu manifest hong (nguoi goi se do lai phan cung).
+  bool strings = terminated(decoded.dmi.productName) && terminated(decoded.dmi.sysVendor) &&
+                 terminated(decoded.dmi.boardName);
+  for (const HwmonEntry &entry : decoded.hwmons) {
+    strings = strings && terminated(entry.path) && terminated(entry.name);
+  }
+  for (const ThermalZoneEntry &zone : decoded.thermalZones) {
+    strings = strings && terminated(zone.path) && terminated(zone.type);
+  }
+  if (!strings) {
+    return false;
+  }
+  caps->dmi = decoded.dmi;
+  caps->fingerprint = decoded.fingerprint;
+  caps->hwmons = std::move(decoded.hwmons);
+  caps->thermalZones = std::move(decoded.thermalZones);
+  return true;
+}
+
+bool DeviceProbe::writeManifest(const QString &path, const Capabilities &caps) {
+  if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+    return false;
+  }
+  const QByteArray data = encodeManifest(caps);
+
+  // Ghi ra file tam roi rename de tien trinh khac khong bao gio mmap phai file do dang.
+  const QByteArray finalPath = QFile::encodeName(path);
+  const QByteArray tmpPath = finalPath + ".tmp." + QByteArray::number(::getpid());
+  const int fd = ::open(tmpPath.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  const ssize_t written = ::write(fd, data.constData(), static_cast<size_t>(data.size()));
+  ::close(fd);
+  if (written != data.size() || ::rename(tmpPath.constData(), finalPath.constData()) != 0) {
+    ::unlink(tmpPath.constData());
+    return false;
+  }
+  return true;
+}
+
+bool DeviceProbe::readManifest(const QString &path, quint64 expectedFingerprint,
+                               Capabilities *caps) {
+  const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ManifestHeader))) {
+    ::close(fd);
+    return false;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+
+  Capabilities decoded;
+  const bool ok = decodeManifest(static_cast<const char *>(mapped), size, &decoded) &&
+                  decoded.fingerprint == expectedFingerprint;
+  if (ok) {
+    caps->dmi = decoded.dmi;
+    caps->fingerprint = decoded.fingerprint;
+    caps->hwmons = std::move(decoded.hwmons);
+    caps->thermalZones = std::move(decoded.thermalZones);
+  }
+  ::munmap(mapped, size);
+  return ok;
+}
+
+QString DeviceProbe::defaultManifestPath() {
+  QString cacheHome = qEnvironmentVariable("XDG_CACHE_HOME");
+  if (cacheHome.isEmpty()) {
+    cacheHome = QDir::homePath() + "/.cache";
+  }
+  return cacheHome + "/fans-controller/capabilities.bin";
+}
+
+const DeviceProbe::HwmonEntry *DeviceProbe::findHwmon(const Capabilities &caps,
+                                                       const QStringList &needles) {
+  for (const HwmonEntry &entry : caps.hwmons) {
+    const QString name = QString::fromUtf8(entry.name).toLower();
+    for (const QString &needle : needles) {
+      if (name.contains(needle.toLower())) {
+        return &entry;
+      }
+    }
+  }
+  return nullptr;
+}
+
+QByteArray DeviceProbe::formatReport(const Capabilities &caps) {
+  QByteArray out;
+  out.append("Model: ").append(caps.dmi.productName);
+  out.append(" (vendor: ").append(caps.dmi.sysVendor);
+  out.append(", board: ").append(caps.dmi.boardName).append(")\n");
+  const ModelProfile &profile = ModelProfile::select(caps.dmi.productName);
+  out.append("Profile: ").append(profile.id).append(" (").append(profile.displayName);
+  out.append(", presets ").append(QByteArray::number(profile.silentPercent)).append('/');
+  out.append(QByteArray::number(profile.performancePercent)).append('/');
+  out.append(QByteArray::number(profile.turboPercent)).append("%, critical ");
+  out.append(QByteArray::number(profile.criticalC, 'f', 0)).append(" C)\n");
+
+  bool canTemp = false;
+  bool canFan = false;
+  bool canPwm = false;
+  bool canWritePwm = false;
+  out.append("\nhwmon devices:\n");
+  for (const HwmonEntry &entry : caps.hwmons) {
+    out.append("  ").append(entry.path).append(" (name: ").append(entry.name).append(")");
+    appendMask(&out, "temp", entry.tempMask);
+    appendMask(&out, "fan", entry.fanMask);
+    appendMask(&out, "pwm", entry.pwmMask);
+    if (entry.pwmWritableMask) {
+      out.append(" [pwm writable:");
+      appendMask(&out, "pwm", entry.pwmWritableMask);
+      out.append("]");
+    }
+    out.append("\n");
+    canTemp = canTemp || entry.tempMask;
+    canFan = canFan || entry.fanMask;
+    canPwm = canPwm || entry.pwmMask;
+    canWritePwm = canWritePwm || entry.pwmWritableMask;
+  }
+
+  out.append("\nThermal zones:\n");
+  for (const ThermalZoneEntry &zone : caps.thermalZones) {
+    out.append("  ").append(zone.path).append(" (type: ").append(zone.type).append(")\n");
+  }
+
+  const auto yesNo = [](bool v) { return v ? QByteArray("YES") : QByteArray("NO"); };
+  out.append("\nSummary:\n");
+  out.append("  Temperature sensors: ").append(yesNo(canTemp)).append("\n");
+  out.append("  Fan RPM sensors:     ").append(yesNo(canFan)).append("\n");
+  out.append("  Fan PWM control:     ").append(yesNo(canPwm)).append("\n");
+  out.append("  PWM writable now:    ").append(yesNo(canWritePwm)).append("\n");
+  out.append("\nSource: ").append(caps.fromManifest ? "manifest" : "sysfs probe");
+  out.append(", ").append(QByteArray::number(caps.elapsedMs, 'f', 2)).append(" ms\n");
+  return out;
+}
@@ -0,0 +1,77 @@
+#ifndef FANS_CONTROLLER_DEVICE_PROBE_H
+#define FANS_CONTROLLER_DEVICE_PROBE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <vector>
+
+// Do kha nang giam sat/dieu khien cua may (hwmon, thermal zone, PWM ghi duoc, model DMI)
+// bang syscall truc tiep thay cho device-check/sensors_report.sh. Ket qua duoc ghi ra
+// mot manifest nhi phan co version; lan chay sau chi can mmap manifest va so dau van
+// tay (kernel + DMI + tap hwmon) thay vi liet ke lai toan bo thu muc sysfs.
+class DeviceProbe {
+ public:
+  static constexpr quint32 kManifestVersion = 1;
+  static constexpr int kMaxChannels = 32;  // temp1..temp32, fan1..fan32, pwm1..pwm32.
+
+  // Cac ban ghi co kich thuoc co dinh de doc thang tu vung nho mmap.
+  struct HwmonEntry {
+    char path[64];             // /sys/class/hwmon/hwmonN
+    char name[32];             // Noi dung file name.
+    quint32 tempMask;          // Bit i: ton tai temp(i+1)_input.
+    quint32 fanMask;           // Bit i: ton tai fan(i+1)_input.
+    quint32 pwmMask;           // Bit i: ton tai pwm(i+1).
+    quint32 pwmWritableMask;   // Bit i: pwm(i+1) ghi duoc voi quyen hien tai.
+    quint32 pwmEnableMask;     // Bit i: ton tai pwm(i+1)_enable.
+  };
+
+  struct ThermalZoneEntry {
+    char path[64];  // /sys/class/thermal/thermal_zoneN
+    char type[32];
+  };
+
+  struct DmiInfo {
+    char productName[64];
+    char sysVendor[64];
+    char boardName[64];
+  };
+
+  struct Capabilities {
+    DmiInfo dmi{};
+    std::vector<HwmonEntry> hwmons;
+    std::vector<ThermalZoneEntry> thermalZones;
+    quint64 fingerprint = 0;
+    bool fromManifest = false;  // true neu lay tu manifest con hop le.
+    double elapsedMs = 0.0;     // Thoi gian load()/probe() da dung.
+  };
+
+  // Nap manifest neu van tay khop, neu khong thi do lai va ghi manifest moi.
+  static Capabilities load(const QString &manifestPath = defaultManifestPath());
+
+  // Luon liet ke lai sysfs (khong dung manifest).
+  static Capabilities probe();
+
+  // Van tay dung de vo hieu manifest: uname, DMI va danh sach hwmon (ten thu muc + name).
+  static quint64 computeFingerprint();
+
+  static bool writeManifest(const QString &path, const Capabilities &caps);
+  static bool readManifest(const QString &path, quint64 expectedFingerprint, Capabilities *caps);
+
+  // Ma hoa/giai ma noi dung manifest (khong kiem tra van tay); dung lai cho header trace.
+  static QByteArray encodeManifest(const Capabilities &caps);
+  static bool decodeManifest(const char *bytes, size_t size, Capabilities *caps);
+
+  // $XDG_CACHE_HOME/fans-controller/capabilities.bin (mac dinh ~/.cache/...).
+  static QString defaultManifestPath();
+
+  // Tim hwmon dau tien co name chua mot trong cac needle (khong phan biet hoa thuong).
+  static const HwmonEntry *findHwmon(const Capabilities &caps, const QStringList &needles);
+
+  // Bao cao dang text, thay cho phan tom tat cua sensors_report.sh.
+  static QByteArray formatReport(const Capabilities &caps);
+};
+
+#endif  // FANS_CONTROLLER_DEVICE_PROBE_H
@@ -0,0 +1,157 @@
+#include "fan_command_actor.h"
+
+#include <QElapsedTimer>
+
+FanCommandActor::FanCommandActor(TufGamingFx705ge &device, QObject *parent)
+    : QObject(parent), m_device(device) {
+  m_thread = QThread::create([this]() { run(); });
+  m_thread->setObjectName("FanCommandActor");
+  m_thread->start();
+}
+
+FanCommandActor::~FanCommandActor() {
+  {
+    QMutexLocker lock(&m_mutex);
+    m_stopping = true;
+  }
+  m_wake.wakeOne();
+  // Cho lan ghi dang do (neu co) hoan tat de khong bo do mot lan ghi PWM.
+  m_thread->wait();
+  delete m_thread;
+}
+
+QFuture<FanCommandActor::Result> FanCommandActor::submitFixedPercent(int percent) {
+  PendingCommand command;
+  command.percent = percent;
+  command.promise.start();
+  QFuture<Result> future = command.promise.future();
+
+  {
+    QMutexLocker lock(&m_mutex);
+    if (m_pending) {
+      // Chi giu setpoint moi nhat; lenh cu chua bat dau thi khong con y nghia.
+      resolveSuperseded(&*m_pending, "Bi thay the boi setpoint moi hon.");
+    }
+    m_pending = std::move(command);
+  }
+  m_wake.wakeOne();
+  return future;
+}
+
+void FanCommandActor::setRampRate(double percentPerSecond) {
+  {
+    QMutexLocker lock(&m_mutex);
+    m_rampRate = percentPerSecond;
+  }
+  m_wake.wakeOne();
+}
+
+double FanCommandActor::rampRate() const {
+  QMutexLocker lock(&m_mutex);
+  return m_rampRate;
+}
+
+void FanCommandActor::run() {
+  QElapsedTimer clock;
+  clock.start();
+  std::optional<PendingCommand> active;  // Lenh dang ramp toi dich.
+
+  for (;;) {
+    QMutexLocker lock(&m_mutex);
+    // Timer duy nhat: cho lenh moi hoac toi moc buoc ramp ke tiep cua moi kenh.
+    while (!m_stopping && !m_pending) {
+      if (!m_ramp.isActive()) {
+        m_wake.wait(&m_mutex);
+        continue;
+      }
+      const qint64 waitMs = m_ramp.nextDeadlineMs() - clock.elapsed();
+      if (waitMs <= 0) {
+        break;
+      }
+      m_wake.wait(&m_mutex, static_cast<unsigned long>(waitMs));
+    }
+    if (m_stopping) {
+      if (m_pending) {
+        resolveSuperseded(&*m_pending, "Actor dieu khien quat da dung.");
+        m_pending.reset();
+      }
+      if (active) {
+        resolveSuperseded(&*active, "Actor dieu khien quat da dung giua chung ramp.");
+      }
+      return;
+    }
+
+    std::optional<PendingCommand> incoming;
+    if (m_pending) {
+      incoming = std::move(m_pending);
+      m_pending.reset();
+    }
+    m_ramp.setRate(m_rampRate);
+    lock.unlock();
+
+    // Cac goi sysfs/EC blocking nam ngoai khoa de submit moi khong phai cho.
+    if (incoming) {
+      if (active) {
+        resolveSuperseded(&*active, "Bi thay the giua chung ramp boi setpoint moi hon.");
+      }
+      active = std::move(incoming);
+      Result result;
+      if (!startCommand(&*active, &result, clock.elapsed())) {
+        finishCommand(&*active, result);
+        active.reset();
+        continue;
+      }
+    }
+
+    if (!active) {
+      continue;
+    }
+
+    Result result;
+    result.percent = std::clamp(active->percent, 0, 100);
+    const QVector<PwmRamp::Step> steps = m_ramp.advance(clock.elapsed());
+    if (!steps.isEmpty() && !m_device.writePwmSteps(steps, &result.error)) {
+      m_ramp.clear();
+      finishCommand(&*active, result);
+      active.reset();
+      continue;
+    }
+    if (!m_ramp.isActive()) {
+      result.rpm = m_device.readFanRpmNow();
+      result.ok = true;
+      finishCommand(&*active, result);
+      active.reset();
+    }
+  }
+}
+
+bool FanCommandActor::startCommand(PendingCommand *command, Result *result, qint64 nowMs) {
+  const int channel = m_device.fanPwmChannel();
+  result->percent = std::clamp(command->percent, 0, 100);
+  m_device.noteFanTarget(result->percent);
+
+  int pwmMax = 0;
+  if (!m_device.preparePwmChannel(channel, &pwmMax, &result->error)) {
+    return false;
+  }
+  // Kenh dang ramp thi giu vi tri hien tai; neu khong, bat dau tu gia tri doc tu sysfs.
+  const int currentPwm = m_ramp.contains(channel) ? 0 : m_device.readPwmRaw(channel);
+  const int targetPwm = static_cast<int>(result->percent / 100.0 * pwmMax);
+  m_ramp.setTarget(channel, targetPwm, pwmMax, currentPwm, nowMs);
+  return true;
+}
+
+void FanCommandActor::finishCommand(PendingCommand *command, const Result &result) {
+  command->promise.addResult(result);
+  command->promise.finish();
+  emit commandFinished(result);
+}
+
+void FanCommandActor::resolveSuperseded(PendingCommand *command, const QString &reason) {
+  Result result;
+  result.percent = command->percent;
+  result.superseded = true;
+  result.error = reason;
+  command->promise.addResult(result);
+  command->promise.finish();
+}
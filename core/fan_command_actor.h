@@ -0,0 +1,72 @@
+#ifndef FANS_CONTROLLER_FAN_COMMAND_ACTOR_H
+#define FANS_CONTROLLER_FAN_COMMAND_ACTOR_H
+
+#include <QFuture>
+#include <QMetaType>
+#include <QMutex>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <optional>
+
+#include "tuf_gaming_fx705ge.h"
+
+// Actor dieu khien quat: moi lenh ghi PWM duoc day vao hang doi va thuc thi tren mot
+// thread rieng, vi EC co the mat hang chuc ms moi tra loi open/read/write sysfs.
+// Hang doi chi giu setpoint moi nhat dang cho; setpoint cu chua kip ghi se nhan ket
+// qua superseded. Ket qua tra ve qua QFuture va qua signal commandFinished (tu dong
+// chuyen ve thread cua doi tuong nhan, vd. thread GUI).
+//
+// PWM khong nhay thang toi dich ma di theo PwmRamp voi toc do gioi han (%/giay).
+// Thread actor dung mot moc cho duy nhat cho ca lenh moi lan buoc ramp ke tiep, nen
+// setpoint moi den giua chung ramp se doi dich ngay tu vi tri hien tai. Lenh chi hoan
+// tat (future/signal) khi PWM da toi dich.
+class FanCommandActor : public QObject {
+  Q_OBJECT
+
+ public:
+  using Result = TufGamingFx705ge::FanCommandResult;
+
+  explicit FanCommandActor(TufGamingFx705ge &device, QObject *parent = nullptr);
+  ~FanCommandActor() override;
+
+  // Xep lich dat toc do co dinh (0-100%). Khong bao gio block thread goi.
+  QFuture<Result> submitFixedPercent(int percent);
+
+  // Toc do ramp (%/giay); <= 0 de ghi thang gia tri dich. Ap dung tu buoc ke tiep.
+  void setRampRate(double percentPerSecond);
+  double rampRate() const;
+
+ signals:
+  // Phat sau moi lenh da thuc su ghi xuong thiet bi (khong phat cho lenh bi thay the).
+  void commandFinished(const TufGamingFx705ge::FanCommandResult &result);
+
+ private:
+  struct PendingCommand {
+    int percent = 0;
+    QPromise<Result> promise;
+  };
+
+  void run();
+  // Bat dau ramp cho lenh moi; tra ve false neu khong the dieu khien (da co loi).
+  bool startCommand(PendingCommand *command, Result *result, qint64 nowMs);
+  void finishCommand(PendingCommand *command, const Result &result);
+  static void resolveSuperseded(PendingCommand *command, const QString &reason);
+
+  TufGamingFx705ge &m_device;
+  QThread *m_thread = nullptr;
+
+  mutable QMutex m_mutex;  // Bao ve m_pending, m_rampRate va m_stopping.
+  QWaitCondition m_wake;
+  std::optional<PendingCommand> m_pending;
+  double m_rampRate = PwmRamp::kDefaultRatePercentPerSecond;
+  bool m_stopping = false;
+
+  PwmRamp m_ramp;  // Chi dung tren thread actor.
+};
+
+Q_DECLARE_METATYPE(TufGamingFx705ge::FanCommandResult)
+
+#endif  // FANS_CONTROLLER_FAN_COMMAND_ACTOR_H
@@ -0,0 +1,61 @@
+#include "fan_policy.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+#include "tuf_gaming_fx705ge.h"
+
+bool FanPolicy::parse(const QString &spec, FanPolicy *policy, QString *error,
+                      const ModelProfile &model) {
+  const QStringList parts = spec.trimmed().toLower().split(':');
+  FanPolicy parsed;
+  parsed.name = spec.trimmed();
+  bool ok = true;
+  if (parts.size() == 1 && parts[0] == "auto") {
+    parsed.kind = Kind::FirmwareAuto;
+  } else if (parts.size() == 1 && TufGamingFx705ge::presetPercent(parts[0], model) >= 0) {
+    parsed.kind = Kind::Fixed;
+    parsed.percent = TufGamingFx705ge::presetPercent(parts[0], model);
+  } else if (parts.size() == 1 && parts[0] == "safe") {
+    parsed.kind = Kind::Curve;
+    parsed.lowC = model.safeCurve.lowC;
+    parsed.lowPercent = model.safeCurve.lowPercent;
+    parsed.highC = model.safeCurve.highC;
+    parsed.highPercent = model.safeCurve.highPercent;
+  } else if (parts.size() == 2 && parts[0] == "fixed") {
+    parsed.kind = Kind::Fixed;
+    parsed.percent = parts[1].toInt(&ok);
+    ok = ok && parsed.percent >= 0 && parsed.percent <= 100;
+  } else if (parts.size() == 5 && parts[0] == "curve") {
+    parsed.kind = Kind::Curve;
+    double *fields[] = {&parsed.lowC, &parsed.lowPercent, &parsed.highC, &parsed.highPercent};
+    for (int i = 0; i < 4 && ok; ++i) {
+      *fields[i] = parts[i + 1].toDouble(&ok);
+    }
+    ok = ok && parsed.highC > parsed.lowC;
+  } else {
+    ok = false;
+  }
+  if (!ok) {
+    *error = QString("Chinh sach khong hop le: %1 (auto, silent, performance, turbo, safe, "
+                     "fixed:N, curve:T0:P0:T1:P1)")
+                 .arg(spec);
+    return false;
+  }
+  *policy = parsed;
+  return true;
+}
+
+int FanPolicy::percentFor(double tempC) const {
+  if (kind == Kind::FirmwareAuto) {
+    return -1;
+  }
+  if (kind == Kind::Fixed) {
+    return percent;
+  }
+  const double t = std::clamp((tempC - lowC) / (highC - lowC), 0.0, 1.0);
+  return static_cast<int>(std::lround(std::clamp(lowPercent + (highPercent - lowPercent) * t,
+                                                 0.0, 100.0)));
+}
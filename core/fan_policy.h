@@ -0,0 +1,32 @@
+#ifndef FANS_CONTROLLER_FAN_POLICY_H
+#define FANS_CONTROLLER_FAN_POLICY_H
+
+#include <QString>
+
+#include "model_profile.h"
+
+// Chinh sach quat dung chung cho mo phong (ThermalSimulation) va quy tac theo tien
+// trinh (ProcessRules): giao cho firmware, % co dinh, hoac duong cong nhiet do -> %.
+struct FanPolicy {
+  enum class Kind { FirmwareAuto, Fixed, Curve };
+
+  // Duong cong chi gui lenh moi khi % doi it nhat chung nay, tranh ghi EC lien tuc.
+  static constexpr int kCurveDeadbandPercent = 2;
+
+  QString name;
+  Kind kind = Kind::FirmwareAuto;
+  int percent = 0;           // Fixed.
+  double lowC = 0.0;         // Curve: tuyen tinh (lowC, lowPercent) -> (highC, highPercent).
+  double lowPercent = 0.0;
+  double highC = 0.0;
+  double highPercent = 0.0;
+
+  // "auto", ten preset ("silent", "performance", "turbo"), "safe" (duong cong an toan
+  // cua profile), "fixed:N" hoac "curve:T0:P0:T1:P1". Preset va "safe" lay theo model.
+  static bool parse(const QString &spec, FanPolicy *policy, QString *error,
+                    const ModelProfile &model = ModelProfile::detected());
+  // % can dat o nhiet do tempC; -1 voi FirmwareAuto.
+  int percentFor(double tempC) const;
+};
+
+#endif  // FANS_CONTROLLER_FAN_POLICY_H
@@ -0,0 +1,341 @@
+#include "fan_watchdog.h"
+
+#include <QFile>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+// Theo Documentation/hwmon/sysfs-interface: 0 = full speed, 1 = manual, 2+ = tu dong.
+const char kPwmEnableAuto[] = "2";
+constexpr size_t kWatchdogStackSize = 256 * 1024;
+const int kFatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT,
+                             SIGTERM, SIGINT, SIGHUP, SIGQUIT};
+constexpr int kFatalSignalCount = sizeof(kFatalSignals) / sizeof(kFatalSignals[0]);
+
+// Watchdog dang arm (chi mot thuc the tai mot thoi diem), dung trong signal handler.
+std::atomic<FanWatchdog *> g_activeWatchdog{nullptr};
+struct sigaction g_previousActions[kFatalSignalCount];
+std::atomic<bool> g_atexitRegistered{false};
+
+// Truong tinh duoc handler dung: ghi san luc arm de handler khong phai doc doi tuong C++.
+std::atomic<int> g_signalEnableFd{-1};
+std::atomic<int> g_signalPwmFd{-1};
+char g_signalRestoreValue[8];
+char g_signalFullSpeedValue[16];
+std::atomic<bool> g_signalFullSpeed{false};
+
+qint64 monotonicNs() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void addNs(timespec *ts, qint64 ns) {
+  ts->tv_sec += ns / 1000000000LL;
+  ts->tv_nsec += ns % 1000000000LL;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_nsec -= 1000000000L;
+    ++ts->tv_sec;
+  }
+}
+
+void storeMax(std::atomic<qint64> *target, qint64 value) {
+  qint64 current = target->load(std::memory_order_relaxed);
+  while (value > current &&
+         !target->compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+// Chi dung ham async-signal-safe: co the goi tu signal handler va atexit.
+void writeFailsafeFromFds() {
+  const int enableFd = g_signalEnableFd.load();
+  const int pwmFd = g_signalPwmFd.load();
+  if (!g_signalFullSpeed.load() && enableFd >= 0) {
+    const size_t len = std::strlen(g_signalRestoreValue);
+    if (::pwrite(enableFd, g_signalRestoreValue, len, 0) == static_cast<ssize_t>(len)) {
+      return;
+    }
+  }
+  if (pwmFd >= 0) {
+    ::pwrite(pwmFd, g_signalFullSpeedValue, std::strlen(g_signalFullSpeedValue), 0);
+  }
+}
+
+void failsafeAtExit() {
+  if (g_activeWatchdog.load()) {
+    writeFailsafeFromFds();
+  }
+}
+}  // namespace
+
+FanWatchdog::~FanWatchdog() {
+  disarm();
+}
+
+bool FanWatchdog::arm(const Config &config, QString *error) {
+  disarm();
+  m_config = config;
+
+  const QString prefix = config.hwmonPath + QString("/pwm%1").arg(config.channel);
+  m_enableFd = ::open(QFile::encodeName(prefix + "_enable").constData(), O_RDWR | O_CLOEXEC);
+  m_pwmFd = ::open(QFile::encodeName(prefix).constData(), O_WRONLY | O_CLOEXEC);
+  if (m_enableFd < 0 || m_pwmFd < 0) {
+    *error = QString("Watchdog khong mo duoc %1_enable/%1 de ghi (can quyen root).").arg(prefix);
+    closeFds();
+    return false;
+  }
+  if (!config.criticalTempPath.isEmpty()) {
+    m_tempFd = ::open(QFile::encodeName(config.criticalTempPath).constData(), O_RDONLY | O_CLOEXEC);
+  }
+
+  // Che do ban dau: neu dang tu dong (>= 2) thi tra ve dung che do do, neu khong dung 2.
+  char buf[16] = {};
+  const ssize_t n = ::pread(m_enableFd, buf, sizeof(buf) - 1, 0);
+  const int original = n > 0 ? std::atoi(buf) : 0;
+  std::snprintf(m_restoreValue, sizeof(m_restoreValue), "%d",
+                original >= 2 ? original : std::atoi(kPwmEnableAuto));
+
+  int pwmMax = 255;
+  QFile maxFile(prefix + "_max");
+  if (maxFile.open(QIODevice::ReadOnly)) {
+    bool ok = false;
+    const int value = maxFile.readAll().trimmed().toInt(&ok);
+    if (ok && value > 0) {
+      pwmMax = value;
+    }
+  }
+  std::snprintf(m_fullSpeedValue, sizeof(m_fullSpeedValue), "%d", pwmMax);
+
+  // Thong tin cho signal handler/atexit.
+  std::memcpy(g_signalRestoreValue, m_restoreValue, sizeof(g_signalRestoreValue));
+  std::memcpy(g_signalFullSpeedValue, m_fullSpeedValue, sizeof(g_signalFullSpeedValue));
+  g_signalFullSpeed = config.action == FailsafeAction::FullSpeed;
+  g_signalEnableFd = m_enableFd;
+  g_signalPwmFd = m_pwmFd;
+  g_activeWatchdog = this;
+  installSignalHandlers();
+  if (!g_atexitRegistered.exchange(true)) {
+    std::atexit(failsafeAtExit);
+  }
+
+  // Stack rieng da mlock de thread khong bi page fault khi he thong thieu bo nho.
+  m_stackSize = kWatchdogStackSize;
+  m_stack = ::mmap(nullptr, m_stackSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (m_stack == MAP_FAILED) {
+    m_stack = nullptr;
+    *error = "Watchdog khong cap phat duoc stack.";
+    disarm();
+    return false;
+  }
+  m_memoryLocked = ::mlock(m_stack, m_stackSize) == 0 && ::mlock(this, sizeof(*this)) == 0;
+
+  m_stop = false;
+  m_lastBeatNs = monotonicNs();
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, m_stack, m_stackSize);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  sched_param param{};
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+  pthread_attr_setschedparam(&attr, &param);
+  int rc = pthread_create(&m_thread, &attr, &FanWatchdog::threadMain, this);
+  m_realtime = rc == 0;
+  if (rc == EPERM) {
+    // Khong co CAP_SYS_NICE: van chay watchdog voi lich mac dinh.
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    rc = pthread_create(&m_thread, &attr, &FanWatchdog::threadMain, this);
+  }
+  pthread_attr_destroy(&attr);
+  if (rc != 0) {
+    *error = QString("Watchdog khong tao duoc thread (errno %1).").arg(rc);
+    disarm();
+    return false;
+  }
+  pthread_setname_np(m_thread, "fan-watchdog");
+  m_armed = true;
+  return true;
+}
+
+void FanWatchdog::disarm() {
+  if (m_armed) {
+    m_stop = true;
+    pthread_join(m_thread, nullptr);
+    m_armed = false;
+    // Thoat binh thuong: tra quat ve tu dong thay vi de nguyen duty cycle cuoi cung.
+    qint64 writeUs = 0;
+    engageFailsafe(&writeUs);
+  }
+  if (g_activeWatchdog.load() == this) {
+    restoreSignalHandlers();
+    g_activeWatchdog = nullptr;
+    g_signalEnableFd = -1;
+    g_signalPwmFd = -1;
+  }
+  if (m_stack) {
+    if (m_memoryLocked) {
+      ::munlock(m_stack, m_stackSize);
+      ::munlock(this, sizeof(*this));
+    }
+    ::munmap(m_stack, m_stackSize);
+    m_stack = nullptr;
+  }
+  closeFds();
+}
+
+void FanWatchdog::heartbeat() {
+  m_lastBeatNs.store(monotonicNs(), std::memory_order_release);
+}
+
+FanWatchdog::Stats FanWatchdog::stats() const {
+  Stats s;
+  s.trips = m_trips.load();
+  s.heartbeatTrips = m_heartbeatTrips.load();
+  s.criticalTrips = m_criticalTrips.load();
+  s.maxReactionUs = m_maxReactionUs.load();
+  s.maxWakeLatenessUs = m_maxWakeLatenessUs.load();
+  s.maxWriteUs = m_maxWriteUs.load();
+  s.realtime = m_realtime;
+  s.memoryLocked = m_memoryLocked;
+  return s;
+}
+
+void *FanWatchdog::threadMain(void *arg) {
+  static_cast<FanWatchdog *>(arg)->run();
+  return nullptr;
+}
+
+void FanWatchdog::run() {
+  const qint64 periodNs = qMax(1, m_config.periodMs) * 1000000LL;
+  const qint64 timeoutNs = qMax(1, m_config.heartbeatTimeoutMs) * 1000000LL;
+  bool tripped = false;
+
+  timespec next{};
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (!m_stop.load(std::memory_order_acquire)) {
+    addNs(&next, periodNs);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {
+    }
+    const qint64 now = monotonicNs();
+    storeMax(&m_maxWakeLatenessUs,
+             (now - (next.tv_sec * 1000000000LL + next.tv_nsec)) / 1000);
+    if (m_stop.load(std::memory_order_acquire)) {
+      break;
+    }
+
+    const qint64 lastBeat = m_lastBeatNs.load(std::memory_order_acquire);
+    const bool beatMissed = now - lastBeat > timeoutNs;
+    const bool critical = m_tempFd >= 0 && readCriticalTempC() >= m_config.criticalC;
+
+    if ((beatMissed || critical) && !tripped) {
+      qint64 writeUs = 0;
+      engageFailsafe(&writeUs);
+      const qint64 done = monotonicNs();
+      // Heartbeat: tinh tu han chot thuc su; nhiet do: tu luc lay mau phat hien vuot nguong.
+      const qint64 origin = beatMissed ? lastBeat + timeoutNs : now;
+      storeMax(&m_maxReactionUs, (done - origin) / 1000);
+      storeMax(&m_maxWriteUs, writeUs);
+      ++m_trips;
+      ++(beatMissed ? m_heartbeatTrips : m_criticalTrips);
+      tripped = true;
+    } else if (tripped && critical && !failsafeHolds()) {
+      // Van qua nhiet nhung lenh ke tiep cua FanCommandActor (preparePwmChannel dat lai
+      // manual) da go failsafe: ghi lai moi chu ky cho den khi nhiet do xuong duoi nguong.
+      qint64 writeUs = 0;
+      engageFailsafe(&writeUs);
+      storeMax(&m_maxWriteUs, writeUs);
+    } else if (tripped && !beatMissed && !critical) {
+      // Controller da song lai va se tu dat lai manual o lenh ke tiep.
+      tripped = false;
+    }
+  }
+}
+
+bool FanWatchdog::engageFailsafe(qint64 *writeUs) {
+  const qint64 start = monotonicNs();
+  bool ok = false;
+  if (m_config.action == FailsafeAction::RestoreAuto && m_enableFd >= 0) {
+    const size_t len = std::strlen(m_restoreValue);
+    ok = ::pwrite(m_enableFd, m_restoreValue, len, 0) == static_cast<ssize_t>(len);
+  }
+  if (!ok && m_pwmFd >= 0) {
+    const size_t len = std::strlen(m_fullSpeedValue);
+    ok = ::pwrite(m_pwmFd, m_fullSpeedValue, len, 0) == static_cast<ssize_t>(len);
+  }
+  *writeUs = (monotonicNs() - start) / 1000;
+  return ok;
+}
+
+// Failsafe con hieu luc? RestoreAuto: pwmN_enable van o che do tu dong (>= 2). FullSpeed
+// hoac khong doc duoc pwmN_enable: fd pwmN chi ghi nen khong kiem tra duoc, coi nhu da bi
+// ghi de (ghi lai pwmN_max re hon de quat cham trong luc qua nhiet).
+bool FanWatchdog::failsafeHolds() const {
+  if (m_config.action != FailsafeAction::RestoreAuto || m_enableFd < 0) {
+    return false;
+  }
+  char buf[16];
+  const ssize_t n = ::pread(m_enableFd, buf, sizeof(buf) - 1, 0);
+  if (n <= 0) {
+    return false;
+  }
+  buf[n] = '\0';
+  return std::atoi(buf) >= 2;
+}
+
+double FanWatchdog::readCriticalTempC() const {
+  char buf[32];
+  const ssize_t n = ::pread(m_tempFd, buf, sizeof(buf) - 1, 0);
+  if (n <= 0) {
+    return 0.0;
+  }
+  buf[n] = '\0';
+  double value = std::strtod(buf, nullptr);
+  // sysfs nhiet do thuong o don vi millidegree C.
+  if (value > 200.0) {
+    value /= 1000.0;
+  }
+  return value;
+}
+
+void FanWatchdog::handleFatalSignal(int signo) {
+  writeFailsafeFromFds();
+  // SA_RESETHAND da tra ve handler mac dinh; phat lai de tien trinh ket thuc dung cach.
+  ::raise(signo);
+}
+
+void FanWatchdog::installSignalHandlers() {
+  struct sigaction action {};
+  action.sa_handler = &FanWatchdog::handleFatalSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESETHAND | SA_NODEFER;
+  for (int i = 0; i < kFatalSignalCount; ++i) {
+    sigaction(kFatalSignals[i], &action, &g_previousActions[i]);
+  }
+}
+
+void FanWatchdog::restoreSignalHandlers() {
+  for (int i = 0; i < kFatalSignalCount; ++i) {
+    sigaction(kFatalSignals[i], &g_previousActions[i], nullptr);
+  }
+}
+
+void FanWatchdog::closeFds() {
+  for (int *fd : {&m_enableFd, &m_pwmFd, &m_tempFd}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
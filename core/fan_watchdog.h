@@ -0,0 +1,107 @@
+#ifndef FANS_CONTROLLER_FAN_WATCHDOG_H
+#define FANS_CONTROLLER_FAN_WATCHDOG_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <pthread.h>
+
+#include <atomic>
+
+// Watchdog an toan cho quat: sau khi pwm1_enable bi dat manual, neu controller (thread
+// GUI) ngung gui heartbeat, tien trinh thoat/crash, hoac nhiet do vuot nguong toi han
+// thi tra quat ve che do tu dong (hoac ep 100%) trong mot khoang thoi gian co gioi han.
+//
+// Thread watchdog chay uu tien SCHED_FIFO neu duoc phep, stack rieng da mlock, va chi
+// dung cac fd mo san luc arm() (khong cap phat, khong mo file khi can phan ung). Bo xu
+// ly tin hieu (SIGSEGV, SIGABRT, SIGTERM...) cung chi dung pwrite() tren cac fd do.
+class FanWatchdog {
+ public:
+  enum class FailsafeAction {
+    RestoreAuto,  // Ghi pwmN_enable = che do tu dong; neu loi thi ep 100%.
+    FullSpeed,    // Ghi pwmN = pwmN_max.
+  };
+
+  struct Config {
+    QString hwmonPath;          // Thu muc hwmon chua pwmN/pwmN_enable.
+    int channel = 1;
+    QString criticalTempPath;   // temp*_input dung de so nguong (co the rong).
+    double criticalC = 95.0;
+    int heartbeatTimeoutMs = 3000;
+    int periodMs = 100;         // Chu ky kiem tra cua thread watchdog.
+    FailsafeAction action = FailsafeAction::RestoreAuto;
+  };
+
+  // Thoi gian phan ung do duoc (micro giay).
+  struct Stats {
+    quint64 trips = 0;
+    quint64 heartbeatTrips = 0;
+    quint64 criticalTrips = 0;
+    qint64 maxReactionUs = 0;      // Tu luc qua han heartbeat/phat hien toi khi ghi xong.
+    qint64 maxWakeLatenessUs = 0;  // Do tre danh thuc lon nhat cua thread watchdog.
+    qint64 maxWriteUs = 0;         // Thoi gian ghi sysfs lau nhat khi kich hoat.
+    bool realtime = false;         // Da chay duoc SCHED_FIFO.
+    bool memoryLocked = false;     // Stack/trang thai da mlock.
+    // Can tren ly thuyet cho do tre phan ung voi gia tri do duoc hien tai.
+    qint64 worstCaseBoundUs(int periodMs) const {
+      return periodMs * 1000LL + maxWakeLatenessUs + maxWriteUs;
+    }
+  };
+
+  FanWatchdog() = default;
+  ~FanWatchdog();
+  FanWatchdog(const FanWatchdog &) = delete;
+  FanWatchdog &operator=(const FanWatchdog &) = delete;
+
+  // Mo san fd, luu che do pwmN_enable ban dau va khoi dong thread watchdog.
+  bool arm(const Config &config, QString *error);
+
+  // Tra quat ve che do tu dong va dung thread (goi khi thoat binh thuong).
+  void disarm();
+
+  bool isArmed() const { return m_armed; }
+
+  // Controller bao con song; goi dinh ky nhanh hon heartbeatTimeoutMs.
+  void heartbeat();
+
+  Stats stats() const;
+  const Config &config() const { return m_config; }
+
+ private:
+  static void *threadMain(void *arg);
+  static void handleFatalSignal(int signo);
+  void run();
+  bool engageFailsafe(qint64 *writeUs);
+  bool failsafeHolds() const;
+  double readCriticalTempC() const;
+  void installSignalHandlers();
+  void restoreSignalHandlers();
+  void closeFds();
+
+  Config m_config;
+  bool m_armed = false;
+
+  int m_enableFd = -1;
+  int m_pwmFd = -1;
+  int m_tempFd = -1;
+  char m_restoreValue[8] = {};  // Gia tri pwmN_enable ghi khi kich hoat.
+  char m_fullSpeedValue[16] = {};
+
+  pthread_t m_thread{};
+  void *m_stack = nullptr;
+  size_t m_stackSize = 0;
+  std::atomic<bool> m_stop{false};
+  std::atomic<qint64> m_lastBeatNs{0};
+
+  // Stats duoc ghi tu thread watchdog, doc tu thread khac.
+  std::atomic<quint64> m_trips{0};
+  std::atomic<quint64> m_heartbeatTrips{0};
+  std::atomic<quint64> m_criticalTrips{0};
+  std::atomic<qint64> m_maxReactionUs{0};
+  std::atomic<qint64> m_maxWakeLatenessUs{0};
+  std::atomic<qint64> m_maxWriteUs{0};
+  bool m_realtime = false;
+  bool m_memoryLocked = false;
+};
+
+#endif  // FANS_CONTROLLER_FAN_WATCHDOG_H
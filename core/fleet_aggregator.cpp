@@ -0,0 +1,521 @@
+#include "fleet_aggregator.h"
+
+#include <QDateTime>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <tuple>
+
+namespace {
+constexpr int kMaxEvents = 256;
+constexpr int kReadChunkBytes = 64 * 1024;
+constexpr int kMaxLineBytes = 64 * 1024;  // Dong dai hon: luong hong, ngat ket noi.
+constexpr int kMinBackoffMs = 100;
+constexpr int kMaxBackoffMs = 5000;
+constexpr int kMaxPortRange = 4096;
+// Dong ho instance lech qua muc nay so voi may gom thi dung thoi diem nhan thay the.
+constexpr qint64 kMaxClockSkewMs = 60 * 1000;
+// Nguong bat thuong: robust z > 3.5 va lech it nhat max(3 don vi, 10% trung vi).
+constexpr double kOutlierZ = 3.5;
+constexpr double kMadToSigma = 1.4826;
+constexpr double kMinAbsoluteDelta = 3.0;
+constexpr double kMinRelativeDelta = 0.10;
+constexpr double kMaxReportedZ = 99.0;
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+const QByteArray kCpuPackageSensor("CPU Package");
+const QByteArray kPchSensor("PCH");
+const QByteArray kFanRpmSensor("Fan RPM");
+
+QString errnoText(const char *what) {
+  return QString("%1: %2").arg(what, QString::fromLocal8Bit(std::strerror(errno)));
+}
+
+qint64 nowMs() {
+  return QDateTime::currentMSecsSinceEpoch();
+}
+
+// Tim key (vd. "\"pch_c\":") trong [begin, end); tra ve con tro ngay sau key.
+const char *after(const char *begin, const char *end, const char *key) {
+  const size_t keyLength = std::strlen(key);
+  const void *found = ::memmem(begin, static_cast<size_t>(end - begin), key, keyLength);
+  return found ? static_cast<const char *>(found) + keyLength : nullptr;
+}
+
+// So ngay tai p; dong luon ket thuc bang ',' / '}' truoc '\n' nen strtod khong doc lo.
+bool numberAt(const char *p, const char *end, double *value) {
+  if (!p || p >= end) {
+    return false;
+  }
+  char *stop = nullptr;
+  *value = std::strtod(p, &stop);
+  return stop != p && stop <= end;
+}
+
+// Chuoi JSON bat dau tai p (ngay sau dau '"'); chi can \" va \\ vi nhan do
+// CliSnapshot::formatJson() escape. Tra ve con tro sau dau '"' dong, nullptr neu hong.
+const char *stringAt(const char *p, const char *end, QByteArray *out) {
+  out->clear();
+  while (p < end && *p != '"') {
+    if (*p == '\\' && p + 1 < end) {
+      ++p;
+    }
+    out->append(*p++);
+  }
+  return p < end ? p + 1 : nullptr;
+}
+
+double percentile(QVector<double> *values, double p) {
+  const qsizetype index = std::clamp<qsizetype>(
+      static_cast<qsizetype>(std::ceil(p * values->size())) - 1, 0, values->size() - 1);
+  std::nth_element(values->begin(), values->begin() + index, values->end());
+  return (*values)[index];
+}
+
+bool parsePort(const QString &text, quint16 *port) {
+  bool ok = false;
+  const int value = text.toInt(&ok);
+  if (!ok || value <= 0 || value > 65535) {
+    return false;
+  }
+  *port = static_cast<quint16>(value);
+  return true;
+}
+}  // namespace
+
+bool FleetAggregator::parseEndpoints(const QString &spec, QVector<Endpoint> *out,
+                                     QString *error) {
+  for (const QString &rawItem : spec.split(',', Qt::SkipEmptyParts)) {
+    const QString item = rawItem.trimmed();
+    QString host;
+    QString ports;
+    if (item.startsWith('[')) {
+      const int close = item.indexOf(']');
+      if (close < 0 || item.mid(close + 1, 1) != ":") {
+        *error = QString("Endpoint khong hop le: %1").arg(item);
+        return false;
+      }
+      host = item.mid(1, close - 1);
+      ports = item.mid(close + 2);
+    } else {
+      const int colon = item.lastIndexOf(':');
+      if (colon <= 0) {
+        *error = QString("Endpoint can dang host:port: %1").arg(item);
+        return false;
+      }
+      host = item.left(colon);
+      ports = item.mid(colon + 1);
+    }
+
+    quint16 first = 0;
+    quint16 last = 0;
+    const int dash = ports.indexOf('-');
+    const bool ok = dash < 0 ? parsePort(ports, &first) && parsePort(ports, &last)
+                             : parsePort(ports.left(dash), &first) &&
+                                   parsePort(ports.mid(dash + 1), &last);
+    if (!ok || last < first || last - first >= kMaxPortRange) {
+      *error = QString("Cong khong hop le: %1").arg(item);
+      return false;
+    }
+    for (int port = first; port <= last; ++port) {
+      out->append({host, static_cast<quint16>(port)});
+    }
+  }
+  if (out->isEmpty()) {
+    *error = "Khong co endpoint nao.";
+    return false;
+  }
+  return true;
+}
+
+FleetAggregator::FleetAggregator(int windowSlots, int graceMs)
+    : m_windowSlots(std::max(1, windowSlots)), m_graceMs(std::max(0, graceMs)) {}
+
+FleetAggregator::~FleetAggregator() {
+  for (const Stream &stream : m_streams) {
+    if (stream.fd >= 0) {
+      ::close(stream.fd);
+    }
+  }
+  if (m_epollFd >= 0) {
+    ::close(m_epollFd);
+  }
+}
+
+bool FleetAggregator::start(const QVector<Endpoint> &endpoints, QString *error) {
+  m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+  if (m_epollFd < 0) {
+    *error = errnoText("Khong tao duoc epoll");
+    return false;
+  }
+  m_readBuffer.resize(kReadChunkBytes);
+
+  // Dai cong cung host chi phan giai mot lan.
+  QHash<QString, QPair<sockaddr_storage, socklen_t>> resolved;
+  for (const Endpoint &endpoint : endpoints) {
+    if (!resolved.contains(endpoint.host)) {
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      addrinfo *result = nullptr;
+      const int rc = ::getaddrinfo(endpoint.host.toUtf8().constData(), nullptr, &hints, &result);
+      if (rc != 0 || !result) {
+        *error = QString("Khong phan giai duoc %1: %2")
+                     .arg(endpoint.host, QString::fromLocal8Bit(::gai_strerror(rc)));
+        return false;
+      }
+      sockaddr_storage storage{};
+      std::memcpy(&storage, result->ai_addr, result->ai_addrlen);
+      resolved.insert(endpoint.host, {storage, result->ai_addrlen});
+      ::freeaddrinfo(result);
+    }
+
+    Stream stream;
+    const bool v6 = endpoint.host.contains(':');
+    stream.key = v6 ? QString("[%1]:%2").arg(endpoint.host).arg(endpoint.port)
+                    : QString("%1:%2").arg(endpoint.host).arg(endpoint.port);
+    std::tie(stream.address, stream.addressLength) = resolved.value(endpoint.host);
+    if (stream.address.ss_family == AF_INET6) {
+      reinterpret_cast<sockaddr_in6 *>(&stream.address)->sin6_port = htons(endpoint.port);
+    } else {
+      reinterpret_cast<sockaddr_in *>(&stream.address)->sin_port = htons(endpoint.port);
+    }
+    m_streams.append(stream);
+  }
+
+  const qint64 now = nowMs();
+  for (int i = 0; i < m_streams.size(); ++i) {
+    connectStream(i, now);
+  }
+  return true;
+}
+
+void FleetAggregator::connectStream(int index, qint64 nowMs) {
+  Stream &stream = m_streams[index];
+  stream.fd = ::socket(stream.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (stream.fd < 0) {
+    dropStream(index, nowMs);
+    return;
+  }
+  const int rc = ::connect(stream.fd, reinterpret_cast<const sockaddr *>(&stream.address),
+                           stream.addressLength);
+  if (rc != 0 && errno != EINPROGRESS) {
+    dropStream(index, nowMs);
+    return;
+  }
+  stream.connecting = rc != 0;
+  epoll_event event{};
+  event.events = EPOLLIN;
+  if (stream.connecting) {
+    event.events |= EPOLLOUT;
+  }
+  event.data.u32 = static_cast<quint32>(index);
+  if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, stream.fd, &event) != 0) {
+    dropStream(index, nowMs);
+  }
+}
+
+void FleetAggregator::dropStream(int index, qint64 nowMs) {
+  Stream &stream = m_streams[index];
+  if (stream.fd >= 0) {
+    // close() tu go fd khoi epoll.
+    ::close(stream.fd);
+    stream.fd = -1;
+    if (!stream.connecting) {
+      ++m_stats.reconnects;
+    }
+  }
+  stream.connecting = false;
+  stream.pending.clear();
+  stream.backoffMs = std::clamp(stream.backoffMs * 2, kMinBackoffMs, kMaxBackoffMs);
+  stream.retryAtMs = nowMs + stream.backoffMs;
+}
+
+void FleetAggregator::readStream(int index, qint64 nowMs) {
+  Stream &stream = m_streams[index];
+  for (;;) {
+    const ssize_t count = ::recv(stream.fd, m_readBuffer.data(), kReadChunkBytes, 0);
+    if (count == 0 || (count < 0 && errno != EAGAIN && errno != EINTR)) {
+      dropStream(index, nowMs);
+      return;
+    }
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    ++m_stats.reads;
+    m_stats.bytes += static_cast<quint64>(count);
+    stream.pending.append(m_readBuffer.constData(), static_cast<int>(count));
+
+    // Tach moi dong tron trong lo vua doc; phan con lai cho lan sau.
+    const char *begin = stream.pending.constData();
+    const char *end = begin + stream.pending.size();
+    const char *line = begin;
+    while (const void *newline = std::memchr(line, '\n', static_cast<size_t>(end - line))) {
+      const char *lineEnd = static_cast<const char *>(newline);
+      ingestLine(index, line, static_cast<int>(lineEnd - line), nowMs);
+      line = lineEnd + 1;
+    }
+    stream.pending.remove(0, static_cast<int>(line - begin));
+    if (stream.pending.size() > kMaxLineBytes) {
+      dropStream(index, nowMs);
+      return;
+    }
+    // Doc it hon ca bo dem: socket da het du lieu, khong can them mot recv() ra EAGAIN.
+    if (count < kReadChunkBytes) {
+      return;
+    }
+  }
+}
+
+int FleetAggregator::sensorId(const QByteArray &name) {
+  const auto it = m_sensorIds.constFind(name);
+  if (it != m_sensorIds.constEnd()) {
+    return it.value();
+  }
+  const int id = m_sensorNames.size();
+  m_sensorIds.insert(name, id);
+  m_sensorNames.append(QString::fromUtf8(name));
+  return id;
+}
+
+void FleetAggregator::ingestLine(int host, const char *data, int length, qint64 receivedMs) {
+  ++m_stats.lines;
+  const char *end = data + length;
+  const char *tsAt = after(data, end, "\"timestamp_ms\":");
+  double timestamp = 0.0;
+  if (!numberAt(tsAt, end, &timestamp)) {
+    ++m_stats.badLines;
+    return;
+  }
+  qint64 sampleMs = static_cast<qint64>(timestamp);
+  if (std::abs(sampleMs - receivedMs) > kMaxClockSkewMs) {
+    sampleMs = receivedMs;
+  }
+  const qint64 slotMs = sampleMs - ((sampleMs % kSlotMs) + kSlotMs) % kSlotMs;
+  if (slotMs <= m_lastClosedSlotMs) {
+    ++m_stats.lateLines;
+    return;
+  }
+
+  // Kenh dang bi SensorAnomalyDetector danh dau loi thi khong dua vao thong ke fleet.
+  QVector<QByteArray> faulted;
+  QByteArray label;
+  if (const char *faults = after(data, end, "\"faults\":[")) {
+    const char *p = faults;
+    while ((p = after(p, end, "{\"channel\":\"")) && (p = stringAt(p, end, &label))) {
+      faulted.append(label);
+    }
+  }
+
+  QVector<Cell> &cells = m_openSlots[slotMs];
+  const auto add = [&](const QByteArray &name, const char *at) {
+    double value = kNaN;
+    if (numberAt(at, end, &value) && std::isfinite(value) && !faulted.contains(name)) {
+      cells.append({host, sensorId(name), value});
+    }
+  };
+  add(kCpuPackageSensor, after(data, end, "\"cpu_package_c\":"));
+  add(kPchSensor, after(data, end, "\"pch_c\":"));
+  add(kFanRpmSensor, after(data, end, "\"fan\":{\"rpm\":"));
+
+  const char *p = after(data, end, "\"temperatures\":[");
+  while (p && p < end && *p == '{') {
+    p = after(p, end, "{\"label\":\"");
+    p = p ? stringAt(p, end, &label) : nullptr;
+    p = p ? after(p, end, ",\"celsius\":") : nullptr;
+    if (!p) {
+      break;
+    }
+    add(label, p);
+    p = static_cast<const char *>(std::memchr(p, '}', static_cast<size_t>(end - p)));
+    if (!p || p + 1 >= end || p[1] != ',') {
+      break;
+    }
+    p += 2;
+  }
+}
+
+bool FleetAggregator::poll(int timeoutMs, QVector<SlotReport> *reports, QString *error) {
+  qint64 now = nowMs();
+  for (int i = 0; i < m_streams.size(); ++i) {
+    if (m_streams[i].fd < 0 && m_streams[i].retryAtMs <= now) {
+      connectStream(i, now);
+    }
+  }
+
+  std::array<epoll_event, kMaxEvents> events;
+  const int ready = ::epoll_wait(m_epollFd, events.data(), kMaxEvents, nextTimeoutMs(now, timeoutMs));
+  if (ready < 0 && errno != EINTR) {
+    *error = errnoText("epoll_wait loi");
+    return false;
+  }
+  ++m_stats.wakeups;
+  now = nowMs();
+  for (int i = 0; i < ready; ++i) {
+    const int index = static_cast<int>(events[i].data.u32);
+    Stream &stream = m_streams[index];
+    if (stream.fd < 0) {
+      continue;
+    }
+    if (stream.connecting) {
+      int socketError = 0;
+      socklen_t length = sizeof(socketError);
+      ::getsockopt(stream.fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+      if (socketError != 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+        dropStream(index, now);
+        continue;
+      }
+      stream.connecting = false;
+      stream.backoffMs = 0;
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u32 = static_cast<quint32>(index);
+      ::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, stream.fd, &event);
+    }
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      readStream(index, now);
+    }
+  }
+  closeSlots(now, reports);
+  return true;
+}
+
+int FleetAggregator::nextTimeoutMs(qint64 nowMs, int timeoutMs) const {
+  qint64 wait = timeoutMs;
+  if (!m_openSlots.isEmpty()) {
+    wait = std::min(wait, m_openSlots.firstKey() + kSlotMs + m_graceMs - nowMs);
+  }
+  for (const Stream &stream : m_streams) {
+    if (stream.fd < 0) {
+      wait = std::min(wait, stream.retryAtMs - nowMs);
+    }
+  }
+  return static_cast<int>(std::max<qint64>(0, wait));
+}
+
+void FleetAggregator::closeSlots(qint64 nowMs, QVector<SlotReport> *reports) {
+  while (!m_openSlots.isEmpty() && m_openSlots.firstKey() + kSlotMs + m_graceMs <= nowMs) {
+    const qint64 slotMs = m_openSlots.firstKey();
+    const QVector<Cell> cells = m_openSlots.take(slotMs);
+    m_lastClosedSlotMs = slotMs;
+    reports->append(closeSlot(slotMs, cells));
+  }
+}
+
+FleetAggregator::SlotReport FleetAggregator::closeSlot(qint64 slotMs, const QVector<Cell> &cells) {
+  SlotReport report;
+  report.slotMs = slotMs;
+  report.sensors = m_sensorNames;
+  const int hostCount = m_streams.size();
+  const int sensorCount = m_sensorNames.size();
+  for (const Stream &stream : m_streams) {
+    report.hosts.append(stream.key);
+  }
+  // Nhieu dong cua cung host trong mot slot: dong den sau thang.
+  report.table.fill(kNaN, hostCount * sensorCount);
+  for (const Cell &cell : cells) {
+    report.table[cell.host * sensorCount + cell.sensor] = cell.value;
+  }
+  for (int host = 0; host < hostCount; ++host) {
+    const double *row = report.table.constData() + host * sensorCount;
+    report.reporting += std::any_of(row, row + sensorCount, [](double v) { return !std::isnan(v); });
+  }
+
+  m_window.push_back({sensorCount, report.table});
+  while (static_cast<int>(m_window.size()) > m_windowSlots) {
+    m_window.pop_front();
+  }
+
+  QHash<quint64, int> streaks;
+  QVector<double> current;
+  QVector<double> deviations;
+  QVector<double> windowValues;
+  for (int sensor = 0; sensor < sensorCount; ++sensor) {
+    current.clear();
+    for (int host = 0; host < hostCount; ++host) {
+      const double value = report.table[host * sensorCount + sensor];
+      if (!std::isnan(value)) {
+        current.append(value);
+      }
+    }
+    if (current.isEmpty()) {
+      continue;
+    }
+
+    SensorSummary summary;
+    summary.sensor = m_sensorNames[sensor];
+    summary.hosts = current.size();
+    const auto [low, high] = std::minmax_element(current.cbegin(), current.cend());
+    summary.minimum = *low;
+    summary.maximum = *high;
+    windowValues.clear();
+    for (const ClosedSlot &slot : m_window) {
+      if (sensor >= slot.sensors) {
+        continue;
+      }
+      for (int i = sensor; i < slot.table.size(); i += slot.sensors) {
+        if (!std::isnan(slot.table[i])) {
+          windowValues.append(slot.table[i]);
+        }
+      }
+    }
+    summary.p50 = percentile(&windowValues, 0.50);
+    summary.p95 = percentile(&windowValues, 0.95);
+    summary.p99 = percentile(&windowValues, 0.99);
+    report.summaries.append(summary);
+
+    if (current.size() < kMinHostsForOutliers) {
+      continue;
+    }
+    const double median = percentile(&current, 0.50);
+    deviations.clear();
+    for (const double value : std::as_const(current)) {
+      deviations.append(std::abs(value - median));
+    }
+    const double mad = percentile(&deviations, 0.50);
+    const double threshold =
+        std::max({kOutlierZ * kMadToSigma * mad, kMinAbsoluteDelta,
+                  kMinRelativeDelta * std::abs(median)});
+    for (int host = 0; host < hostCount; ++host) {
+      const double value = report.table[host * sensorCount + sensor];
+      if (std::isnan(value) || std::abs(value - median) <= threshold) {
+        continue;
+      }
+      const quint64 key = (static_cast<quint64>(host) << 32) | static_cast<quint32>(sensor);
+      const int streak = m_streaks.value(key) + 1;
+      streaks.insert(key, streak);
+      if (streak >= kOutlierStreak) {
+        const double z = mad > 0.0 ? 0.6745 * (value - median) / mad
+                                   : std::copysign(kMaxReportedZ, value - median);
+        report.outliers.append({m_streams[host].key, summary.sensor, value, median,
+                                std::clamp(z, -kMaxReportedZ, kMaxReportedZ), streak});
+      }
+    }
+  }
+  // Host khong lech (hoac khong bao) trong slot nay thi chuoi lech bat dau lai.
+  m_streaks = streaks;
+  report.loop = loopStats();
+  return report;
+}
+
+FleetAggregator::LoopStats FleetAggregator::loopStats() const {
+  LoopStats stats = m_stats;
+  stats.streams = m_streams.size();
+  stats.connected = static_cast<int>(std::count_if(
+      m_streams.cbegin(), m_streams.cend(),
+      [](const Stream &stream) { return stream.fd >= 0 && !stream.connecting; }));
+  return stats;
+}
@@ -0,0 +1,150 @@
+#ifndef FANS_CONTROLLER_FLEET_AGGREGATOR_H
+#define FANS_CONTROLLER_FLEET_AGGREGATOR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <deque>
+
+#include <sys/socket.h>
+
+// Gom luong snapshot JSON tu nhieu instance (TelemetryServer, --serve) thanh mot bang
+// theo thoi gian, khoa theo host ("dia chi:cong") x sensor:
+//   - mot thread, mot epoll cho moi socket non-blocking; moi lan epoll_wait lay toi da
+//     kMaxEvents fd san sang va moi fd doc mot lo 64 KB roi tach het cac dong co trong
+//     do, nen vai tram luong 1 Hz chi ton vai syscall moi giay cho moi luong;
+//   - can theo slot kSlotMs tu timestamp_ms cua instance; slot dong sau graceMs de cho
+//     dong den tre, dong den sau khi slot da dong bi dem la late va bo;
+//   - phan vi p50/p95/p99 cua moi sensor tren ca fleet trong cua so windowSlots slot gan
+//     nhat;
+//   - may bat thuong: trong moi slot so voi trung vi fleet theo MAD (robust z), chi bao
+//     khi lech ca ve ti le lan gia tri tuyet doi va lap lai kOutlierStreak slot lien tiep.
+// Ket noi bi mat duoc tu thu lai voi backoff, khong lam dung vong su kien.
+class FleetAggregator {
+ public:
+  static constexpr int kSlotMs = 1000;
+  static constexpr int kDefaultWindowSlots = 60;
+  static constexpr int kDefaultGraceMs = 1500;
+  static constexpr int kOutlierStreak = 3;
+  static constexpr int kMinHostsForOutliers = 5;
+
+  struct Endpoint {
+    QString host;
+    quint16 port = 0;
+  };
+
+  // "host:port[,host:port-port2...]"; IPv6 viet trong ngoac vuong ("[::1]:47000").
+  static bool parseEndpoints(const QString &spec, QVector<Endpoint> *out, QString *error);
+
+  struct SensorSummary {
+    QString sensor;
+    int hosts = 0;         // So host co gia tri trong slot vua dong.
+    double minimum = 0.0;  // Cua slot vua dong.
+    double maximum = 0.0;
+    double p50 = 0.0;      // Tren cua so windowSlots slot.
+    double p95 = 0.0;
+    double p99 = 0.0;
+  };
+
+  struct Outlier {
+    QString host;
+    QString sensor;
+    double value = 0.0;
+    double fleetMedian = 0.0;
+    double robustZ = 0.0;  // 0.6745 * (value - median) / MAD, gioi han +-99.
+    int streak = 0;        // So slot lien tiep bi danh dau.
+  };
+
+  struct LoopStats {
+    int streams = 0;
+    int connected = 0;
+    quint64 wakeups = 0;     // So lan epoll_wait tra ve.
+    quint64 reads = 0;       // So lan recv co du lieu.
+    quint64 bytes = 0;
+    quint64 lines = 0;
+    quint64 badLines = 0;    // Khong doc duoc timestamp_ms.
+    quint64 lateLines = 0;   // Den sau khi slot da dong.
+    quint64 reconnects = 0;
+  };
+
+  // Mot slot da dong. table[host * sensors.size() + sensor], NaN neu host khong bao.
+  struct SlotReport {
+    qint64 slotMs = 0;
+    QStringList hosts;
+    QStringList sensors;
+    QVector<double> table;
+    int reporting = 0;  // So host co it nhat mot gia tri.
+    QVector<SensorSummary> summaries;
+    QVector<Outlier> outliers;
+    LoopStats loop;
+  };
+
+  explicit FleetAggregator(int windowSlots = kDefaultWindowSlots,
+                           int graceMs = kDefaultGraceMs);
+  ~FleetAggregator();
+  FleetAggregator(const FleetAggregator &) = delete;
+  FleetAggregator &operator=(const FleetAggregator &) = delete;
+
+  // Phan giai dia chi (mot lan, co the block) va bat dau ket noi non-blocking.
+  bool start(const QVector<Endpoint> &endpoints, QString *error);
+
+  // Chay vong su kien toi da timeoutMs; slot da dong duoc them vao *reports theo thu tu.
+  // Tra ve false neu epoll loi (khong phai loi cua tung ket noi).
+  bool poll(int timeoutMs, QVector<SlotReport> *reports, QString *error);
+
+  LoopStats loopStats() const;
+
+ private:
+  struct Stream {
+    QString key;  // "host:port", cung la khoa host trong bang.
+    sockaddr_storage address{};
+    socklen_t addressLength = 0;
+    int fd = -1;
+    bool connecting = false;
+    QByteArray pending;  // Phan dong chua tron.
+    qint64 retryAtMs = 0;
+    int backoffMs = 0;
+  };
+
+  struct Cell {
+    int host;
+    int sensor;
+    double value;
+  };
+
+  // Bang cua mot slot da dong, giu trong cua so de tinh phan vi.
+  struct ClosedSlot {
+    int sensors = 0;
+    QVector<double> table;
+  };
+
+  void connectStream(int index, qint64 nowMs);
+  void dropStream(int index, qint64 nowMs);
+  void readStream(int index, qint64 nowMs);
+  void ingestLine(int host, const char *data, int length, qint64 receivedMs);
+  int sensorId(const QByteArray &name);
+  void closeSlots(qint64 nowMs, QVector<SlotReport> *reports);
+  SlotReport closeSlot(qint64 slotMs, const QVector<Cell> &cells);
+  int nextTimeoutMs(qint64 nowMs, int timeoutMs) const;
+
+  const int m_windowSlots;
+  const int m_graceMs;
+  int m_epollFd = -1;
+  QVector<Stream> m_streams;
+  QByteArray m_readBuffer;
+
+  QHash<QByteArray, int> m_sensorIds;
+  QStringList m_sensorNames;
+  QMap<qint64, QVector<Cell>> m_openSlots;
+  qint64 m_lastClosedSlotMs = -1;
+  std::deque<ClosedSlot> m_window;
+  QHash<quint64, int> m_streaks;  // (host << 32 | sensor) -> so slot lech lien tiep.
+  LoopStats m_stats;
+};
+
+#endif  // FANS_CONTROLLER_FLEET_AGGREGATOR_H
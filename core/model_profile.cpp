@@ -0,0 +1,171 @@
+#include "model_profile.h"
+
+#include <QFile>
+#include <QString>
+
+#include <cstring>
+#include <iterator>
+
+namespace {
+// Thu tu co nghia: profile dau tien khop product_name thang (FX705GE truoc dong FX705G*),
+// profile chung luon o cuoi.
+constexpr ModelProfile kProfiles[] = {
+    {"fx705ge",
+     "ASUS TUF Gaming FX705GE",
+     {"FX705GE"},
+     {"asus", "asus-nb-wmi"},
+     {"coretemp"},
+     {"Package", "id 0"},
+     {"pch", "pch_cannonlake"},
+     {"nvme"},
+     {"acpitz", "acpi"},
+     1,
+     255,
+     30,
+     65,
+     85,
+     {50.0, 25, 90.0, 100},
+     95.0},
+    {"tuf-intel",
+     "ASUS TUF Gaming (Intel, FX505G/FX705G/FX506L/FX706L)",
+     {"FX505G", "FX705G", "FX506L", "FX706L"},
+     {"asus", "asus-nb-wmi"},
+     {"coretemp"},
+     {"Package", "id 0"},
+     {"pch"},
+     {"nvme"},
+     {"acpitz", "acpi"},
+     1,
+     255,
+     30,
+     65,
+     85,
+     {50.0, 25, 88.0, 100},
+     95.0},
+    // Ryzen: k10temp thay coretemp, khong co hwmon PCH.
+    {"tuf-amd",
+     "ASUS TUF Gaming (AMD, FX505D/FX705D/FA506/FA706)",
+     {"FX505D", "FX705D", "FA506", "FA706"},
+     {"asus", "asus-nb-wmi"},
+     {"k10temp"},
+     {"Tctl", "Tdie"},
+     {},
+     {"nvme"},
+     {"acpitz", "acpi"},
+     1,
+     255,
+     30,
+     65,
+     85,
+     {50.0, 25, 85.0, 100},
+     90.0},
+    {"rog-strix-g",
+     "ASUS ROG Strix G (G531G/G731G/G512L/G712L)",
+     {"G531G", "G731G", "G512L", "G712L"},
+     {"asus", "asus-nb-wmi"},
+     {"coretemp"},
+     {"Package", "id 0"},
+     {"pch"},
+     {"nvme"},
+     {"acpitz", "acpi"},
+     1,
+     255,
+     35,
+     70,
+     90,
+     {45.0, 30, 85.0, 100},
+     95.0},
+    {"asus-generic",
+     "ASUS laptop (generic)",
+     {},
+     {"asus"},
+     {"coretemp", "k10temp"},
+     {"Package", "id 0", "Tctl", "Tdie"},
+     {"pch"},
+     {"nvme"},
+     {"acpitz", "acpi"},
+     1,
+     255,
+     30,
+     65,
+     85,
+     {50.0, 25, 90.0, 100},
+     95.0},
+};
+
+constexpr int kMaxPwmChannel = 32;  // DeviceProbe::kMaxChannels.
+
+constexpr bool isValid(const ModelProfile &profile) {
+  const ModelProfile::SafeCurve &curve = profile.safeCurve;
+  return profile.id && profile.displayName && profile.fanHwmon[0] && profile.cpuHwmon[0] &&
+         profile.packageLabels[0] && profile.fanPwmChannel >= 1 &&
+         profile.fanPwmChannel <= kMaxPwmChannel && profile.pwmMaxFallback > 0 &&
+         profile.silentPercent > 0 && profile.silentPercent <= profile.performancePercent &&
+         profile.performancePercent <= profile.turboPercent && profile.turboPercent <= 100 &&
+         curve.lowC < curve.highC && curve.lowPercent >= 0 &&
+         curve.lowPercent <= curve.highPercent && curve.highPercent <= 100 &&
+         curve.highC < profile.criticalC;
+}
+
+constexpr bool tableIsValid() {
+  for (const ModelProfile &profile : kProfiles) {
+    if (!isValid(profile)) {
+      return false;
+    }
+  }
+  // Chi profile cuoi (chung) duoc khong co needle product_name.
+  for (size_t i = 0; i + 1 < std::size(kProfiles); ++i) {
+    if (!kProfiles[i].productNeedles[0]) {
+      return false;
+    }
+  }
+  return !kProfiles[std::size(kProfiles) - 1].productNeedles[0];
+}
+
+static_assert(tableIsValid(),
+              "ModelProfile: preset phai tang dan, duong cong an toan duoi nguong critical, "
+              "profile chung o cuoi");
+}  // namespace
+
+const ModelProfile &ModelProfile::select(const char *productName) {
+  const QByteArray forced = qEnvironmentVariable("FANS_CONTROLLER_MODEL").toUtf8();
+  if (const ModelProfile *profile = forced.isEmpty() ? nullptr : byId(forced.constData())) {
+    return *profile;
+  }
+  const QString product = QString::fromUtf8(productName);
+  for (const ModelProfile &profile : kProfiles) {
+    for (const char *needle : profile.productNeedles) {
+      if (needle && product.contains(QString::fromLatin1(needle), Qt::CaseInsensitive)) {
+        return profile;
+      }
+    }
+  }
+  return kProfiles[std::size(kProfiles) - 1];
+}
+
+const ModelProfile &ModelProfile::detected() {
+  static const ModelProfile &profile = []() -> const ModelProfile & {
+    QFile file("/sys/class/dmi/id/product_name");
+    const QByteArray product =
+        file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+    return select(product.constData());
+  }();
+  return profile;
+}
+
+const ModelProfile *ModelProfile::byId(const char *id) {
+  for (const ModelProfile &profile : kProfiles) {
+    if (std::strcmp(profile.id, id) == 0) {
+      return &profile;
+    }
+  }
+  return nullptr;
+}
+
+int ModelProfile::count() {
+  return static_cast<int>(std::size(kProfiles));
+}
+
+const ModelProfile &ModelProfile::at(int index) {
+  return kProfiles[index];
+}
@@ -0,0 +1,51 @@
+#ifndef FANS_CONTROLLER_MODEL_PROFILE_H
+#define FANS_CONTROLLER_MODEL_PROFILE_H
+
+#include <array>
+
+// Mo ta phan cung cua mot dong may ASUS TUF/ROG: hwmon nao chua sensor/quat, kenh PWM,
+// preset %, duong cong an toan va nguong nhiet nguy hiem. Cac bang la constexpr trong
+// model_profile.cpp va duoc static_assert kiem tra luc bien dich; profile duoc chon mot
+// lan luc khoi dong theo /sys/class/dmi/id/product_name (nhu sensors_report.sh), nen
+// vong refresh chi chay ke hoach doc da dung san, khong so khop chuoi.
+struct ModelProfile {
+  // Toi da 4 needle, phan con lai la nullptr. So khop chuoi con, khong phan biet hoa thuong.
+  using Needles = std::array<const char *, 4>;
+
+  // Duong cong tuyen tinh (lowC, lowPercent) -> (highC, highPercent), dang FanPolicy curve.
+  struct SafeCurve {
+    double lowC;
+    int lowPercent;
+    double highC;
+    int highPercent;
+  };
+
+  const char *id;           // Dung cho FANS_CONTROLLER_MODEL va bao cao --probe.
+  const char *displayName;
+  Needles productNeedles;   // Rong: profile chung, dung khi khong khop profile nao.
+  Needles fanHwmon;         // hwmon co fanN_input/pwmN cua EC.
+  Needles cpuHwmon;         // coretemp (Intel) / k10temp (AMD).
+  Needles packageLabels;    // tempN_label cua kenh CPU package ("Package id 0", "Tctl").
+  Needles pchHwmon;
+  Needles nvmeHwmon;
+  Needles acpiHwmon;
+  int fanPwmChannel;        // pwmN/fanN cua quat CPU.
+  int pwmMaxFallback;       // Khi khong co pwmN_max.
+  int silentPercent;
+  int performancePercent;
+  int turboPercent;
+  SafeCurve safeCurve;      // Chinh sach "safe" (FanPolicy) cho may nay.
+  double criticalC;         // Nguong FanWatchdog ep quat theo nhiet do.
+
+  // FANS_CONTROLLER_MODEL=<id> neu dat (va ton tai), neu khong thi profile dau tien co
+  // needle nam trong productName, cuoi cung la profile chung.
+  static const ModelProfile &select(const char *productName);
+  // select() voi product_name cua may dang chay (doc mot lan).
+  static const ModelProfile &detected();
+  static const ModelProfile *byId(const char *id);
+
+  static int count();
+  static const ModelProfile &at(int index);
+};
+
+#endif  // FANS_CONTROLLER_MODEL_PROFILE_H
@@ -0,0 +1,168 @@
+#include "proc_connector.h"
+
+#include <arpa/inet.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/filter.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+// Vi tri cac truong cua proc_event trong mot datagram: nlmsghdr | cn_msg | proc_event.
+constexpr quint32 kEventOffset = NLMSG_HDRLEN + offsetof(cn_msg, data);
+constexpr quint32 kWhatOffset = kEventOffset + offsetof(proc_event, what);
+constexpr quint32 kExitPidOffset =
+    kEventOffset + offsetof(proc_event, event_data.exit.process_pid);
+constexpr quint32 kExitTgidOffset =
+    kEventOffset + offsetof(proc_event, event_data.exit.process_tgid);
+// Ngan nhat con du pid/tgid cua su kien exec/exit.
+constexpr size_t kMinEventLength = offsetof(proc_event, event_data.exit.process_tgid) + 4;
+
+QString errnoText(const char *what) {
+  return QString("%1: %2").arg(what, QString::fromLocal8Bit(std::strerror(errno)));
+}
+}  // namespace
+
+ProcConnector::~ProcConnector() {
+  close();
+}
+
+bool ProcConnector::open(QString *error) {
+  close();
+  m_fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+  if (m_fd < 0) {
+    *error = errnoText("Khong tao duoc socket NETLINK_CONNECTOR");
+    return false;
+  }
+  sockaddr_nl addr{};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = CN_IDX_PROC;
+  if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    *error = errnoText("Khong bind duoc proc connector (can CAP_NET_ADMIN)");
+    close();
+    return false;
+  }
+  // Gan bo loc truoc khi dang ky de khong nhan dot su kien chua loc nao.
+  m_stats = Stats();
+  m_stats.kernelFilter = attachFilter();
+  if (!sendListen(true)) {
+    *error = errnoText("Khong dang ky duoc PROC_CN_MCAST_LISTEN");
+    close();
+    return false;
+  }
+  return true;
+}
+
+void ProcConnector::close() {
+  if (m_fd < 0) {
+    return;
+  }
+  // Kernel dem so listener toan cuc va chi sinh su kien khi > 0: huy dang ky truoc.
+  sendListen(false);
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+bool ProcConnector::attachFilter() {
+  // Chi giu PROC_EVENT_EXEC va PROC_EVENT_EXIT cua tien trinh (pid == tgid, khong phai
+  // thread). Lenh LD|ABS cua BPF doc big-endian nen so sanh voi htonl(hang so).
+  sock_filter code[] = {
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, kWhatOffset),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(proc_event::PROC_EVENT_EXEC), 5, 0),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(proc_event::PROC_EVENT_EXIT), 0, 5),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, kExitTgidOffset),
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, kExitPidOffset),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_X, 0, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K, 0xffffffffu),
+      BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  sock_fprog program{};
+  program.len = sizeof(code) / sizeof(code[0]);
+  program.filter = code;
+  // Khong gan duoc (vd. seccomp) thi van chay, readEvents() tu loc o user space.
+  return ::setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) == 0;
+}
+
+bool ProcConnector::sendListen(bool listen) {
+  constexpr size_t kPayload = sizeof(cn_msg) + sizeof(proc_cn_mcast_op);
+  alignas(nlmsghdr) char buffer[NLMSG_SPACE(kPayload)] = {};
+
+  auto *header = reinterpret_cast<nlmsghdr *>(buffer);
+  header->nlmsg_len = NLMSG_LENGTH(kPayload);
+  header->nlmsg_type = NLMSG_DONE;
+  header->nlmsg_pid = static_cast<__u32>(::getpid());
+
+  auto *message = static_cast<cn_msg *>(NLMSG_DATA(header));
+  message->id.idx = CN_IDX_PROC;
+  message->id.val = CN_VAL_PROC;
+  message->len = sizeof(proc_cn_mcast_op);
+  const proc_cn_mcast_op op = listen ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+  std::memcpy(message->data, &op, sizeof(op));
+
+  ssize_t sent;
+  do {
+    sent = ::send(m_fd, buffer, header->nlmsg_len, 0);
+  } while (sent < 0 && errno == EINTR);
+  return sent == static_cast<ssize_t>(header->nlmsg_len);
+}
+
+bool ProcConnector::readEvents(QVector<Event> *out, bool *overrun) {
+  *overrun = false;
+  if (m_fd < 0) {
+    return false;
+  }
+  alignas(nlmsghdr) char buffer[8192];
+  for (;;) {
+    const ssize_t received = ::recv(m_fd, buffer, sizeof(buffer), 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      }
+      if (errno == ENOBUFS) {
+        // Kernel da bo su kien; socket van dung duoc.
+        *overrun = true;
+        ++m_stats.overruns;
+        continue;
+      }
+      return false;
+    }
+    if (received == 0) {
+      return true;
+    }
+    ++m_stats.datagrams;
+
+    int remaining = static_cast<int>(received);
+    for (auto *header = reinterpret_cast<nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+         header = NLMSG_NEXT(header, remaining)) {
+      if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) {
+        continue;
+      }
+      const auto *message = static_cast<const cn_msg *>(NLMSG_DATA(header));
+      if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC ||
+          message->len < kMinEventLength) {
+        continue;
+      }
+      // Du lieu trong datagram khong dam bao canh le 8 byte cua proc_event.
+      proc_event event{};
+      std::memcpy(&event, message->data, std::min<size_t>(message->len, sizeof(event)));
+      if (event.what == proc_event::PROC_EVENT_EXEC) {
+        out->append({Event::Type::Exec, event.event_data.exec.process_tgid});
+        ++m_stats.events;
+      } else if (event.what == proc_event::PROC_EVENT_EXIT &&
+                 event.event_data.exit.process_pid == event.event_data.exit.process_tgid) {
+        out->append({Event::Type::Exit, event.event_data.exit.process_pid});
+        ++m_stats.events;
+      }
+    }
+  }
+}
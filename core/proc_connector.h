@@ -0,0 +1,54 @@
+#ifndef FANS_CONTROLLER_PROC_CONNECTOR_H
+#define FANS_CONTROLLER_PROC_CONNECTOR_H
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Nhan su kien exec/exit cua tien trinh tu kernel qua netlink proc connector
+// (NETLINK_CONNECTOR, nhom CN_IDX_PROC) thay vi quet /proc dinh ky. Socket gan them
+// bo loc BPF de kernel bo cac su kien khong can (fork, uid/gid, comm, thread thoat...),
+// nen khi khong co tien trinh moi thi khong co lan danh thuc nao. Can CAP_NET_ADMIN.
+class ProcConnector {
+ public:
+  struct Event {
+    enum class Type { Exec, Exit };
+    Type type;
+    int pid;
+  };
+
+  // Thong ke de biet bo loc BPF co hieu luc va co bi tran bo dem hay khong.
+  struct Stats {
+    quint64 datagrams = 0;
+    quint64 events = 0;
+    quint64 overruns = 0;
+    bool kernelFilter = false;
+  };
+
+  ProcConnector() = default;
+  ~ProcConnector();
+  ProcConnector(const ProcConnector &) = delete;
+  ProcConnector &operator=(const ProcConnector &) = delete;
+
+  // Mo socket non-blocking va dang ky nhan su kien. Tra ve false kem ly do neu khong
+  // du quyen hoac kernel khong co CONFIG_PROC_EVENTS.
+  bool open(QString *error);
+  void close();
+  bool isOpen() const { return m_fd >= 0; }
+  int fd() const { return m_fd; }
+
+  // Doc het cac datagram dang cho vao out (khong block). *overrun = true neu kernel da
+  // bo su kien vi bo dem socket day; khi do nguoi goi nen dong bo lai mot lan tu /proc.
+  bool readEvents(QVector<Event> *out, bool *overrun);
+
+  Stats stats() const { return m_stats; }
+
+ private:
+  bool attachFilter();
+  bool sendListen(bool listen);
+
+  int m_fd = -1;
+  Stats m_stats;
+};
+
+#endif  // FANS_CONTROLLER_PROC_CONNECTOR_H
@@ -0,0 +1,57 @@
+#include "process_footprint.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <ctime>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+ProcessFootprint ProcessFootprint::sample() {
+  ProcessFootprint footprint;
+
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  footprint.monotonicMs = static_cast<qint64>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+
+  // statm: size resident shared ... (don vi trang).
+  if (FILE *statm = std::fopen("/proc/self/statm", "re")) {
+    long long sizePages = 0;
+    long long residentPages = 0;
+    if (std::fscanf(statm, "%lld %lld", &sizePages, &residentPages) == 2) {
+      footprint.rssKb = residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+    std::fclose(statm);
+  }
+
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    footprint.cpuUs = static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+                          1000000 +
+                      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    footprint.voluntarySwitches = static_cast<quint64>(usage.ru_nvcsw);
+    footprint.involuntarySwitches = static_cast<quint64>(usage.ru_nivcsw);
+  }
+  return footprint;
+}
+
+QString ProcessFootprint::describeSince(const ProcessFootprint &earlier) const {
+  const double seconds = qMax<qint64>(1, monotonicMs - earlier.monotonicMs) / 1000.0;
+  const double wakeups = static_cast<double>(voluntarySwitches - earlier.voluntarySwitches) /
+                         seconds;
+  const double cpuPercent = (cpuUs - earlier.cpuUs) / (seconds * 10000.0);
+  return QString("RSS %1 kB, %2 wakeups/s, CPU %3% trong %4 s")
+      .arg(rssKb)
+      .arg(wakeups, 0, 'f', 1)
+      .arg(cpuPercent, 0, 'f', 3)
+      .arg(seconds, 0, 'f', 0);
+}
+
+void ProcessFootprint::releaseFreedHeap() {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
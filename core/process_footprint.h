@@ -0,0 +1,27 @@
+#ifndef FANS_CONTROLLER_PROCESS_FOOTPRINT_H
+#define FANS_CONTROLLER_PROCESS_FOOTPRINT_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Anh chup muc tieu thu tai nguyen cua chinh tien trinh: RSS tu /proc/self/statm,
+// thoi gian CPU va so lan context switch (tinh ca moi thread) tu getrusage(). Hai anh
+// chup tru nhau cho biet so lan danh thuc/giay va CPU trong mot khoang thoi gian.
+struct ProcessFootprint {
+  qint64 rssKb = 0;
+  qint64 cpuUs = 0;                // user + system.
+  quint64 voluntarySwitches = 0;   // Thread tu ngu (poll/timer): xap xi so lan danh thuc.
+  quint64 involuntarySwitches = 0;
+  qint64 monotonicMs = 0;          // Moc thoi gian cua anh chup.
+
+  static ProcessFootprint sample();
+
+  // Mo ta khoang tu earlier den *this: "RSS 41234 kB, 2.1 wakeups/s, CPU 0.03%".
+  QString describeSince(const ProcessFootprint &earlier) const;
+
+  // Goi lai bo nho heap da giai phong cho he dieu hanh (glibc giu lai trong arena nen
+  // RSS khong giam sau khi xoa cay widget neu khong trim).
+  static void releaseFreedHeap();
+};
+
+#endif  // FANS_CONTROLLER_PROCESS_FOOTPRINT_H
@@ -0,0 +1,155 @@
+#include "process_profile_switcher.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+ProcessProfileSwitcher::ProcessProfileSwitcher(QObject *parent) : QObject(parent) {
+  m_releaseTimer.setSingleShot(true);
+  m_releaseTimer.setInterval(kReleaseDelayMs);
+  connect(&m_releaseTimer, &QTimer::timeout, this, &ProcessProfileSwitcher::releaseExpired);
+}
+
+bool ProcessProfileSwitcher::start(const QString &rulesPath, QString *error) {
+  if (!ProcessRules::load(rulesPath, &m_rules, error) || m_rules.isEmpty()) {
+    return false;
+  }
+  if (!m_connector.open(error)) {
+    return false;
+  }
+  m_ruleCounts.fill(0, m_rules.size());
+  m_notifier = new QSocketNotifier(m_connector.fd(), QSocketNotifier::Read, this);
+  connect(m_notifier, &QSocketNotifier::activated, this, &ProcessProfileSwitcher::handleReadable);
+  // Dang ky truoc roi moi quet: tien trinh exec giua hai buoc van den qua socket.
+  rescanProc();
+  return true;
+}
+
+void ProcessProfileSwitcher::handleReadable() {
+  m_events.clear();
+  bool overrun = false;
+  if (!m_connector.readEvents(&m_events, &overrun)) {
+    qWarning("Proc connector loi, dung chuyen profile theo tien trinh.");
+    m_notifier->setEnabled(false);
+    return;
+  }
+  if (overrun) {
+    // Da mat su kien: dong bo lai toan bo mot lan thay vi doan.
+    rescanProc();
+    return;
+  }
+  for (const ProcConnector::Event &event : m_events) {
+    if (event.type == ProcConnector::Event::Type::Exec) {
+      processStarted(event.pid);
+    } else {
+      processExited(event.pid);
+    }
+  }
+  updateActiveRule();
+}
+
+void ProcessProfileSwitcher::rescanProc() {
+  m_matched.clear();
+  m_ruleCounts.fill(0, m_rules.size());
+  if (DIR *dir = opendir("/proc")) {
+    while (const dirent *entry = readdir(dir)) {
+      char *end = nullptr;
+      const long pid = std::strtol(entry->d_name, &end, 10);
+      if (pid > 0 && *end == '\0') {
+        processStarted(static_cast<int>(pid));
+      }
+    }
+    closedir(dir);
+  }
+  updateActiveRule();
+}
+
+void ProcessProfileSwitcher::processStarted(int pid) {
+  // exec lai trong cung tien trinh (vd. shell -> game) thay the quy tac cu cua pid.
+  processExited(pid);
+  const int rule = m_rules.match(exeName(pid), commName(pid));
+  if (rule >= 0) {
+    m_matched.insert(pid, rule);
+    ++m_ruleCounts[rule];
+  }
+}
+
+void ProcessProfileSwitcher::processExited(int pid) {
+  const auto it = m_matched.constFind(pid);
+  if (it == m_matched.constEnd()) {
+    return;
+  }
+  --m_ruleCounts[*it];
+  m_matched.remove(pid);
+}
+
+int ProcessProfileSwitcher::bestRule() const {
+  for (qsizetype i = 0; i < m_ruleCounts.size(); ++i) {
+    if (m_ruleCounts[i] > 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void ProcessProfileSwitcher::updateActiveRule() {
+  const int best = bestRule();
+  if (best == m_activeRule) {
+    m_releaseTimer.stop();
+    return;
+  }
+  if (best >= 0 && (m_activeRule < 0 || best < m_activeRule)) {
+    // Quy tac moi hoac uu tien cao hon: ap dung ngay.
+    m_releaseTimer.stop();
+    m_activeRule = best;
+    emit activeRuleChanged(m_activeRule);
+    return;
+  }
+  if (!m_releaseTimer.isActive()) {
+    m_releaseTimer.start();
+  }
+}
+
+void ProcessProfileSwitcher::releaseExpired() {
+  const int best = bestRule();
+  if (best != m_activeRule) {
+    m_activeRule = best;
+    emit activeRuleChanged(m_activeRule);
+  }
+}
+
+QByteArray ProcessProfileSwitcher::exeName(int pid) {
+  char path[32];
+  std::snprintf(path, sizeof(path), "/proc/%d/exe", pid);
+  char target[4096];
+  const ssize_t length = readlink(path, target, sizeof(target) - 1);
+  if (length <= 0) {
+    return {};  // Thread kernel, tien trinh da thoat hoac khong du quyen.
+  }
+  QByteArray name(target, length);
+  const qsizetype slash = name.lastIndexOf('/');
+  name = name.mid(slash + 1);
+  if (name.endsWith(" (deleted)")) {
+    name.chop(10);
+  }
+  return name;
+}
+
+QByteArray ProcessProfileSwitcher::commName(int pid) {
+  char path[32];
+  std::snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return {};
+  }
+  char buffer[64];
+  const ssize_t length = ::read(fd, buffer, sizeof(buffer));
+  ::close(fd);
+  if (length <= 0) {
+    return {};
+  }
+  return QByteArray(buffer, length).trimmed();
+}
@@ -0,0 +1,63 @@
+#ifndef FANS_CONTROLLER_PROCESS_PROFILE_SWITCHER_H
+#define FANS_CONTROLLER_PROCESS_PROFILE_SWITCHER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QVector>
+
+#include "proc_connector.h"
+#include "process_rules.h"
+
+// Chuyen profile quat theo tien trinh dang chay: nhan exec/exit tu ProcConnector qua
+// QSocketNotifier tren event loop (khong polling), doi chieu voi ProcessRules va phat
+// activeRuleChanged() khi quy tac uu tien cao nhat con tien trinh khop thay doi.
+// Chi quet /proc mot lan luc start() (va khi kernel bao tran bo dem) de biet cac tien
+// trinh da chay tu truoc. Quy tac moi/uu tien cao hon ap dung ngay; khi tien trinh cuoi
+// cung cua quy tac thoat thi cho kReleaseDelayMs de cac tien trinh ngan (vd. cc1plus
+// trong mot lan build) khong lam profile nhay qua lai.
+class ProcessProfileSwitcher : public QObject {
+  Q_OBJECT
+
+ public:
+  static constexpr int kReleaseDelayMs = 5000;
+
+  explicit ProcessProfileSwitcher(QObject *parent = nullptr);
+
+  // Nap quy tac va mo proc connector. Tra ve false neu khong co quy tac (error rong)
+  // hoac khong the theo doi tien trinh (error mo ta ly do).
+  bool start(const QString &rulesPath, QString *error);
+
+  const ProcessRules &rules() const { return m_rules; }
+  int activeRule() const { return m_activeRule; }
+  ProcConnector::Stats connectorStats() const { return m_connector.stats(); }
+
+ signals:
+  // ruleIndex = -1 khi khong con tien trinh nao khop quy tac.
+  void activeRuleChanged(int ruleIndex);
+
+ private:
+  void handleReadable();
+  void rescanProc();
+  void processStarted(int pid);
+  void processExited(int pid);
+  void updateActiveRule();
+  void releaseExpired();
+  int bestRule() const;
+
+  static QByteArray exeName(int pid);
+  static QByteArray commName(int pid);
+
+  ProcessRules m_rules;
+  ProcConnector m_connector;
+  QSocketNotifier *m_notifier = nullptr;
+  QTimer m_releaseTimer;
+  QVector<ProcConnector::Event> m_events;  // Dung lai giua cac lan doc, tranh cap phat.
+  QHash<int, int> m_matched;               // pid -> quy tac khop.
+  QVector<int> m_ruleCounts;               // So tien trinh dang khop moi quy tac.
+  int m_activeRule = -1;
+};
+
+#endif  // FANS_CONTROLLER_PROCESS_PROFILE_SWITCHER_H
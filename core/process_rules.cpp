@@ -0,0 +1,80 @@
+#include "process_rules.h"
+
+#include <QDir>
+#include <QFile>
+#include <QList>
+
+#include <fnmatch.h>
+
+QString ProcessRules::defaultPath() {
+  QString configHome = qEnvironmentVariable("XDG_CONFIG_HOME");
+  if (configHome.isEmpty()) {
+    configHome = QDir::homePath() + "/.config";
+  }
+  return configHome + "/fans-controller/rules.conf";
+}
+
+bool ProcessRules::load(const QString &path, ProcessRules *rules, QString *error) {
+  QFile file(path);
+  if (!file.exists()) {
+    *rules = ProcessRules();
+    return true;
+  }
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = QString("Khong doc duoc %1").arg(path);
+    return false;
+  }
+  return parse(file.readAll(), rules, error);
+}
+
+bool ProcessRules::parse(const QByteArray &text, ProcessRules *rules, QString *error) {
+  ProcessRules parsed;
+  const QList<QByteArray> lines = text.split('\n');
+  for (qsizetype i = 0; i < lines.size(); ++i) {
+    QByteArray line = lines[i];
+    const qsizetype comment = line.indexOf('#');
+    if (comment >= 0) {
+      line = line.left(comment);
+    }
+    line = line.trimmed();
+    if (line.isEmpty()) {
+      continue;
+    }
+    const int lineNumber = static_cast<int>(i + 1);
+    const qsizetype equals = line.indexOf('=');
+    const QByteArray pattern = equals > 0 ? line.left(equals).trimmed() : QByteArray();
+    const QByteArray spec = equals > 0 ? line.mid(equals + 1).trimmed() : QByteArray();
+    if (pattern.isEmpty() || spec.isEmpty()) {
+      *error = QString("rules.conf dong %1: can dang <mau tien trinh> = <profile>").arg(lineNumber);
+      return false;
+    }
+    Rule rule;
+    rule.pattern = QString::fromUtf8(pattern);
+    rule.patternBytes = pattern;
+    rule.line = lineNumber;
+    QString policyError;
+    if (!FanPolicy::parse(QString::fromUtf8(spec), &rule.policy, &policyError)) {
+      *error = QString("rules.conf dong %1: %2").arg(lineNumber).arg(policyError);
+      return false;
+    }
+    if (rule.policy.kind == FanPolicy::Kind::FirmwareAuto) {
+      // Khi khong con tien trinh khop, profile tu dong tra ve lua chon cua nguoi dung.
+      *error = QString("rules.conf dong %1: 'auto' khong dung duoc trong quy tac").arg(lineNumber);
+      return false;
+    }
+    parsed.m_rules.append(rule);
+  }
+  *rules = parsed;
+  return true;
+}
+
+int ProcessRules::match(const QByteArray &exeName, const QByteArray &comm) const {
+  for (qsizetype i = 0; i < m_rules.size(); ++i) {
+    const char *pattern = m_rules[i].patternBytes.constData();
+    if ((!exeName.isEmpty() && fnmatch(pattern, exeName.constData(), 0) == 0) ||
+        (!comm.isEmpty() && fnmatch(pattern, comm.constData(), 0) == 0)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,45 @@
+#ifndef FANS_CONTROLLER_PROCESS_RULES_H
+#define FANS_CONTROLLER_PROCESS_RULES_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "fan_policy.h"
+
+// Quy tac chuyen profile quat theo tien trinh, doc tu rules.conf, moi dong mot quy tac:
+//   # chu thich
+//   steam_app_*  = turbo
+//   cc1plus      = fixed:70
+//   blender      = curve:50:40:85:100
+// Ve trai la mau glob (fnmatch) so voi ten file thuc thi (basename /proc/PID/exe) hoac
+// comm; ve phai la preset (silent/performance/turbo), fixed:N hoac curve:T0:P0:T1:P1.
+// Nhieu tien trinh khop cung luc thi quy tac dung truoc trong file thang.
+class ProcessRules {
+ public:
+  struct Rule {
+    QString pattern;
+    QByteArray patternBytes;  // Ma hoa san cho fnmatch().
+    FanPolicy policy;
+    int line;
+  };
+
+  // $XDG_CONFIG_HOME/fans-controller/rules.conf (mac dinh ~/.config/...).
+  static QString defaultPath();
+
+  // Khong co file thi tra ve true voi danh sach rong; sai cu phap thi false kem loi.
+  static bool load(const QString &path, ProcessRules *rules, QString *error);
+  static bool parse(const QByteArray &text, ProcessRules *rules, QString *error);
+
+  // Chi so quy tac dau tien khop exeName hoac comm; -1 neu khong quy tac nao khop.
+  int match(const QByteArray &exeName, const QByteArray &comm) const;
+
+  bool isEmpty() const { return m_rules.isEmpty(); }
+  qsizetype size() const { return m_rules.size(); }
+  const Rule &rule(int index) const { return m_rules[index]; }
+
+ private:
+  QVector<Rule> m_rules;
+};
+
+#endif  // FANS_CONTROLLER_PROCESS_RULES_H
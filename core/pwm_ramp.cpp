@@ -0,0 +1,91 @@
+#include "pwm_ramp.h"
+
+#include <algorithm>
+#include <cmath>
+
+PwmRamp::PwmRamp(double percentPerSecond) : m_rate(percentPerSecond) {}
+
+void PwmRamp::setRate(double percentPerSecond) {
+  m_rate = percentPerSecond;
+}
+
+void PwmRamp::setTarget(int channel, int targetPwm, int pwmMax, int currentPwm, qint64 nowMs) {
+  if (!isActive()) {
+    // Moc thoi gian bat dau tu luc co dich moi, khong tinh khoang nghi truoc do.
+    m_lastAdvanceMs = nowMs;
+  }
+  const int clampedTarget = std::clamp(targetPwm, 0, pwmMax);
+  if (Channel *ch = find(channel)) {
+    ch->target = clampedTarget;  // Preempt: giu position, chi doi dich.
+    ch->pwmMax = pwmMax;
+    return;
+  }
+  const int start = std::clamp(currentPwm, 0, pwmMax);
+  m_channels.append({channel, pwmMax, static_cast<double>(start), clampedTarget, start});
+}
+
+QVector<PwmRamp::Step> PwmRamp::advance(qint64 nowMs) {
+  QVector<Step> steps;
+  const double elapsedMs = static_cast<double>(std::max<qint64>(0, nowMs - m_lastAdvanceMs));
+  m_lastAdvanceMs = nowMs;
+
+  for (Channel &ch : m_channels) {
+    const double target = ch.target;
+    if (m_rate <= 0.0) {
+      ch.position = target;
+    } else {
+      const double maxDelta = unitsPerMs(ch) * elapsedMs;
+      const double delta = std::clamp(target - ch.position, -maxDelta, maxDelta);
+      ch.position += delta;
+    }
+    const int pwm = static_cast<int>(std::lround(ch.position));
+    if (pwm != ch.written) {
+      ch.written = pwm;
+      steps.append({ch.channel, pwm});
+    }
+  }
+
+  // Kenh da toi dich thi bo khoi danh sach; lan sau bat dau lai tu gia tri doc duoc.
+  m_channels.erase(std::remove_if(m_channels.begin(), m_channels.end(),
+                                  [](const Channel &ch) {
+                                    return ch.written == ch.target &&
+                                           ch.position == static_cast<double>(ch.target);
+                                  }),
+                   m_channels.end());
+  return steps;
+}
+
+bool PwmRamp::isActive() const {
+  return !m_channels.isEmpty();
+}
+
+qint64 PwmRamp::nextDeadlineMs() const {
+  if (m_rate <= 0.0) {
+    return m_lastAdvanceMs;  // Nhay thang: xu ly ngay.
+  }
+  // Moc chung cho moi kenh: thoi gian de kenh nhanh nhat doi 1 don vi PWM,
+  // khong nho hon kMinStepMs de cac buoc duoc gop thanh mot lan ghi.
+  double msPerUnit = 1e9;
+  for (const Channel &ch : m_channels) {
+    msPerUnit = std::min(msPerUnit, 1.0 / unitsPerMs(ch));
+  }
+  return m_lastAdvanceMs + std::max<qint64>(kMinStepMs, static_cast<qint64>(std::ceil(msPerUnit)));
+}
+
+bool PwmRamp::contains(int channel) const {
+  return std::any_of(m_channels.begin(), m_channels.end(),
+                     [channel](const Channel &ch) { return ch.channel == channel; });
+}
+
+PwmRamp::Channel *PwmRamp::find(int channel) {
+  for (Channel &ch : m_channels) {
+    if (ch.channel == channel) {
+      return &ch;
+    }
+  }
+  return nullptr;
+}
+
+double PwmRamp::unitsPerMs(const Channel &ch) const {
+  return m_rate * ch.pwmMax / 100.0 / 1000.0;
+}
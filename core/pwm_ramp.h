@@ -0,0 +1,56 @@
+#ifndef FANS_CONTROLLER_PWM_RAMP_H
+#define FANS_CONTROLLER_PWM_RAMP_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// Bo tao ramp PWM gioi han toc do thay doi (%/giay) cho nhieu kenh quat.
+// Khong tu so huu timer: noi goi (FanCommandActor) dung mot moc thoi gian duy nhat
+// nextDeadlineMs() cho tat ca kenh, goi advance() va ghi mot lo cac buoc tra ve.
+// Chi sinh buoc khi gia tri PWM nguyen thuc su doi; setTarget() giua chung ramp
+// se doi dich ma giu nguyen vi tri hien tai (khong nhay).
+class PwmRamp {
+ public:
+  static constexpr double kDefaultRatePercentPerSecond = 50.0;
+  static constexpr qint64 kMinStepMs = 25;  // Gop cac buoc nho de giam so lan ghi EC.
+
+  struct Step {
+    int channel;
+    int pwm;
+  };
+
+  explicit PwmRamp(double percentPerSecond = kDefaultRatePercentPerSecond);
+
+  // <= 0: khong gioi han, lan advance() ke tiep nhay thang toi dich.
+  void setRate(double percentPerSecond);
+  double rate() const { return m_rate; }
+
+  // Dat dich cho kenh. currentPwm chi dung khi kenh chua duoc theo doi (lan dau).
+  void setTarget(int channel, int targetPwm, int pwmMax, int currentPwm, qint64 nowMs);
+
+  // Tien cac kenh toi nowMs, tra ve cac buoc lam doi gia tri PWM nguyen.
+  QVector<Step> advance(qint64 nowMs);
+
+  bool isActive() const;                 // Con kenh chua toi dich.
+  qint64 nextDeadlineMs() const;         // Moc nen goi advance() tiep theo.
+  bool contains(int channel) const;
+  void clear() { m_channels.clear(); }
+
+ private:
+  struct Channel {
+    int channel;
+    int pwmMax;
+    double position;  // Vi tri lien tuc (don vi PWM).
+    int target;
+    int written;      // Gia tri nguyen da ghi gan nhat.
+  };
+
+  Channel *find(int channel);
+  double unitsPerMs(const Channel &ch) const;
+
+  double m_rate;
+  qint64 m_lastAdvanceMs = 0;
+  QVector<Channel> m_channels;
+};
+
+#endif  // FANS_CONTROLLER_PWM_RAMP_H
@@ -0,0 +1,301 @@
+#include "self_overhead.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Dem cap phat bang cach boc malloc cua glibc ngay trong file thuc thi (ld uu tien ky hieu
+// cua executable, nen ca Qt/libstdc++ cung di qua day). Chi bat khi build voi
+// -DFANS_CONTROLLER_COUNT_ALLOCATIONS=ON; ngoai glibc hoac khi build voi sanitizer (tu
+// thay malloc) thi van tat. Khi tat, chi so cap phat bao "n/a".
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || \
+    __has_feature(memory_sanitizer)
+#define FANS_CONTROLLER_SANITIZED 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define FANS_CONTROLLER_SANITIZED 1
+#endif
+#if defined(FANS_CONTROLLER_COUNT_ALLOCATIONS) && \
+    (!defined(__GLIBC__) || defined(FANS_CONTROLLER_SANITIZED))
+#undef FANS_CONTROLLER_COUNT_ALLOCATIONS
+#endif
+
+namespace {
+// TLS cua executable la tinh (local-exec), truy cap khong cap phat nen dung duoc trong
+// malloc.
+thread_local quint64 t_allocations = 0;
+}  // namespace
+
+#ifdef FANS_CONTROLLER_COUNT_ALLOCATIONS
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+
+void *malloc(size_t size) noexcept {
+  ++t_allocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept {
+  ++t_allocations;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) noexcept {
+  ++t_allocations;
+  return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) noexcept {
+  __libc_free(pointer);
+}
+}
+#endif
+
+namespace {
+struct MetricInfo {
+  const char *key;
+  const char *label;
+  const char *unit;
+  int decimals;
+  double defaultBudget;
+};
+
+// Mac dinh cho chu ky 1 s: watchdog 10 Hz + sampler + heartbeat GUI ~ 14 wakeups/s;
+// backend plain ton 3 syscall moi thuoc tinh, io_uring ~1 cho ca lan refresh.
+constexpr MetricInfo kMetrics[SelfOverhead::kMetricCount] = {
+    {"cpu", "CPU", "%", 3, 0.1},
+    {"wakeups", "Wakeups", "/s", 1, 20.0},
+    {"syscalls", "Syscalls", "/refresh", 1, 64.0},
+    {"sysfs_reads", "Sysfs reads", "/refresh", 1, 32.0},
+    {"allocations", "Heap allocations", "/refresh", 1, 256.0},
+    {"rss_kb", "RSS", "kB", 0, 153600.0},
+};
+
+constexpr char kTaskDir[] = "/proc/self/task";
+
+// Doc toan bo file /proc nho vao buf (ket thuc bang '\0'); -1 neu loi.
+ssize_t readProcFile(const char *path, char *buf, size_t size) {
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  const ssize_t n = ::read(fd, buf, size - 1);
+  ::close(fd);
+  buf[n > 0 ? n : 0] = '\0';
+  return n;
+}
+
+// Thoi gian chay (ns) cua thread: schedstat neu kernel co CONFIG_SCHED_INFO, neu khong
+// thi utime + stime (tick) trong stat.
+quint64 threadRuntimeNs(const char *taskPath) {
+  char path[64];
+  char buf[1024];
+  std::snprintf(path, sizeof(path), "%s/schedstat", taskPath);
+  unsigned long long runtimeNs = 0;
+  if (readProcFile(path, buf, sizeof(buf)) > 0 && std::sscanf(buf, "%llu", &runtimeNs) == 1) {
+    return runtimeNs;
+  }
+  std::snprintf(path, sizeof(path), "%s/stat", taskPath);
+  if (readProcFile(path, buf, sizeof(buf)) <= 0) {
+    return 0;
+  }
+  // comm co the chua khoang trang: bat dau sau ')' cuoi, truong 14/15 la utime/stime.
+  const char *fields = std::strrchr(buf, ')');
+  unsigned long long utime = 0;
+  unsigned long long stime = 0;
+  if (!fields || std::sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                             &utime, &stime) != 2) {
+    return 0;
+  }
+  return (utime + stime) * (1000000000ULL / static_cast<quint64>(sysconf(_SC_CLK_TCK)));
+}
+}  // namespace
+
+std::array<double, SelfOverhead::kMetricCount> SelfOverhead::Budgets::defaults() {
+  std::array<double, kMetricCount> limits{};
+  for (int i = 0; i < kMetricCount; ++i) {
+    limits[i] = kMetrics[i].defaultBudget;
+  }
+  return limits;
+}
+
+SelfOverhead::Budgets::Budgets() : limits(defaults()) {}
+
+bool SelfOverhead::Budgets::parse(const QString &spec, Budgets *budgets, QString *error) {
+  Budgets parsed = *budgets;
+  for (const QString &item : spec.split(',', Qt::SkipEmptyParts)) {
+    const QStringList parts = item.split('=');
+    bool ok = parts.size() == 2;
+    const double limit = ok ? parts[1].trimmed().toDouble(&ok) : 0.0;
+    int metric = 0;
+    while (metric < kMetricCount && parts[0].trimmed() != kMetrics[metric].key) {
+      ++metric;
+    }
+    if (!ok || limit < 0.0 || metric == kMetricCount) {
+      *error = QString("Ngan sach khong hop le: '%1' (khoa: cpu, wakeups, syscalls, "
+                       "sysfs_reads, allocations, rss_kb)")
+                   .arg(item.trimmed());
+      return false;
+    }
+    parsed.limits[metric] = limit;
+  }
+  *budgets = parsed;
+  return true;
+}
+
+SelfOverhead::Budgets SelfOverhead::Budgets::fromEnvironment(QString *error) {
+  Budgets budgets;
+  const QString spec = qEnvironmentVariable("FANS_CONTROLLER_BUDGETS");
+  if (!spec.isEmpty() && !parse(spec, &budgets, error)) {
+    return Budgets();
+  }
+  return budgets;
+}
+
+bool SelfOverhead::Report::anyExceeded() const {
+  return std::any_of(values.begin(), values.end(),
+                     [](const Value &value) { return value.exceeded(); });
+}
+
+const char *SelfOverhead::metricKey(Metric metric) {
+  return kMetrics[metric].key;
+}
+
+const char *SelfOverhead::metricLabel(Metric metric) {
+  return kMetrics[metric].label;
+}
+
+const char *SelfOverhead::metricUnit(Metric metric) {
+  return kMetrics[metric].unit;
+}
+
+QString SelfOverhead::formatValue(Metric metric, double value) {
+  const MetricInfo &info = kMetrics[metric];
+  const bool attached = info.unit[0] == '%' || info.unit[0] == '/';
+  return QString::number(value, 'f', info.decimals) + (attached ? "" : " ") +
+         QString::fromLatin1(info.unit);
+}
+
+QString SelfOverhead::describe(Metric metric, const Value &value) {
+  const QString label = QString::fromLatin1(kMetrics[metric].label);
+  if (!value.available) {
+    return QString("%1 n/a").arg(label);
+  }
+  return QString("%1 %2 (budget %3)")
+      .arg(label, formatValue(metric, value.value), formatValue(metric, value.budget));
+}
+
+SelfOverhead::SelfOverhead(const Budgets &budgets, const Counters &counters)
+    : m_budgets(budgets),
+      m_footprint(ProcessFootprint::sample()),
+      m_threads(sampleThreads()),
+      m_counters(counters) {}
+
+SelfOverhead::Report SelfOverhead::sample(const Counters &counters) {
+  const ProcessFootprint footprint = ProcessFootprint::sample();
+  const QHash<int, ThreadSample> threads = sampleThreads();
+
+  Report report;
+  report.seconds = qMax<qint64>(1, footprint.monotonicMs - m_footprint.monotonicMs) / 1000.0;
+  report.refreshes = counters.refreshes - m_counters.refreshes;
+  for (int i = 0; i < kMetricCount; ++i) {
+    report.values[i].budget = m_budgets.limits[i];
+  }
+
+  auto set = [&report](Metric metric, double value, bool available) {
+    report.values[metric].value = available ? value : 0.0;
+    report.values[metric].available = available;
+  };
+  const double refreshes = static_cast<double>(report.refreshes);
+  set(Cpu, (footprint.cpuUs - m_footprint.cpuUs) / (report.seconds * 10000.0), true);
+  set(Wakeups, (footprint.voluntarySwitches - m_footprint.voluntarySwitches) / report.seconds,
+      true);
+  set(Syscalls, (counters.syscalls - m_counters.syscalls) / qMax(1.0, refreshes),
+      refreshes > 0);
+  set(SysfsReads, (counters.sysfsReads - m_counters.sysfsReads) / qMax(1.0, refreshes),
+      refreshes > 0);
+  set(Allocations, (counters.allocations - m_counters.allocations) / qMax(1.0, refreshes),
+      refreshes > 0 && countsAllocations());
+  set(Rss, static_cast<double>(footprint.rssKb), footprint.rssKb > 0);
+
+  // Thread moi xuat hien tinh tu 0; thread da thoat khong con trong bao cao (van co
+  // trong CPU tong cua tien trinh).
+  for (auto it = threads.constBegin(); it != threads.constEnd(); ++it) {
+    const ThreadSample previous = m_threads.value(it.key());
+    ThreadUsage usage;
+    usage.tid = it.key();
+    usage.name = it.value().name;
+    usage.cpuPercent =
+        (it.value().runtimeNs - qMin(previous.runtimeNs, it.value().runtimeNs)) /
+        (report.seconds * 1e7);
+    usage.wakeupsPerSecond = (it.value().voluntarySwitches -
+                              qMin(previous.voluntarySwitches, it.value().voluntarySwitches)) /
+                             report.seconds;
+    report.threads.append(usage);
+  }
+  std::sort(report.threads.begin(), report.threads.end(),
+            [](const ThreadUsage &a, const ThreadUsage &b) {
+              return a.cpuPercent != b.cpuPercent ? a.cpuPercent > b.cpuPercent : a.tid < b.tid;
+            });
+
+  m_footprint = footprint;
+  m_threads = threads;
+  m_counters = counters;
+  return report;
+}
+
+quint64 SelfOverhead::threadAllocations() {
+  return t_allocations;
+}
+
+bool SelfOverhead::countsAllocations() {
+#ifdef FANS_CONTROLLER_COUNT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+QHash<int, SelfOverhead::ThreadSample> SelfOverhead::sampleThreads() {
+  QHash<int, ThreadSample> threads;
+  DIR *dir = ::opendir(kTaskDir);
+  if (!dir) {
+    return threads;
+  }
+  while (const dirent *entry = ::readdir(dir)) {
+    const int tid = std::atoi(entry->d_name);
+    if (tid <= 0) {
+      continue;
+    }
+    char taskPath[48];
+    char path[64];
+    char buf[2048];
+    std::snprintf(taskPath, sizeof(taskPath), "%s/%d", kTaskDir, tid);
+
+    ThreadSample sample;
+    sample.runtimeNs = threadRuntimeNs(taskPath);
+    std::snprintf(path, sizeof(path), "%s/comm", taskPath);
+    if (readProcFile(path, buf, sizeof(buf)) > 0) {
+      sample.name = QString::fromLocal8Bit(buf).trimmed();
+    }
+    std::snprintf(path, sizeof(path), "%s/status", taskPath);
+    if (readProcFile(path, buf, sizeof(buf)) > 0) {
+      if (const char *line = std::strstr(buf, "\nvoluntary_ctxt_switches:")) {
+        sample.voluntarySwitches = std::strtoull(line + 25, nullptr, 10);
+      }
+    }
+    threads.insert(tid, sample);
+  }
+  ::closedir(dir);
+  return threads;
+}
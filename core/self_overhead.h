@@ -0,0 +1,107 @@
+#ifndef FANS_CONTROLLER_SELF_OVERHEAD_H
+#define FANS_CONTROLLER_SELF_OVERHEAD_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <array>
+
+#include "process_footprint.h"
+
+// Do chi phi cua chinh ung dung (chay tren laptop dung pin) va so voi ngan sach:
+//   - CPU va so lan danh thuc/giay cua ca tien trinh (ProcessFootprint), CPU tach theo
+//     thread tu /proc/self/task/*/schedstat (ns, chinh xac hon tick cua getrusage);
+//   - syscall va so lan doc sysfs moi lan refresh (SensorIoBackend::Stats);
+//   - so lan cap phat heap moi lan refresh (tuy chon build FANS_CONTROLLER_COUNT_ALLOCATIONS,
+//     mac dinh tat): malloc/calloc/realloc cua glibc duoc boc trong self_overhead.cpp va
+//     dem theo thread, SensorSampler lay hieu truoc/sau;
+//   - RSS.
+// Ngan sach mac dinh (0.1% CPU...) doi duoc bang FANS_CONTROLLER_BUDGETS hoac --budget,
+// dang "cpu=0.1,wakeups=20,rss_kb=150000".
+class SelfOverhead {
+ public:
+  enum Metric { Cpu, Wakeups, Syscalls, SysfsReads, Allocations, Rss, kMetricCount };
+
+  struct Budgets {
+    Budgets();  // Gia tri mac dinh (defaults()).
+
+    std::array<double, kMetricCount> limits;
+
+    static std::array<double, kMetricCount> defaults();
+    // Chi cac khoa (metricKey()) co trong spec bi doi.
+    static bool parse(const QString &spec, Budgets *budgets, QString *error);
+    // Mac dinh + FANS_CONTROLLER_BUDGETS (neu dat); spec sai thi giu mac dinh va bao loi.
+    static Budgets fromEnvironment(QString *error);
+  };
+
+  // Bo dem cong don tu luc khoi dong, do SensorSampler::overheadCounters() cung cap.
+  struct Counters {
+    quint64 refreshes = 0;
+    quint64 syscalls = 0;
+    quint64 sysfsReads = 0;
+    quint64 allocations = 0;
+  };
+
+  struct ThreadUsage {
+    int tid = 0;
+    QString name;
+    double cpuPercent = 0.0;  // % cua mot nhan CPU.
+    double wakeupsPerSecond = 0.0;
+  };
+
+  struct Value {
+    double value = 0.0;
+    double budget = 0.0;
+    bool available = false;  // false: khong do duoc trong khoang nay (chua refresh...).
+    bool exceeded() const { return available && value > budget; }
+  };
+
+  struct Report {
+    double seconds = 0.0;
+    quint64 refreshes = 0;
+    std::array<Value, kMetricCount> values;
+    QVector<ThreadUsage> threads;  // CPU giam dan.
+    bool anyExceeded() const;
+  };
+
+  static const char *metricKey(Metric metric);    // "cpu", dung cho JSON va --budget.
+  static const char *metricLabel(Metric metric);  // "CPU".
+  static const char *metricUnit(Metric metric);   // "%", "/s", "/refresh", "kB".
+  // "0.042%", "14.0/s", "41234 kB".
+  static QString formatValue(Metric metric, double value);
+  // "CPU 0.042% (budget 0.100%)"; chua do duoc thi "CPU n/a".
+  static QString describe(Metric metric, const Value &value);
+
+  // counters: gia tri hien tai cua bo dem, lam moc cho lan sample() dau.
+  SelfOverhead(const Budgets &budgets, const Counters &counters);
+
+  void setBudgets(const Budgets &budgets) { m_budgets = budgets; }
+  const Budgets &budgets() const { return m_budgets; }
+
+  // Khoang tu lan sample() truoc (hoac luc tao) den bay gio.
+  Report sample(const Counters &counters);
+
+  // So lan cap phat heap cua thread goi ham; luon 0 neu khong dem (build khong bat
+  // FANS_CONTROLLER_COUNT_ALLOCATIONS, khong phai glibc, hoac build voi sanitizer).
+  static quint64 threadAllocations();
+  static bool countsAllocations();
+
+ private:
+  struct ThreadSample {
+    QString name;
+    quint64 runtimeNs = 0;
+    quint64 voluntarySwitches = 0;
+  };
+
+  static QHash<int, ThreadSample> sampleThreads();
+
+  Budgets m_budgets;
+  ProcessFootprint m_footprint;
+  QHash<int, ThreadSample> m_threads;
+  Counters m_counters;
+};
+
+#endif  // FANS_CONTROLLER_SELF_OVERHEAD_H
@@ -0,0 +1,243 @@
+#include "sensor_anomaly_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+// PWM doi it hon muc nay (vd. dao dong EC) khong tinh la lenh moi can cho RPM theo kip.
+constexpr int kPwmChangePercent = 3;
+// Khong ai doc su kien (vd. --once) thi chi giu cac su kien moi nhat.
+constexpr int kMaxPendingEvents = 128;
+constexpr int kMaxLearned = 1 << 20;
+}  // namespace
+
+SensorAnomalyDetector::SensorAnomalyDetector() : SensorAnomalyDetector(Config()) {}
+
+SensorAnomalyDetector::SensorAnomalyDetector(const Config &config) : m_config(config) {}
+
+int SensorAnomalyDetector::addChannel(ChannelKind kind, const QString &label) {
+  Channel channel;
+  channel.kind = kind;
+  channel.label = label;
+  m_channels.append(channel);
+  return static_cast<int>(m_channels.size() - 1);
+}
+
+void SensorAnomalyDetector::beginSample() {
+  ++m_sample;
+  m_tempActivity += m_pendingTempActivity;
+  m_pendingTempActivity = 0.0;
+}
+
+void SensorAnomalyDetector::sampleTemperature(int channel, bool ok, double celsius) {
+  Channel &ch = m_channels[channel];
+  if (!ok || celsius < m_config.minValidC || celsius > m_config.maxValidC) {
+    if (++ch.failures >= m_config.dropoutSamples) {
+      setFault(channel, Fault::Dropout, true, celsius);
+    }
+    return;
+  }
+  ch.failures = 0;
+  setFault(channel, Fault::Dropout, false, celsius);
+
+  // Chi cong thay doi cua lan nay vao moc cua mau sau, nen chuoi dung yen cua kenh chi
+  // do duoc chuyen dong cua cac kenh khac.
+  if (ch.learned > 0) {
+    m_pendingTempActivity += std::abs(celsius - ch.lastValue);
+  }
+  trackRun(&ch, celsius, m_tempActivity);
+  const bool stuck = ch.runLength >= m_config.stuckMinSamples && ch.livelyAtRunStart &&
+                     m_tempActivity - ch.activityAtRunStart >= m_config.stuckPeerActivityC;
+  if (stuck || ch.runLength == 0) {
+    setFault(channel, Fault::Stuck, stuck, celsius);
+  }
+
+  if (ch.learned >= m_config.warmupSamples) {
+    const double deviation = std::abs(celsius - ch.mean);
+    const double limit =
+        std::max(m_config.spikeSigma * std::sqrt(ch.variance), m_config.spikeMinDeltaC);
+    if (deviation > limit) {
+      ch.lastValue = celsius;
+      if (++ch.spikes < m_config.spikeRelearnSamples) {
+        // Khong dua gia tri ngoai lai vao EWMA.
+        setFault(channel, Fault::Spike, true, celsius);
+        return;
+      }
+      // Lech lien tuc: muc nhiet moi that su (vd. tai nang keo dai), hoc lai.
+      ch.learned = 0;
+    }
+    ch.spikes = 0;
+    setFault(channel, Fault::Spike, false, celsius);
+  }
+
+  // Welford dang EWMA: cap nhat trung binh va phuong sai trong O(1).
+  if (ch.learned == 0) {
+    ch.mean = celsius;
+    ch.variance = 0.0;
+  } else {
+    const double diff = celsius - ch.mean;
+    const double increment = m_config.alpha * diff;
+    ch.mean += increment;
+    ch.variance = (1.0 - m_config.alpha) * (ch.variance + diff * increment);
+  }
+  ch.learned = std::min(ch.learned + 1, kMaxLearned);
+  ch.lastValue = celsius;
+}
+
+void SensorAnomalyDetector::sampleFan(int channel, bool rpmOk, int rpm, bool pwmOk,
+                                      int pwmPercent) {
+  Channel &ch = m_channels[channel];
+  if (!rpmOk) {
+    if (++ch.failures >= m_config.dropoutSamples) {
+      setFault(channel, Fault::Dropout, true, rpm);
+    }
+    return;
+  }
+  ch.failures = 0;
+  setFault(channel, Fault::Dropout, false, rpm);
+
+  if (pwmOk) {
+    const int delta = ch.lastPwmPercent < 0 ? 0 : std::abs(pwmPercent - ch.lastPwmPercent);
+    m_pwmActivity += delta;
+    ch.samplesSincePwmChange = (ch.lastPwmPercent < 0 || delta >= kPwmChangePercent)
+                                   ? 0
+                                   : std::min(ch.samplesSincePwmChange + 1, kMaxLearned);
+    ch.samplesAboveStall = pwmPercent >= m_config.stallPercent
+                               ? std::min(ch.samplesAboveStall + 1, kMaxLearned)
+                               : 0;
+    ch.lastPwmPercent = pwmPercent;
+  }
+  const bool settled = pwmOk && ch.samplesSincePwmChange >= m_config.fanSettleSamples;
+
+  // Tach ket: RPM khong nhuc nhich du PWM da doi va da du thoi gian de quat theo kip.
+  // RPM = 0 thi thuoc ve FanStall.
+  trackRun(&ch, rpm, m_pwmActivity);
+  const bool stuck = rpm > 0 && settled && ch.runLength >= m_config.fanSettleSamples &&
+                     m_pwmActivity - ch.activityAtRunStart >= m_config.stuckPwmActivityPercent;
+  if (stuck || ch.runLength == 0) {
+    setFault(channel, Fault::Stuck, stuck, rpm);
+  }
+  ch.lastValue = rpm;
+  ch.learned = std::min(ch.learned + 1, kMaxLearned);
+
+  if (!pwmOk) {
+    return;
+  }
+
+  const bool stalled =
+      ch.samplesAboveStall > m_config.fanSettleSamples && rpm < m_config.stallRpm;
+  ch.stallCount = stalled ? ch.stallCount + 1 : 0;
+  if (ch.stallCount >= m_config.fanFaultSamples || ch.stallCount == 0) {
+    setFault(channel, Fault::FanStall, stalled, rpm);
+  }
+
+  if (!settled || pwmPercent < m_config.stallPercent || rpm < m_config.stallRpm) {
+    return;
+  }
+  const double ratio = static_cast<double>(rpm) / pwmPercent;
+  bool mismatch = false;
+  if (ch.ratioLearned >= m_config.warmupSamples) {
+    const double relative = ratio / ch.rpmPerPercent;
+    mismatch = relative < m_config.rpmMismatchRatio || relative > 1.0 / m_config.rpmMismatchRatio;
+  }
+  if (!mismatch && !isActive(ch, Fault::FanRpmMismatch)) {
+    // Chi hoc ti le RPM/% khi quat dang khoe.
+    ch.rpmPerPercent = ch.ratioLearned == 0
+                           ? ratio
+                           : ch.rpmPerPercent + m_config.alpha * (ratio - ch.rpmPerPercent);
+    ch.ratioLearned = std::min(ch.ratioLearned + 1, kMaxLearned);
+  }
+  ch.mismatchCount = mismatch ? ch.mismatchCount + 1 : 0;
+  if (ch.mismatchCount >= m_config.fanFaultSamples || ch.mismatchCount == 0) {
+    setFault(channel, Fault::FanRpmMismatch, mismatch, rpm);
+  }
+}
+
+QVector<SensorAnomalyDetector::Event> SensorAnomalyDetector::takeEvents() {
+  QVector<Event> events;
+  events.swap(m_events);
+  return events;
+}
+
+QVector<SensorAnomalyDetector::Event> SensorAnomalyDetector::activeFaults() const {
+  QVector<Event> faults;
+  for (qsizetype i = 0; i < m_channels.size(); ++i) {
+    const Channel &ch = m_channels[i];
+    for (const Fault fault : {Fault::Dropout, Fault::Stuck, Fault::Spike, Fault::FanStall,
+                              Fault::FanRpmMismatch}) {
+      if (isActive(ch, fault)) {
+        faults.append(
+            {fault, static_cast<int>(i), ch.kind, ch.label, true, ch.lastValue, m_sample});
+      }
+    }
+  }
+  return faults;
+}
+
+const char *SensorAnomalyDetector::faultName(Fault fault) {
+  switch (fault) {
+    case Fault::Dropout:
+      return "dropout";
+    case Fault::Stuck:
+      return "stuck";
+    case Fault::Spike:
+      return "spike";
+    case Fault::FanStall:
+      return "fan_stall";
+    case Fault::FanRpmMismatch:
+      return "fan_rpm_mismatch";
+  }
+  return "unknown";
+}
+
+QString SensorAnomalyDetector::describe(const Event &event) {
+  const QString value = event.kind == ChannelKind::Fan
+                            ? QString("%1 RPM").arg(qRound(event.value))
+                            : QString("%1 C").arg(event.value, 0, 'f', 1);
+  QString what;
+  switch (event.fault) {
+    case Fault::Dropout:
+      what = "read failures";
+      break;
+    case Fault::Stuck:
+      what = QString("value stuck at %1").arg(value);
+      break;
+    case Fault::Spike:
+      what = QString("implausible jump to %1").arg(value);
+      break;
+    case Fault::FanStall:
+      what = QString("fan stalled (%1 despite PWM)").arg(value);
+      break;
+    case Fault::FanRpmMismatch:
+      what = QString("%1 inconsistent with PWM").arg(value);
+      break;
+  }
+  return event.label + ": " + what + (event.active ? "" : " (recovered)");
+}
+
+bool SensorAnomalyDetector::isActive(const Channel &channel, Fault fault) const {
+  return channel.activeMask & (1u << static_cast<int>(fault));
+}
+
+void SensorAnomalyDetector::setFault(int index, Fault fault, bool active, double value) {
+  Channel &ch = m_channels[index];
+  if (isActive(ch, fault) == active) {
+    return;
+  }
+  ch.activeMask ^= 1u << static_cast<int>(fault);
+  if (m_events.size() >= kMaxPendingEvents) {
+    m_events.removeFirst();
+  }
+  m_events.append({fault, index, ch.kind, ch.label, active, value, m_sample});
+}
+
+void SensorAnomalyDetector::trackRun(Channel *channel, double value, double activity) {
+  if (channel->learned > 0 && value == channel->lastValue) {
+    channel->runLength = std::min(channel->runLength + 1, kMaxLearned);
+  } else {
+    channel->runLength = 0;
+    channel->activityAtRunStart = activity;
+    channel->livelyAtRunStart = std::sqrt(channel->variance) >= m_config.stuckMinSigmaC;
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef FANS_CONTROLLER_SENSOR_ANOMALY_DETECTOR_H
+#define FANS_CONTROLLER_SENSOR_ANOMALY_DETECTOR_H
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Phat hien loi sensor/quat theo dong mau, O(1) moi mau moi kenh (khong giu lich su):
+//   - Dropout: doc that bai (hoac ngoai dai vat ly) lien tiep dropoutSamples mau.
+//   - Spike: lech khoi trung binh EWMA qua spikeSigma do lech chuan (EWMA phuong sai).
+//   - Stuck: nhiet do von dao dong (do lech chuan EWMA >= stuckMinSigmaC) bong dung yen
+//     tuyet doi trong khi cac kenh khac da di chuyen tong cong stuckPeerActivityC; RPM
+//     dung yen trong khi PWM da doi stuckPwmActivityPercent.
+//   - FanStall: PWM du de quat quay nhung RPM gan 0.
+//   - FanRpmMismatch: RPM lech khoi ti le RPM/% hoc duoc luc quat khoe.
+// Moi loi chi phat mot Event khi bat va mot Event khi het (active = false).
+class SensorAnomalyDetector {
+ public:
+  enum class Fault { Dropout, Stuck, Spike, FanStall, FanRpmMismatch };
+  enum class ChannelKind { Temperature, Fan };
+
+  struct Config {
+    double alpha = 0.2;               // He so EWMA cho trung binh/phuong sai.
+    int warmupSamples = 5;            // So mau hoc truoc khi xet spike/lech RPM.
+    double spikeSigma = 6.0;
+    double spikeMinDeltaC = 12.0;     // Lech toi thieu, tranh bao dong khi phuong sai ~0.
+    int spikeRelearnSamples = 3;      // Spike lien tiep = muc moi that, hoc lai tu dau.
+    int dropoutSamples = 2;
+    double minValidC = -20.0;
+    double maxValidC = 150.0;
+    int stuckMinSamples = 5;
+    double stuckPeerActivityC = 15.0;
+    double stuckMinSigmaC = 1.0;      // Kenh von it dao dong (vd. PCH) thi dung yen la binh thuong.
+    double stuckPwmActivityPercent = 15.0;
+    int stallPercent = 30;            // PWM tu muc nay quat khoe chac chan phai quay.
+    int stallRpm = 300;
+    int fanSettleSamples = 2;         // Cho RPM theo kip sau khi PWM doi.
+    int fanFaultSamples = 2;
+    double rpmMismatchRatio = 0.5;    // Ngoai [ratio, 1/ratio] lan RPM ky vong.
+  };
+
+  struct Event {
+    Fault fault;
+    int channel;
+    ChannelKind kind;
+    QString label;
+    bool active;     // true = loi moi bat, false = da het.
+    double value;    // Gia tri mau gay ra su kien (do C hoac RPM).
+    quint64 sample;  // So thu tu mau (beginSample()).
+  };
+
+  SensorAnomalyDetector();
+  explicit SensorAnomalyDetector(const Config &config);
+
+  // Dang ky kenh mot lan, tra ve chi so dung cho sample*().
+  int addChannel(ChannelKind kind, const QString &label);
+
+  // Goi mot lan truoc khi dua cac kenh cua mot lan refresh.
+  void beginSample();
+  void sampleTemperature(int channel, bool ok, double celsius);
+  void sampleFan(int channel, bool rpmOk, int rpm, bool pwmOk, int pwmPercent);
+
+  // Lay va xoa cac su kien bat/het loi tu lan goi truoc.
+  QVector<Event> takeEvents();
+  // Cac loi dang bat, theo thu tu kenh.
+  QVector<Event> activeFaults() const;
+
+  static const char *faultName(Fault fault);
+  static QString describe(const Event &event);
+
+ private:
+  struct Channel {
+    ChannelKind kind;
+    QString label;
+    quint32 activeMask = 0;   // Bit theo Fault.
+    double lastValue = 0.0;   // Gia tri cua lan doc thanh cong gan nhat (C hoac RPM).
+    int failures = 0;
+    // EWMA (nhiet do).
+    int learned = 0;
+    double mean = 0.0;
+    double variance = 0.0;
+    int spikes = 0;
+    // Stuck: do dai chuoi gia tri khong doi va moc hoat dong luc bat dau chuoi.
+    int runLength = 0;
+    double activityAtRunStart = 0.0;
+    bool livelyAtRunStart = false;  // Do lech chuan EWMA luc bat dau chuoi du lon.
+    // Quat.
+    int lastPwmPercent = -1;
+    int samplesSincePwmChange = 0;
+    int samplesAboveStall = 0;
+    int stallCount = 0;
+    int mismatchCount = 0;
+    int ratioLearned = 0;
+    double rpmPerPercent = 0.0;
+  };
+
+  bool isActive(const Channel &channel, Fault fault) const;
+  void setFault(int index, Fault fault, bool active, double value);
+  void trackRun(Channel *channel, double value, double activity);
+
+  Config m_config;
+  QVector<Channel> m_channels;
+  QVector<Event> m_events;
+  quint64 m_sample = 0;
+  // Tong |thay doi| cua moi kenh nhiet do / PWM tu dau; hieu hai moc = muc di chuyen.
+  double m_tempActivity = 0.0;
+  double m_pendingTempActivity = 0.0;
+  double m_pwmActivity = 0.0;
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_ANOMALY_DETECTOR_H
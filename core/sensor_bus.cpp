@@ -0,0 +1,169 @@
+#include "sensor_bus.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr double kUnset = std::numeric_limits<double>::quiet_NaN();
+}  // namespace
+
+int SensorBus::subscribe(const QString &name, const Filter &filter, Callback callback) {
+  QMutexLocker lock(&m_mutex);
+  Subscriber subscriber;
+  subscriber.id = m_nextId++;
+  subscriber.name = name;
+  subscriber.filter = filter;
+  subscriber.filter.ewmaAlpha = std::clamp(filter.ewmaAlpha, 0.01, 1.0);
+  subscriber.callback = std::move(callback);
+  subscriber.stats.name = name;
+  resetSubscriber(&subscriber);
+  m_subscribers.push_back(std::move(subscriber));
+  return m_subscribers.back().id;
+}
+
+void SensorBus::unsubscribe(int id) {
+  QMutexLocker lock(&m_mutex);
+  m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(),
+                                     [id](const Subscriber &s) { return s.id == id; }),
+                      m_subscribers.end());
+}
+
+void SensorBus::setChannels(const QStringList &labels, const QVector<ChannelKind> &kinds) {
+  QMutexLocker lock(&m_mutex);
+  if (labels == m_labels && kinds == m_kinds) {
+    return;
+  }
+  m_labels = labels;
+  m_kinds = kinds;
+  m_kinds.resize(m_labels.size());
+  for (Subscriber &subscriber : m_subscribers) {
+    resetSubscriber(&subscriber);
+  }
+}
+
+QStringList SensorBus::channels() const {
+  QMutexLocker lock(&m_mutex);
+  return m_labels;
+}
+
+// Dung lai deadband theo kenh tu Filter; gia tri da bao ve NaN de mau ke tiep bao het.
+void SensorBus::resetSubscriber(Subscriber *subscriber) const {
+  const size_t count = static_cast<size_t>(m_labels.size());
+  subscriber->deadband.assign(count, kUnset);
+  for (size_t i = 0; i < count; ++i) {
+    const Filter &filter = subscriber->filter;
+    if (!filter.channels.isEmpty() && !filter.channels.contains(m_labels[i])) {
+      continue;
+    }
+    subscriber->deadband[i] = m_kinds[i] == ChannelKind::FanRpm
+                                  ? std::max(0.0, filter.fanDeadbandRpm)
+                                  : std::max(0.0, filter.temperatureDeadbandC);
+  }
+  subscriber->smoothed.assign(count, kUnset);
+  subscriber->sent.assign(count, kUnset);
+  subscriber->changed.assign(count, 0);
+}
+
+void SensorBus::publish(const QVector<double> &values) {
+  std::vector<std::pair<Callback, Update>> pending;
+  {
+    QMutexLocker lock(&m_mutex);
+    if (values.size() != m_labels.size()) {
+      return;
+    }
+    ++m_sequence;
+    const int count = static_cast<int>(values.size());
+    for (Subscriber &subscriber : m_subscribers) {
+      ++subscriber.stats.samples;
+      const double *input = values.constData();
+      const double alpha = subscriber.filter.ewmaAlpha;
+      if (alpha < 1.0) {
+        // Mau loi (NaN) di thang qua de consumer biet ngay; mau dau sau loi bat dau lai.
+        for (int i = 0; i < count; ++i) {
+          const double previous = subscriber.smoothed[i];
+          subscriber.smoothed[i] = std::isnan(previous) || std::isnan(input[i])
+                                       ? input[i]
+                                       : previous + alpha * (input[i] - previous);
+        }
+        input = subscriber.smoothed.data();
+      }
+
+      const int changes = changedChannels(input, subscriber.sent.data(),
+                                          subscriber.deadband.data(), count,
+                                          subscriber.changed.data());
+      if (changes == 0) {
+        continue;
+      }
+      Update update;
+      update.sequence = m_sequence;
+      update.labels = m_labels;
+      update.changed.reserve(changes);
+      for (int k = 0; k < changes; ++k) {
+        const int i = subscriber.changed[k];
+        subscriber.sent[i] = input[i];
+        update.changed.append(i);
+      }
+      update.values = QVector<double>(subscriber.sent.begin(), subscriber.sent.end());
+      ++subscriber.stats.notifications;
+      pending.emplace_back(subscriber.callback, std::move(update));
+    }
+  }
+  // Goi ngoai khoa: callback co the subscribe/unsubscribe hoac doc stats().
+  for (const auto &[callback, update] : pending) {
+    callback(update);
+  }
+}
+
+QVector<SensorBus::SubscriberStats> SensorBus::stats() const {
+  QMutexLocker lock(&m_mutex);
+  QVector<SubscriberStats> result;
+  result.reserve(static_cast<qsizetype>(m_subscribers.size()));
+  for (const Subscriber &subscriber : m_subscribers) {
+    result.append(subscriber.stats);
+  }
+  return result;
+}
+
+int SensorBus::changedChannels(const double *values, const double *sent, const double *deadband,
+                               int count, int *changed) {
+  int changes = 0;
+  int i = 0;
+#if defined(__SSE2__)
+  // Hai kenh moi lan: |v - s| > deadband (so sanh co thu tu, NaN -> false), hoac dung
+  // mot trong hai la NaN (xor cua cmpunord); deadband NaN (kenh khong theo doi) tat ca.
+  const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+  for (; i + 2 <= count; i += 2) {
+    const __m128d v = _mm_loadu_pd(values + i);
+    const __m128d s = _mm_loadu_pd(sent + i);
+    const __m128d band = _mm_loadu_pd(deadband + i);
+    const __m128d moved = _mm_cmpgt_pd(_mm_and_pd(_mm_sub_pd(v, s), absMask), band);
+    const __m128d flipped = _mm_xor_pd(_mm_cmpunord_pd(v, v), _mm_cmpunord_pd(s, s));
+    const __m128d watched = _mm_cmpord_pd(band, band);
+    const int mask = _mm_movemask_pd(_mm_and_pd(_mm_or_pd(moved, flipped), watched));
+    if (mask & 1) {
+      changed[changes++] = i;
+    }
+    if (mask & 2) {
+      changed[changes++] = i + 1;
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    if (std::isnan(deadband[i])) {
+      continue;
+    }
+    if (std::isnan(values[i]) != std::isnan(sent[i]) ||
+        std::abs(values[i] - sent[i]) > deadband[i]) {
+      changed[changes++] = i;
+    }
+  }
+  return changes;
+}
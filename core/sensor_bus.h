@@ -0,0 +1,88 @@
+#ifndef FANS_CONTROLLER_SENSOR_BUS_H
+#define FANS_CONTROLLER_SENSOR_BUS_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <functional>
+#include <vector>
+
+// Bus publish/subscribe chi bao khi thay doi: moi lan lay mau SensorSampler publish mot
+// mang gia tri (cung thu tu kenh voi SensorHistory), moi consumer (the UI, bieu do,
+// logger, bo dieu khien...) dang ky voi deadband rieng cho nhiet do/RPM va EWMA tuy chon,
+// va chi duoc goi khi co kenh lech qua deadband so voi gia tri da bao lan truoc (hoac
+// doi giua hop le/loi). Kenh duoc chon bang nhan mot lan luc setChannels(), nen moi mau
+// chi ton mot phep so sanh SIMD tren mang double cho moi consumer, khong tra cuu chuoi.
+// Thread-safe: sampler publish, GUI subscribe/unsubscribe; callback chay tren thread
+// publish (tu chuyen ve thread cua minh neu can) va ngoai khoa cua bus.
+class SensorBus {
+ public:
+  enum class ChannelKind { Temperature, FanRpm };
+
+  struct Filter {
+    double temperatureDeadbandC = 0.5;
+    double fanDeadbandRpm = 50.0;
+    double ewmaAlpha = 1.0;  // (0, 1]: trong so mau moi; 1 = khong lam muot.
+    QStringList channels;    // Rong = moi kenh; nhan khong ton tai bi bo qua.
+  };
+
+  struct Update {
+    quint64 sequence = 0;    // So thu tu mau da publish.
+    QStringList labels;      // Thu tu kenh hien tai.
+    QVector<double> values;  // Gia tri da bao (da lam muot) cua moi kenh, NaN = loi/chua co.
+    QVector<int> changed;    // Chi so kenh vua vuot deadband trong lan nay.
+  };
+
+  using Callback = std::function<void(const Update &)>;
+
+  struct SubscriberStats {
+    QString name;
+    quint64 samples = 0;        // So mau da so sanh.
+    quint64 notifications = 0;  // So lan callback duoc goi.
+  };
+
+  // Tra ve id dung cho unsubscribe(). Consumer moi nhan tat ca kenh hop le o mau ke tiep.
+  int subscribe(const QString &name, const Filter &filter, Callback callback);
+  void unsubscribe(int id);
+
+  // Doi danh sach kenh thi moi consumer bat dau lai (bao lai moi kenh o mau ke tiep).
+  void setChannels(const QStringList &labels, const QVector<ChannelKind> &kinds);
+  QStringList channels() const;
+
+  // values theo thu tu setChannels() (NaN = doc loi); so gia tri khong khop thi bo qua.
+  void publish(const QVector<double> &values);
+
+  QVector<SubscriberStats> stats() const;
+
+  // Ghi vao changed chi so cac kenh co |values - sent| > deadband hoac doi giua NaN va
+  // so (SSE2 neu co); kenh co deadband NaN bi bo qua. Tra ve so kenh da ghi.
+  static int changedChannels(const double *values, const double *sent, const double *deadband,
+                             int count, int *changed);
+
+ private:
+  struct Subscriber {
+    int id = 0;
+    QString name;
+    Filter filter;
+    Callback callback;
+    std::vector<double> deadband;  // Theo kenh; NaN = khong theo doi kenh nay.
+    std::vector<double> smoothed;  // EWMA, NaN = chua co mau hop le.
+    std::vector<double> sent;      // Gia tri da bao lan cuoi.
+    std::vector<int> changed;      // Bo dem tam cho changedChannels().
+    SubscriberStats stats;
+  };
+
+  void resetSubscriber(Subscriber *subscriber) const;
+
+  mutable QMutex m_mutex;
+  QStringList m_labels;
+  QVector<ChannelKind> m_kinds;
+  std::vector<Subscriber> m_subscribers;
+  int m_nextId = 1;
+  quint64 m_sequence = 0;
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_BUS_H
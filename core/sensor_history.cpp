@@ -0,0 +1,426 @@
+#include "sensor_history.h"
+
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+// Gorilla gioi han leading zero trong 5 bit.
+constexpr int kMaxLeadingZeros = 31;
+
+quint64 toBits(double value) {
+  quint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double fromBits(quint64 bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Doc bit MSB-first; moi lan doc toi da 64 bit tu hai word lien tiep.
+class BitReader {
+ public:
+  explicit BitReader(const std::vector<quint64> &words) : m_words(words.data()) {}
+
+  quint64 read(int bits) {
+    const quint32 index = m_position / 64;
+    const int offset = static_cast<int>(m_position % 64);
+    m_position += static_cast<quint32>(bits);
+    quint64 value = m_words[index] << offset;
+    if (offset + bits > 64) {
+      value |= m_words[index + 1] >> (64 - offset);
+    }
+    return bits == 64 ? value : value >> (64 - bits);
+  }
+
+  bool readBit() { return read(1) != 0; }
+
+ private:
+  const quint64 *m_words;
+  quint32 m_position = 0;
+};
+
+// Delta-of-delta theo bang cua Gorilla (ms thay vi s): '0' | '10'+7 | '110'+9 | '1110'+12
+// | '1111'+64. Chu ky 1 s cua SensorSampler tinh theo moc tuyet doi nen phan lon la '0'.
+struct DodBucket {
+  quint64 prefix;
+  int prefixBits;
+  int valueBits;
+  qint64 bias;
+};
+const DodBucket kDodBuckets[] = {{0b10, 2, 7, 63}, {0b110, 3, 9, 255}, {0b1110, 4, 12, 2047}};
+
+qint64 readDeltaOfDelta(BitReader *reader) {
+  int ones = 0;
+  while (ones < 4 && reader->readBit()) {
+    ++ones;
+  }
+  if (ones == 0) {
+    return 0;
+  }
+  if (ones == 4) {
+    return static_cast<qint64>(reader->read(64));
+  }
+  const DodBucket &bucket = kDodBuckets[ones - 1];
+  return static_cast<qint64>(reader->read(bucket.valueBits)) - bucket.bias;
+}
+}  // namespace
+
+void SensorHistory::BitStream::write(quint64 value, int bits) {
+  if (bits < 64) {
+    value &= (quint64(1) << bits) - 1;
+  }
+  const int used = static_cast<int>(bitCount % 64);
+  if (used == 0) {
+    words.push_back(0);
+  }
+  const int available = 64 - used;
+  if (bits <= available) {
+    words.back() |= value << (available - bits);
+  } else {
+    words.back() |= value >> (bits - available);
+    words.push_back(value << (64 - (bits - available)));
+  }
+  bitCount += static_cast<quint32>(bits);
+}
+
+SensorHistory::SensorHistory(qint64 retentionMs) : m_retentionMs(retentionMs) {}
+
+void SensorHistory::setChannels(const QStringList &labels) {
+  QMutexLocker lock(&m_mutex);
+  if (labels == m_labels) {
+    return;
+  }
+  m_labels = labels;
+  m_chunks.clear();
+  m_headStates.clear();
+  m_headOpen = false;
+}
+
+QStringList SensorHistory::channels() const {
+  QMutexLocker lock(&m_mutex);
+  return m_labels;
+}
+
+bool SensorHistory::append(qint64 timestampMs, const QVector<double> &values) {
+  QMutexLocker lock(&m_mutex);
+  if (values.isEmpty() || values.size() != m_labels.size()) {
+    return false;
+  }
+  if (!m_chunks.empty() && timestampMs < m_chunks.back().lastMs) {
+    return false;
+  }
+
+  if (!m_headOpen) {
+    openChunk(timestampMs);
+  }
+  Chunk &head = m_chunks.back();
+  const bool first = head.count == 0;
+  if (!first) {
+    const qint64 delta = timestampMs - head.lastMs;
+    const qint64 dod = delta - m_headPreviousDelta;
+    m_headPreviousDelta = delta;
+    if (dod == 0) {
+      head.times.write(0, 1);
+    } else {
+      bool written = false;
+      for (const DodBucket &bucket : kDodBuckets) {
+        if (dod >= -bucket.bias && dod <= bucket.bias + 1) {
+          head.times.write(bucket.prefix, bucket.prefixBits);
+          head.times.write(static_cast<quint64>(dod + bucket.bias), bucket.valueBits);
+          written = true;
+          break;
+        }
+      }
+      if (!written) {
+        head.times.write(0b1111, 4);
+        head.times.write(static_cast<quint64>(dod), 64);
+      }
+    }
+  }
+
+  for (qsizetype c = 0; c < values.size(); ++c) {
+    const double value = values[c];
+    encodeValue(&head.values[c], &m_headStates[c], value, first);
+    if (!std::isnan(value)) {
+      head.minimum[c] = std::min(head.minimum[c], value);
+      head.maximum[c] = std::max(head.maximum[c], value);
+    }
+  }
+  head.lastMs = timestampMs;
+  if (++head.count == kSamplesPerChunk) {
+    sealHead();
+  }
+  dropExpired();
+  return true;
+}
+
+void SensorHistory::openChunk(qint64 timestampMs) {
+  Chunk chunk;
+  chunk.firstMs = timestampMs;
+  chunk.lastMs = timestampMs;
+  const size_t channels = static_cast<size_t>(m_labels.size());
+  chunk.values.resize(channels);
+  chunk.minimum.assign(channels, kInfinity);
+  chunk.maximum.assign(channels, -kInfinity);
+  m_chunks.push_back(std::move(chunk));
+  m_headStates.assign(channels, ValueState());
+  m_headPreviousDelta = 0;
+  m_headOpen = true;
+}
+
+void SensorHistory::sealHead() {
+  // Chunk da dong khong con ghi them: tra phan capacity du cua vector.
+  Chunk &head = m_chunks.back();
+  head.times.words.shrink_to_fit();
+  for (BitStream &stream : head.values) {
+    stream.words.shrink_to_fit();
+  }
+  m_headOpen = false;
+}
+
+void SensorHistory::dropExpired() {
+  const qint64 oldestKept = m_chunks.back().lastMs - m_retentionMs;
+  while (m_chunks.size() > 1 && m_chunks.front().lastMs < oldestKept) {
+    m_chunks.pop_front();
+  }
+}
+
+void SensorHistory::encodeValue(BitStream *stream, ValueState *state, double value, bool first) {
+  const quint64 bits = toBits(value);
+  if (first) {
+    stream->write(bits, 64);
+    *state = ValueState();
+    state->previousBits = bits;
+    return;
+  }
+  const quint64 delta = bits ^ state->previousBits;
+  state->previousBits = bits;
+  if (delta == 0) {
+    stream->write(0, 1);
+    return;
+  }
+  const int leading = std::min(kMaxLeadingZeros, static_cast<int>(qCountLeadingZeroBits(delta)));
+  const int trailing = static_cast<int>(qCountTrailingZeroBits(delta));
+  if (state->leading >= 0 && leading >= state->leading && trailing >= state->trailing) {
+    // Bit co nghia nam trong cua so cua gia tri truoc: '10' + cac bit trong cua so.
+    stream->write(0b10, 2);
+    stream->write(delta >> state->trailing, 64 - state->leading - state->trailing);
+    return;
+  }
+  // '11' + leading (5 bit) + so bit co nghia (6 bit, 64 ghi thanh 0) + cac bit do.
+  const int meaningful = 64 - leading - trailing;
+  stream->write(0b11, 2);
+  stream->write(static_cast<quint64>(leading), 5);
+  stream->write(static_cast<quint64>(meaningful & 63), 6);
+  stream->write(delta >> trailing, meaningful);
+  state->leading = leading;
+  state->trailing = trailing;
+}
+
+void SensorHistory::decodeTimes(const Chunk &chunk, qint64 *out) {
+  BitReader reader(chunk.times.words);
+  qint64 timestamp = chunk.firstMs;
+  qint64 delta = 0;
+  out[0] = timestamp;
+  for (int i = 1; i < chunk.count; ++i) {
+    delta += readDeltaOfDelta(&reader);
+    timestamp += delta;
+    out[i] = timestamp;
+  }
+}
+
+void SensorHistory::decodeValues(const BitStream &stream, int count, double *out) {
+  BitReader reader(stream.words);
+  quint64 bits = reader.read(64);
+  out[0] = fromBits(bits);
+  int leading = 0;
+  int trailing = 0;
+  for (int i = 1; i < count; ++i) {
+    if (reader.readBit()) {
+      if (reader.readBit()) {
+        leading = static_cast<int>(reader.read(5));
+        int meaningful = static_cast<int>(reader.read(6));
+        if (meaningful == 0) {
+          meaningful = 64;
+        }
+        trailing = 64 - leading - meaningful;
+      }
+      bits ^= reader.read(64 - leading - trailing) << trailing;
+    }
+    out[i] = fromBits(bits);
+  }
+}
+
+QVector<SensorHistory::Bucket> SensorHistory::aggregate(int channel, qint64 fromMs, qint64 toMs,
+                                                        int buckets) const {
+  QMutexLocker lock(&m_mutex);
+  if (buckets <= 0 || toMs <= fromMs || channel < 0 || channel >= m_labels.size()) {
+    return {};
+  }
+  QVector<Bucket> result(buckets, Bucket{kInfinity, -kInfinity, 0});
+  const double width = static_cast<double>(toMs - fromMs) / buckets;
+  const auto bucketOf = [&](qint64 timestampMs) {
+    return std::min(buckets - 1, static_cast<int>((timestampMs - fromMs) / width));
+  };
+  const auto merge = [&result](int index, double minimum, double maximum, int count) {
+    Bucket &bucket = result[index];
+    bucket.minimum = std::fmin(bucket.minimum, minimum);
+    bucket.maximum = std::fmax(bucket.maximum, maximum);
+    bucket.count += count;
+  };
+
+  std::array<qint64, kSamplesPerChunk> times;
+  std::array<double, kSamplesPerChunk> values;
+  for (const Chunk &chunk : m_chunks) {
+    if (chunk.count == 0 || chunk.lastMs < fromMs || chunk.firstMs >= toMs) {
+      continue;
+    }
+    // Ca chunk nam gon trong mot bucket: dung min/max luu san, khong giai nen.
+    if (chunk.firstMs >= fromMs && chunk.lastMs < toMs &&
+        bucketOf(chunk.firstMs) == bucketOf(chunk.lastMs)) {
+      merge(bucketOf(chunk.firstMs), chunk.minimum[channel], chunk.maximum[channel],
+            chunk.count);
+      continue;
+    }
+
+    decodeTimes(chunk, times.data());
+    decodeValues(chunk.values[channel], chunk.count, values.data());
+    int begin = 0;
+    while (begin < chunk.count && times[begin] < fromMs) {
+      ++begin;
+    }
+    while (begin < chunk.count && times[begin] < toMs) {
+      // Gom day mau lien tiep cung bucket roi tinh min/max mot lan.
+      const int index = bucketOf(times[begin]);
+      int end = begin + 1;
+      while (end < chunk.count && times[end] < toMs && bucketOf(times[end]) == index) {
+        ++end;
+      }
+      double minimum;
+      double maximum;
+      minMax(values.data() + begin, end - begin, &minimum, &maximum);
+      merge(index, minimum, maximum, end - begin);
+      begin = end;
+    }
+  }
+
+  for (Bucket &bucket : result) {
+    if (bucket.minimum > bucket.maximum) {
+      bucket.minimum = kNaN;
+      bucket.maximum = kNaN;
+    }
+  }
+  return result;
+}
+
+void SensorHistory::samples(int channel, qint64 fromMs, qint64 toMs,
+                            QVector<qint64> *timestampsMs, QVector<double> *values) const {
+  QMutexLocker lock(&m_mutex);
+  timestampsMs->clear();
+  values->clear();
+  if (channel < 0 || channel >= m_labels.size()) {
+    return;
+  }
+  std::array<qint64, kSamplesPerChunk> times;
+  std::array<double, kSamplesPerChunk> decoded;
+  for (const Chunk &chunk : m_chunks) {
+    if (chunk.count == 0 || chunk.lastMs < fromMs || chunk.firstMs >= toMs) {
+      continue;
+    }
+    decodeTimes(chunk, times.data());
+    decodeValues(chunk.values[channel], chunk.count, decoded.data());
+    for (int i = 0; i < chunk.count; ++i) {
+      if (times[i] >= fromMs && times[i] < toMs) {
+        timestampsMs->append(times[i]);
+        values->append(decoded[i]);
+      }
+    }
+  }
+}
+
+qint64 SensorHistory::firstTimestampMs() const {
+  QMutexLocker lock(&m_mutex);
+  return m_chunks.empty() ? 0 : m_chunks.front().firstMs;
+}
+
+qint64 SensorHistory::lastTimestampMs() const {
+  QMutexLocker lock(&m_mutex);
+  return m_chunks.empty() ? 0 : m_chunks.back().lastMs;
+}
+
+SensorHistory::Stats SensorHistory::stats() const {
+  QMutexLocker lock(&m_mutex);
+  Stats stats;
+  stats.channels = static_cast<int>(m_labels.size());
+  stats.chunks = static_cast<int>(m_chunks.size());
+  for (const Chunk &chunk : m_chunks) {
+    stats.samples += static_cast<quint64>(chunk.count);
+    quint64 bytes = sizeof(Chunk) + chunk.times.words.capacity() * sizeof(quint64) +
+                    (chunk.minimum.capacity() + chunk.maximum.capacity()) * sizeof(double);
+    for (const BitStream &stream : chunk.values) {
+      bytes += sizeof(BitStream) + stream.words.capacity() * sizeof(quint64);
+    }
+    stats.encodedBytes += bytes;
+  }
+  const quint64 values = stats.samples * static_cast<quint64>(stats.channels);
+  stats.bytesPerValue = values > 0 ? static_cast<double>(stats.encodedBytes) / values : 0.0;
+  return stats;
+}
+
+void SensorHistory::minMax(const double *values, int count, double *minimum, double *maximum) {
+  double low = kInfinity;
+  double high = -kInfinity;
+  int i = 0;
+#if defined(__SSE2__)
+  // MINPD/MAXPD tra ve toan hang thu hai khi co NaN: gia tri moi dat truoc, bo tich luy
+  // dat sau nen mau loi (NaN) tu dong bi bo qua. Hai bo tich luy de giau do tre lenh.
+  __m128d low0 = _mm_set1_pd(kInfinity);
+  __m128d low1 = low0;
+  __m128d high0 = _mm_set1_pd(-kInfinity);
+  __m128d high1 = high0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128d a = _mm_loadu_pd(values + i);
+    const __m128d b = _mm_loadu_pd(values + i + 2);
+    low0 = _mm_min_pd(a, low0);
+    low1 = _mm_min_pd(b, low1);
+    high0 = _mm_max_pd(a, high0);
+    high1 = _mm_max_pd(b, high1);
+  }
+  double lows[2];
+  double highs[2];
+  _mm_storeu_pd(lows, _mm_min_pd(low0, low1));
+  _mm_storeu_pd(highs, _mm_max_pd(high0, high1));
+  low = std::min(lows[0], lows[1]);
+  high = std::max(highs[0], highs[1]);
+#endif
+  for (; i < count; ++i) {
+    // So sanh voi NaN luon false nen NaN bi bo qua.
+    if (values[i] < low) {
+      low = values[i];
+    }
+    if (values[i] > high) {
+      high = values[i];
+    }
+  }
+  if (low > high) {
+    low = kNaN;
+    high = kNaN;
+  }
+  *minimum = low;
+  *maximum = high;
+}
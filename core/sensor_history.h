@@ -0,0 +1,112 @@
+#ifndef FANS_CONTROLLER_SENSOR_HISTORY_H
+#define FANS_CONTROLLER_SENSOR_HISTORY_H
+
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <deque>
+#include <vector>
+
+// Lich su sensor nen trong RAM kieu Gorilla (Facebook TSDB) de giu 24 gio mau 1 Hz cho
+// moi kenh ma chi ton vai bit/mau:
+//   - moi lan lay mau co mot timestamp chung cho moi kenh, ma hoa delta-of-delta (chu ky
+//     1 s deu nen phan lon chi ton 1 bit, va chia deu cho tat ca kenh);
+//   - gia tri double ma hoa XOR voi gia tri truoc (nhiet do sysfs it doi -> 1 bit,
+//     doi nho -> vai bit trong cua so leading/trailing zero);
+//   - chia thanh chunk co dinh kSamplesPerChunk mau; chunk da dong luu san min/max tung
+//     kenh nen zoom ra ca ngay khong can giai nen, chunk bi cat boi bucket thi giai nen
+//     tuan tu roi gop min/max bang SIMD.
+// Nhan kenh luu mot lan (khong luu QString moi mau). Thread-safe: sampler ghi, GUI doc.
+class SensorHistory {
+ public:
+  static constexpr int kSamplesPerChunk = 256;
+  static constexpr qint64 kDefaultRetentionMs = 24LL * 60 * 60 * 1000;
+
+  // Mot diem tren bieu do da gop: min/max cua cac mau hop le trong bucket (NaN neu
+  // bucket khong co mau hop le), count = so lan lay mau roi vao bucket.
+  struct Bucket {
+    double minimum;
+    double maximum;
+    int count;
+  };
+
+  struct Stats {
+    int channels = 0;
+    int chunks = 0;
+    quint64 samples = 0;       // So lan lay mau con giu (moi lan gom moi kenh).
+    quint64 encodedBytes = 0;  // Bit da ma hoa + header chunk + min/max chunk.
+    double bytesPerValue = 0.0;
+  };
+
+  explicit SensorHistory(qint64 retentionMs = kDefaultRetentionMs);
+
+  // Dat danh sach kenh; doi danh sach (so luong hoac nhan) thi xoa lich su cu.
+  void setChannels(const QStringList &labels);
+  QStringList channels() const;
+
+  // Them mot lan lay mau; values theo thu tu setChannels() (NaN = doc loi). Tra ve false
+  // neu so gia tri khong khop hoac timestamp lui so voi mau truoc.
+  bool append(qint64 timestampMs, const QVector<double> &values);
+
+  // Gop kenh channel trong [fromMs, toMs) thanh buckets diem deu nhau (vd. moi pixel
+  // cua bieu do mot bucket).
+  QVector<Bucket> aggregate(int channel, qint64 fromMs, qint64 toMs, int buckets) const;
+
+  // Giai nen tung mau cua kenh trong [fromMs, toMs) (khi zoom vao vai phut).
+  void samples(int channel, qint64 fromMs, qint64 toMs, QVector<qint64> *timestampsMs,
+               QVector<double> *values) const;
+
+  // Moc thoi gian mau dau/cuoi con giu; ca hai bang 0 neu rong.
+  qint64 firstTimestampMs() const;
+  qint64 lastTimestampMs() const;
+
+  Stats stats() const;
+
+  // min/max cua count gia tri, bo qua NaN (SSE2 neu co). Ca hai NaN neu khong co gia
+  // tri hop le.
+  static void minMax(const double *values, int count, double *minimum, double *maximum);
+
+ private:
+  // Day bit MSB-first tren cac word 64 bit de giai nen doc nhieu bit mot lan.
+  struct BitStream {
+    std::vector<quint64> words;
+    quint32 bitCount = 0;
+    void write(quint64 value, int bits);
+  };
+
+  // Trang thai ma hoa XOR cua mot kenh trong chunk dang mo.
+  struct ValueState {
+    quint64 previousBits = 0;
+    int leading = -1;  // -1: chua co cua so de dung lai.
+    int trailing = 0;
+  };
+
+  struct Chunk {
+    qint64 firstMs = 0;
+    qint64 lastMs = 0;
+    int count = 0;
+    BitStream times;  // Delta-of-delta tu mau thu hai.
+    std::vector<BitStream> values;
+    std::vector<double> minimum;  // Theo kenh, bo qua NaN.
+    std::vector<double> maximum;
+  };
+
+  void openChunk(qint64 timestampMs);
+  void sealHead();
+  void dropExpired();
+  static void encodeValue(BitStream *stream, ValueState *state, double value, bool first);
+  static void decodeTimes(const Chunk &chunk, qint64 *out);
+  static void decodeValues(const BitStream &stream, int count, double *out);
+
+  const qint64 m_retentionMs;
+  mutable QMutex m_mutex;
+  QStringList m_labels;
+  std::deque<Chunk> m_chunks;  // Chunk cuoi la chunk dang mo (neu co).
+  std::vector<ValueState> m_headStates;
+  qint64 m_headPreviousDelta = 0;
+  bool m_headOpen = false;
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_HISTORY_H
@@ -0,0 +1,421 @@
+#include "sensor_io_backend.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#ifdef FANS_CONTROLLER_HAVE_IO_URING
+#include <linux/io_uring.h>
+
+#include <atomic>
+#endif
+
+namespace {
+constexpr int kAttributeBufferSize = 32;  // Gia tri hwmon la so nguyen ngan.
+// So lan thu lai io_uring_enter lien tiep khi EAGAIN/EBUSY hoac khong nop duoc SQE nao.
+constexpr int kMaxEnterRetries = 8;
+
+double nowUs() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Cach lam cu: moi thuoc tinh open/read/close rieng, tuan tu.
+class PlainSensorIoBackend : public SensorIoBackend {
+ public:
+  const char *name() const override { return "plain"; }
+
+  bool setAttributes(const QVector<QByteArray> &paths) override {
+    m_paths = paths;
+    return true;
+  }
+
+  bool readAll(QVector<RawReading> *out) override {
+    const double start = nowUs();
+    quint64 syscalls = 0;
+    out->resize(m_paths.size());
+    char buf[kAttributeBufferSize];
+    for (qsizetype i = 0; i < m_paths.size(); ++i) {
+      RawReading &reading = (*out)[i];
+      reading = RawReading();
+      const int fd = ::open(m_paths[i].constData(), O_RDONLY | O_CLOEXEC);
+      ++syscalls;
+      if (fd < 0) {
+        continue;
+      }
+      const ssize_t n = ::read(fd, buf, sizeof(buf));
+      ::close(fd);
+      syscalls += 2;
+      if (n > 0) {
+        reading = parseReading(buf, n);
+      }
+    }
+    recordRefresh(syscalls, nowUs() - start, static_cast<quint64>(m_paths.size()));
+    return true;
+  }
+
+ private:
+  QVector<QByteArray> m_paths;
+};
+
+#ifdef FANS_CONTROLLER_HAVE_IO_URING
+int sysIoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sysIoUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int sysIoUringRegister(int fd, unsigned opcode, const void *arg, unsigned nrArgs) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+// io_uring goi thang bang syscall (khong phu thuoc liburing). Moi thuoc tinh giu mot fd
+// mo san, dang ky bang IORING_REGISTER_FILES va doc lai tu offset 0 moi refresh.
+class IoUringSensorIoBackend : public SensorIoBackend {
+ public:
+  ~IoUringSensorIoBackend() override {
+    closeFiles();
+    if (m_sqes) {
+      ::munmap(m_sqes, m_sqesSize);
+    }
+    if (m_cqRing && m_cqRing != m_sqRing) {
+      ::munmap(m_cqRing, m_cqRingSize);
+    }
+    if (m_sqRing) {
+      ::munmap(m_sqRing, m_sqRingSize);
+    }
+    if (m_ringFd >= 0) {
+      ::close(m_ringFd);
+    }
+  }
+
+  const char *name() const override { return "io_uring"; }
+
+  // Tao ring; tra ve false neu kernel khong ho tro (ENOSYS) hoac bi chan (EPERM).
+  bool init(unsigned entries) {
+    io_uring_params params{};
+    m_ringFd = sysIoUringSetup(entries, &params);
+    if (m_ringFd < 0) {
+      return false;
+    }
+    m_entries = params.sq_entries;
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+      m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+    m_sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ringFd, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+      m_sqRing = nullptr;
+      return false;
+    }
+    if (singleMmap) {
+      m_cqRing = m_sqRing;
+    } else {
+      m_cqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_CQ_RING);
+      if (m_cqRing == MAP_FAILED) {
+        m_cqRing = nullptr;
+        return false;
+      }
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return false;
+    }
+    m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<char *>(m_sqRing);
+    m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(m_cqRing);
+    m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  bool setAttributes(const QVector<QByteArray> &paths) override {
+    closeFiles();
+    m_fds.reserve(paths.size());
+    for (const QByteArray &path : paths) {
+      // Thuoc tinh khong mo duoc van giu cho (-1) de chi so khop voi ket qua.
+      m_fds.append(::open(path.constData(), O_RDONLY | O_CLOEXEC));
+    }
+    m_buffers.resize(paths.size() * kAttributeBufferSize);
+    m_iovecs.resize(paths.size());
+    for (qsizetype i = 0; i < paths.size(); ++i) {
+      m_iovecs[i].iov_base = m_buffers.data() + i * kAttributeBufferSize;
+      m_iovecs[i].iov_len = kAttributeBufferSize;
+    }
+    if (!m_fds.isEmpty()) {
+      // fd -1 trong bang dang ky la "slot trong"; lenh doc vao slot do se tra -EBADF.
+      if (sysIoUringRegister(m_ringFd, IORING_REGISTER_FILES, m_fds.constData(),
+                             static_cast<unsigned>(m_fds.size())) < 0) {
+        return false;
+      }
+      m_registered = true;
+    }
+    return true;
+  }
+
+  bool readAll(QVector<RawReading> *out) override {
+    const double start = nowUs();
+    quint64 syscalls = 0;
+    const unsigned total = static_cast<unsigned>(m_fds.size());
+    // Xoa ket qua cu: lo bi bo giua chung de lai cac chi so chua doc o trang thai loi.
+    out->fill(RawReading(), total);
+    if (m_inFlight > 0 && !drainInFlight(&syscalls)) {
+      recordRefresh(syscalls, nowUs() - start, 0);
+      return false;
+    }
+
+    // Chia lo theo kich thuoc ring (thuong mot lo la du cho ca refresh).
+    for (unsigned first = 0; first < total; first += m_entries) {
+      const unsigned count = std::min(m_entries, total - first);
+      unsigned tail = *m_sqTail;
+      for (unsigned k = 0; k < count; ++k) {
+        const unsigned index = first + k;
+        const unsigned slot = tail & m_sqMask;
+        io_uring_sqe &sqe = m_sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        // READV (kernel >= 5.1) thay vi READ (>= 5.6) de chay duoc tren nhieu kernel hon.
+        sqe.opcode = IORING_OP_READV;
+        sqe.flags = IOSQE_FIXED_FILE;
+        sqe.fd = static_cast<int>(index);  // Chi so trong bang file da dang ky.
+        sqe.addr = reinterpret_cast<quint64>(&m_iovecs[index]);
+        sqe.len = 1;
+        sqe.off = 0;
+        sqe.user_data = index;
+        m_sqArray[slot] = slot;
+        ++tail;
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+      *m_sqTail = tail;
+
+      // io_uring_enter co the nhan it SQE hon yeu cau hoac loi tam thoi: nop tiep phan
+      // con lai, vua nop vua lay CQE (CQ day -> EBUSY), cho den khi du count ket qua.
+      unsigned submitted = 0;
+      unsigned reaped = 0;
+      int retries = 0;
+      while (true) {
+        reaped += reapCompletions(out);
+        if (reaped == count) {
+          break;
+        }
+        const unsigned toSubmit = count - submitted;
+        const int ret = sysIoUringEnter(m_ringFd, toSubmit, count - reaped, IORING_ENTER_GETEVENTS);
+        ++syscalls;
+        if (ret > 0 || (ret == 0 && toSubmit == 0)) {
+          submitted += static_cast<unsigned>(ret);
+          retries = 0;
+          continue;
+        }
+        if (ret < 0 && errno == EINTR) {
+          continue;
+        }
+        const bool transient = ret == 0 || errno == EAGAIN || errno == EBUSY;
+        if (!transient || ++retries > kMaxEnterRetries) {
+          abandonBatch(submitted - reaped, &syscalls);
+          recordRefresh(syscalls, nowUs() - start, first);
+          return false;
+        }
+      }
+    }
+
+    recordRefresh(syscalls, nowUs() - start, total);
+    return true;
+  }
+
+ private:
+  // Lay moi CQE dang co vao out (out == nullptr: bo di, dung khi xa lenh cu).
+  unsigned reapCompletions(QVector<RawReading> *out) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    unsigned head = *m_cqHead;
+    const unsigned cqTail = *m_cqTail;
+    unsigned reaped = 0;
+    for (; head != cqTail; ++head, ++reaped) {
+      if (!out) {
+        continue;
+      }
+      const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+      const auto index = static_cast<qsizetype>(cqe.user_data);
+      RawReading reading;
+      if (cqe.res > 0) {
+        reading = parseReading(m_buffers.constData() + index * kAttributeBufferSize, cqe.res);
+      }
+      (*out)[index] = reading;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    *m_cqHead = head;
+    return reaped;
+  }
+
+  // Bo lo dang doc do: SQE kernel chua lay thi rut lai (dua tail ve head), lenh da nop
+  // thi cho xong va bo ket qua, de lan readAll() sau khong nhan CQE cu.
+  void abandonBatch(unsigned inFlight, quint64 *syscalls) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    *m_sqTail = *m_sqHead;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_inFlight = inFlight;
+    drainInFlight(syscalls);
+  }
+
+  // Cho cac lenh con treo cua lo bi bo; false neu cho loi (thu lai o lan readAll() sau).
+  bool drainInFlight(quint64 *syscalls) {
+    while (true) {
+      m_inFlight -= std::min(m_inFlight, reapCompletions(nullptr));
+      if (m_inFlight == 0) {
+        return true;
+      }
+      const int ret = sysIoUringEnter(m_ringFd, 0, m_inFlight, IORING_ENTER_GETEVENTS);
+      ++*syscalls;
+      if (ret < 0 && errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  void closeFiles() {
+    if (m_registered) {
+      sysIoUringRegister(m_ringFd, IORING_UNREGISTER_FILES, nullptr, 0);
+      m_registered = false;
+    }
+    for (const int fd : m_fds) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+    m_fds.clear();
+  }
+
+  int m_ringFd = -1;
+  unsigned m_entries = 0;
+  void *m_sqRing = nullptr;
+  void *m_cqRing = nullptr;
+  size_t m_sqRingSize = 0;
+  size_t m_cqRingSize = 0;
+  io_uring_sqe *m_sqes = nullptr;
+  size_t m_sqesSize = 0;
+  unsigned *m_sqHead = nullptr;
+  unsigned *m_sqTail = nullptr;
+  unsigned *m_sqArray = nullptr;
+  unsigned m_sqMask = 0;
+  unsigned *m_cqHead = nullptr;
+  unsigned *m_cqTail = nullptr;
+  unsigned m_cqMask = 0;
+  io_uring_cqe *m_cqes = nullptr;
+
+  QVector<int> m_fds;
+  QByteArray m_buffers;
+  QVector<iovec> m_iovecs;
+  bool m_registered = false;
+  unsigned m_inFlight = 0;  // Lenh cua lo bi bo chua co CQE.
+};
+#endif  // FANS_CONTROLLER_HAVE_IO_URING
+}  // namespace
+
+std::unique_ptr<SensorIoBackend> SensorIoBackend::create(Kind kind) {
+  if (kind == Kind::Auto) {
+    bool ok = false;
+    const Kind fromEnv = parseKind(qEnvironmentVariable("FANS_CONTROLLER_IO_BACKEND"), &ok);
+    kind = ok ? fromEnv : Kind::IoUring;
+  }
+#ifdef FANS_CONTROLLER_HAVE_IO_URING
+  if (kind == Kind::IoUring) {
+    auto backend = std::make_unique<IoUringSensorIoBackend>();
+    if (backend->init(64)) {
+      return backend;
+    }
+  }
+#endif
+  return std::make_unique<PlainSensorIoBackend>();
+}
+
+bool SensorIoBackend::readText(const QByteArray &path, QByteArray *out) {
+  out->clear();
+  const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  char buf[4096];
+  const ssize_t n = ::read(fd, buf, sizeof(buf));
+  ::close(fd);
+  if (n < 0) {
+    return false;
+  }
+  out->append(buf, static_cast<qsizetype>(n));
+  return true;
+}
+
+bool SensorIoBackend::writeText(const QByteArray &path, const QByteArray &data) {
+  const int fd = ::open(path.constData(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const ssize_t written = ::write(fd, data.constData(), static_cast<size_t>(data.size()));
+  ::close(fd);
+  return written == data.size();
+}
+
+SensorIoBackend::Kind SensorIoBackend::parseKind(const QString &text, bool *ok) {
+  const QString lower = text.trimmed().toLower();
+  if (ok) {
+    *ok = true;
+  }
+  if (lower == "plain") {
+    return Kind::Plain;
+  }
+  if (lower == "io_uring" || lower == "uring") {
+    return Kind::IoUring;
+  }
+  if (ok) {
+    *ok = lower == "auto";
+  }
+  return Kind::Auto;
+}
+
+SensorIoBackend::RawReading SensorIoBackend::parseReading(const char *data, qint64 length) {
+  char buf[kAttributeBufferSize + 1];
+  const qint64 n = std::min<qint64>(length, kAttributeBufferSize);
+  std::memcpy(buf, data, static_cast<size_t>(n));
+  buf[n] = '\0';
+  char *end = nullptr;
+  errno = 0;
+  const long long value = std::strtoll(buf, &end, 10);
+  RawReading reading;
+  if (end != buf && errno == 0 && (*end == '\0' || *end == '\n' || *end == ' ')) {
+    reading.value = value;
+    reading.ok = true;
+  }
+  return reading;
+}
+
+void SensorIoBackend::recordRefresh(quint64 syscalls, double wallUs, quint64 reads) {
+  ++m_stats.refreshes;
+  m_stats.lastSyscalls = syscalls;
+  m_stats.totalSyscalls += syscalls;
+  m_stats.totalReads += reads;
+  m_stats.lastWallUs = wallUs;
+  m_stats.totalWallUs += wallUs;
+}
@@ -0,0 +1,79 @@
+#ifndef FANS_CONTROLLER_SENSOR_IO_BACKEND_H
+#define FANS_CONTROLLER_SENSOR_IO_BACKEND_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <memory>
+
+// Backend doc hang loat cac file thuoc tinh sysfs (temp*_input, fan*_input, pwm*...).
+// Danh sach duong dan duoc dang ky mot lan; moi lan refresh chi goi readAll().
+//   - "plain":    open/read/close tung file, tuan tu (3 syscall moi thuoc tinh).
+//   - "io_uring": mo san va dang ky fd mot lan, gui moi lenh doc cua mot refresh trong
+//                 mot lo roi thu tat ca completion (mot syscall io_uring_enter).
+// Neu kernel/seccomp khong cho io_uring thi create() tu dong lui ve plain.
+// readText()/writeText() phuc vu duong dieu khien (label, pwmN, pwmN_enable...) de moi
+// truy cap sysfs cua TufGamingFx705ge di qua backend (ghi/phat lai trace, mo phong).
+class SensorIoBackend {
+ public:
+  enum class Kind { Auto, Plain, IoUring };
+
+  // Gia tri so nguyen doc tu mot thuoc tinh; ok = false neu mo/doc/phan tich that bai.
+  struct RawReading {
+    qint64 value = 0;
+    bool ok = false;
+  };
+
+  // Thong ke chi phi: so syscall, so thuoc tinh sysfs doc va thoi gian thuc cho moi lan
+  // readAll().
+  struct Stats {
+    quint64 refreshes = 0;
+    quint64 lastSyscalls = 0;
+    quint64 totalSyscalls = 0;
+    quint64 totalReads = 0;  // Backend gia lap/phat lai khong doc sysfs: 0.
+    double lastWallUs = 0.0;
+    double totalWallUs = 0.0;
+  };
+
+  virtual ~SensorIoBackend() = default;
+
+  virtual const char *name() const = 0;
+
+  // Dang ky danh sach thuoc tinh; thu tu ket qua readAll() trung voi thu tu nay.
+  virtual bool setAttributes(const QVector<QByteArray> &paths) = 0;
+
+  // Doc toan bo thuoc tinh da dang ky vao out (resize theo so thuoc tinh). Tra ve false
+  // neu lan doc hong giua chung; khi do thuoc tinh chua doc duoc co ok = false (khong bao
+  // gio giu gia tri cua lan doc truoc).
+  virtual bool readAll(QVector<RawReading> *out) = 0;
+
+  // Doc/ghi mot file sysfs le (ngoai ke hoach doc). Mac dinh: open/read|write/close.
+  virtual bool readText(const QByteArray &path, QByteArray *out);
+  virtual bool writeText(const QByteArray &path, const QByteArray &data);
+
+  // Danh dau su kien dieu khien (vd. setpoint quat moi); chi backend ghi trace dung.
+  virtual void annotate(const QByteArray &key, qint64 value) {
+    Q_UNUSED(key);
+    Q_UNUSED(value);
+  }
+
+  virtual Stats stats() const { return m_stats; }
+
+  // Tao backend theo kind. Auto doc bien moi truong FANS_CONTROLLER_IO_BACKEND
+  // ("plain" / "io_uring"), mac dinh uu tien io_uring neu kha dung.
+  static std::unique_ptr<SensorIoBackend> create(Kind kind = Kind::Auto);
+
+  static Kind parseKind(const QString &text, bool *ok = nullptr);
+
+ protected:
+  // Phan tich noi dung file sysfs thanh so nguyen (bo khoang trang/xuong dong cuoi).
+  static RawReading parseReading(const char *data, qint64 length);
+
+  void recordRefresh(quint64 syscalls, double wallUs, quint64 reads = 0);
+
+  Stats m_stats;
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_IO_BACKEND_H
@@ -0,0 +1,116 @@
+#include "sensor_sampler.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+#include <ctime>
+#include <limits>
+
+namespace {
+qint64 bootTimeMs() {
+  timespec ts{};
+  clock_gettime(CLOCK_BOOTTIME, &ts);
+  return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+}  // namespace
+
+SensorSampler::SensorSampler(TufGamingFx705ge &device, int intervalMs, QObject *parent)
+    : QObject(parent),
+      m_device(device),
+      m_intervalMs(qMax(1, intervalMs)),
+      m_epochOffsetMs(QDateTime::currentMSecsSinceEpoch() - bootTimeMs()) {
+  m_thread = QThread::create([this]() { run(); });
+  m_thread->setObjectName("SensorSampler");
+  m_thread->start();
+}
+
+SensorSampler::~SensorSampler() {
+  {
+    QMutexLocker lock(&m_mutex);
+    m_stopping = true;
+  }
+  m_wake.wakeOne();
+  m_thread->wait();
+  delete m_thread;
+}
+
+void SensorSampler::run() {
+  QElapsedTimer clock;
+  clock.start();
+  qint64 nextMs = m_intervalMs;  // Cache da duoc refresh luc tao cua so.
+
+  QMutexLocker lock(&m_mutex);
+  for (;;) {
+    while (!m_stopping) {
+      const qint64 waitMs = nextMs - clock.elapsed();
+      if (waitMs <= 0) {
+        break;
+      }
+      m_wake.wait(&m_mutex, static_cast<unsigned long>(waitMs));
+    }
+    if (m_stopping) {
+      return;
+    }
+    lock.unlock();
+
+    // Cap phat tinh ca ghi lich su va publish len bus: toan bo chi phi mot lan refresh.
+    const quint64 allocationsBefore = SelfOverhead::threadAllocations();
+    m_device.refreshSensors();
+    recordSample();
+    m_refreshAllocations += SelfOverhead::threadAllocations() - allocationsBefore;
+    ++m_refreshes;
+    emit sampled();
+
+    // Bi tre qua mot chu ky (vd. EC treo) thi bo qua cac moc da lo thay vi doc don dap.
+    nextMs += m_intervalMs;
+    const qint64 now = clock.elapsed();
+    if (nextMs <= now) {
+      nextMs = now + m_intervalMs;
+    }
+    lock.relock();
+  }
+}
+
+SelfOverhead::Counters SensorSampler::overheadCounters() const {
+  const SensorIoBackend::Stats io = m_device.ioStats();
+  SelfOverhead::Counters counters;
+  counters.refreshes = m_refreshes;
+  counters.syscalls = io.totalSyscalls;
+  counters.sysfsReads = io.totalReads;
+  counters.allocations = m_refreshAllocations;
+  return counters;
+}
+
+// Ghi mau vao lich su roi publish cung mang gia tri len bus.
+void SensorSampler::recordSample() {
+  constexpr double kMissing = std::numeric_limits<double>::quiet_NaN();
+  const QVector<TufGamingFx705ge::TemperatureSample> details = m_device.detailTemperatures();
+  const TufGamingFx705ge::FanSample fan = m_device.fan();
+
+  // Danh sach kenh chi doi khi ke hoach doc doi (thuc te chi lan dau).
+  if (m_historyChannels != details.size() + 3) {
+    QStringList labels = {"CPU Package", "PCH", "Fan RPM"};
+    QVector<SensorBus::ChannelKind> kinds(3 + details.size(),
+                                          SensorBus::ChannelKind::Temperature);
+    kinds[2] = SensorBus::ChannelKind::FanRpm;
+    for (const TufGamingFx705ge::TemperatureSample &sample : details) {
+      labels.append(sample.label);
+    }
+    m_history.setChannels(labels);
+    m_bus.setChannels(labels, kinds);
+    m_historyChannels = static_cast<int>(labels.size());
+  }
+
+  QVector<double> values;
+  values.reserve(m_historyChannels);
+  const TufGamingFx705ge::TemperatureSample cpuPackage = m_device.cpuPackageTemperature();
+  const TufGamingFx705ge::TemperatureSample pch = m_device.pchTemperature();
+  values.append(cpuPackage.valid ? cpuPackage.celsius : kMissing);
+  values.append(pch.valid ? pch.celsius : kMissing);
+  values.append(fan.rpmValid ? fan.rpm : kMissing);
+  for (const TufGamingFx705ge::TemperatureSample &sample : details) {
+    values.append(sample.valid ? sample.celsius : kMissing);
+  }
+  m_history.append(bootTimeMs() + m_epochOffsetMs, values);
+  m_bus.publish(values);
+}
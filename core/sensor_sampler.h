@@ -0,0 +1,70 @@
+#ifndef FANS_CONTROLLER_SENSOR_SAMPLER_H
+#define FANS_CONTROLLER_SENSOR_SAMPLER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "self_overhead.h"
+#include "sensor_bus.h"
+#include "sensor_history.h"
+#include "tuf_gaming_fx705ge.h"
+
+// Lay mau sensor dinh ky tren thread rieng: moi chu ky goi refreshSensors() (doc sysfs
+// va chay SensorAnomalyDetector) roi phat sampled(). Thread GUI chi doc cache cua
+// TufGamingFx705ge nen khong bao gio phai cho EC tra loi. Chu ky tinh theo moc tuyet
+// doi de khong troi theo thoi gian doc. Moi mau duoc them vao SensorHistory (24 gio, nen)
+// de bieu do xem lai ma khong phai giu double tho, va publish len SensorBus de consumer
+// chi duoc goi khi gia tri lech qua deadband cua rieng no.
+class SensorSampler : public QObject {
+  Q_OBJECT
+
+ public:
+  static constexpr int kDefaultIntervalMs = 1000;
+
+  explicit SensorSampler(TufGamingFx705ge &device, int intervalMs = kDefaultIntervalMs,
+                         QObject *parent = nullptr);
+  ~SensorSampler() override;
+
+  // Kenh: "CPU Package", "PCH", "Fan RPM" roi cac nhan detailTemperatures().
+  const SensorHistory &history() const { return m_history; }
+  // Cung thu tu kenh voi history(); callback chay tren thread sampler.
+  SensorBus &bus() { return m_bus; }
+
+  // So lan refresh, syscall/doc sysfs (backend) va cap phat heap cua thread sampler trong
+  // cac lan refresh tu luc khoi dong, cho SelfOverhead.
+  SelfOverhead::Counters overheadCounters() const;
+
+ signals:
+  // Phat tu thread sampler sau moi lan refresh (ke ca khi khong kenh nao doi); ket noi
+  // voi doi tuong GUI se tu dong queued. Su kien loi lay bang
+  // TufGamingFx705ge::takeSensorFaultEvents().
+  void sampled();
+
+ private:
+  void run();
+  void recordSample();
+
+  TufGamingFx705ge &m_device;
+  const int m_intervalMs;
+  // Moc thoi gian lich su = CLOCK_BOOTTIME + do lech voi dong ho thuc chot luc tao: khong
+  // lui khi NTP/nguoi dung chinh gio (SensorHistory::append() tu choi mau lui), van tang
+  // trong luc may ngu nen khoang ngu hien thanh khoang trong tren bieu do.
+  const qint64 m_epochOffsetMs;
+  QThread *m_thread = nullptr;
+
+  QMutex m_mutex;  // Bao ve m_stopping.
+  QWaitCondition m_wake;
+  bool m_stopping = false;
+
+  SensorHistory m_history;
+  SensorBus m_bus;
+  std::atomic<quint64> m_refreshes{0};
+  std::atomic<quint64> m_refreshAllocations{0};
+  int m_historyChannels = 0;  // Chi thread sampler dung.
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_SAMPLER_H
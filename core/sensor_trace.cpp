@@ -0,0 +1,406 @@
+#include "sensor_trace.h"
+
+#include <QFile>
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace {
+const char kTraceMagic[8] = {'F', 'A', 'N', 'S', 'T', 'R', 'C', '\0'};
+constexpr quint32 kTraceVersion = 1;
+
+// Ma su kien; moi su kien: u8 ma, i64 thoi gian (ns), roi phan du lieu rieng.
+constexpr quint8 kEventAttributes = 1;  // u32 so luong, moi duong dan: bytes.
+constexpr quint8 kEventFrame = 2;       // u32 so luong, moi gia tri: i64 + u8 ok.
+constexpr quint8 kEventReadText = 3;    // bytes duong dan, u8 ok, bytes noi dung.
+constexpr quint8 kEventWriteText = 4;   // bytes duong dan, u8 ok, bytes noi dung.
+constexpr quint8 kEventAnnotation = 5;  // bytes key, i64 gia tri.
+
+// File trace chi mo mot lan moi tien trinh: mo lai voi "w" se cat mat trace cua device
+// dau tien (vd. --bench-io tao mot device cho moi backend).
+std::atomic<bool> g_traceClaimed{false};
+
+qint64 monotonicNs() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+template <typename T>
+void appendPod(QByteArray *out, T value) {
+  out->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void appendBytes(QByteArray *out, const QByteArray &data) {
+  appendPod<quint32>(out, static_cast<quint32>(data.size()));
+  out->append(data);
+}
+
+void beginEvent(QByteArray *out, quint8 type, qint64 timeNs) {
+  out->clear();
+  appendPod<quint8>(out, type);
+  appendPod<qint64>(out, timeNs);
+}
+
+// Doc tuan tu tu vung nho trace; ok = false khi du lieu bi cat cut.
+struct TraceReader {
+  const char *cursor;
+  const char *end;
+  bool ok = true;
+
+  template <typename T>
+  T pod() {
+    T value{};
+    if (end - cursor < static_cast<qint64>(sizeof(T))) {
+      ok = false;
+      cursor = end;
+      return value;
+    }
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+  }
+
+  QByteArray bytes() {
+    const quint32 size = pod<quint32>();
+    if (!ok || end - cursor < static_cast<qint64>(size)) {
+      ok = false;
+      cursor = end;
+      return {};
+    }
+    QByteArray data(cursor, static_cast<qsizetype>(size));
+    cursor += size;
+    return data;
+  }
+};
+}  // namespace
+
+std::unique_ptr<SensorIoBackend> TraceRecordingBackend::wrapIfRequested(
+    std::unique_ptr<SensorIoBackend> inner, const DeviceProbe::Capabilities &caps) {
+  const QString path = qEnvironmentVariable("FANS_CONTROLLER_TRACE");
+  if (path.isEmpty()) {
+    return inner;
+  }
+  if (g_traceClaimed.exchange(true)) {
+    qWarning("Trace %s da duoc ghi boi device khac trong tien trinh nay, bo qua.",
+             qPrintable(path));
+    return inner;
+  }
+  std::FILE *file = std::fopen(QFile::encodeName(path).constData(), "wbe");
+  if (!file) {
+    qWarning("Khong mo duoc file trace %s: %s", qPrintable(path), std::strerror(errno));
+    return inner;
+  }
+  const QByteArray manifest = DeviceProbe::encodeManifest(caps);
+  QByteArray header(kTraceMagic, sizeof(kTraceMagic));
+  appendPod<quint32>(&header, kTraceVersion);
+  appendBytes(&header, manifest);
+  std::fwrite(header.constData(), 1, static_cast<size_t>(header.size()), file);
+  return std::make_unique<TraceRecordingBackend>(std::move(inner), file);
+}
+
+TraceRecordingBackend::TraceRecordingBackend(std::unique_ptr<SensorIoBackend> inner,
+                                             std::FILE *file)
+    : m_inner(std::move(inner)), m_file(file), m_startNs(monotonicNs()) {
+  // Bo dem lon: chi flush theo frame nen chi phi ghi trace la mot write() moi refresh.
+  std::setvbuf(m_file, nullptr, _IOFBF, 64 * 1024);
+}
+
+TraceRecordingBackend::~TraceRecordingBackend() {
+  std::fclose(m_file);
+}
+
+bool TraceRecordingBackend::setAttributes(const QVector<QByteArray> &paths) {
+  beginEvent(&m_buffer, kEventAttributes, monotonicNs() - m_startNs);
+  appendPod<quint32>(&m_buffer, static_cast<quint32>(paths.size()));
+  for (const QByteArray &path : paths) {
+    appendBytes(&m_buffer, path);
+  }
+  writeEvent(m_buffer, true);
+
+  if (m_inner->setAttributes(paths)) {
+    return true;
+  }
+  // Giong TufGamingFx705ge::buildSensorPlan(): lui ve plain ma khong mat trace dang ghi.
+  m_inner = SensorIoBackend::create(Kind::Plain);
+  return m_inner->setAttributes(paths);
+}
+
+bool TraceRecordingBackend::readAll(QVector<RawReading> *out) {
+  const bool ok = m_inner->readAll(out);
+  beginEvent(&m_buffer, kEventFrame, monotonicNs() - m_startNs);
+  appendPod<quint32>(&m_buffer, static_cast<quint32>(out->size()));
+  for (const RawReading &reading : *out) {
+    appendPod<qint64>(&m_buffer, reading.value);
+    appendPod<quint8>(&m_buffer, reading.ok ? 1 : 0);
+  }
+  writeEvent(m_buffer, true);
+  return ok;
+}
+
+bool TraceRecordingBackend::readText(const QByteArray &path, QByteArray *out) {
+  const bool ok = m_inner->readText(path, out);
+  beginEvent(&m_buffer, kEventReadText, monotonicNs() - m_startNs);
+  appendBytes(&m_buffer, path);
+  appendPod<quint8>(&m_buffer, ok ? 1 : 0);
+  appendBytes(&m_buffer, ok ? *out : QByteArray());
+  writeEvent(m_buffer, false);
+  return ok;
+}
+
+bool TraceRecordingBackend::writeText(const QByteArray &path, const QByteArray &data) {
+  const bool ok = m_inner->writeText(path, data);
+  beginEvent(&m_buffer, kEventWriteText, monotonicNs() - m_startNs);
+  appendBytes(&m_buffer, path);
+  appendPod<quint8>(&m_buffer, ok ? 1 : 0);
+  appendBytes(&m_buffer, data);
+  writeEvent(m_buffer, false);
+  return ok;
+}
+
+void TraceRecordingBackend::annotate(const QByteArray &key, qint64 value) {
+  beginEvent(&m_buffer, kEventAnnotation, monotonicNs() - m_startNs);
+  appendBytes(&m_buffer, key);
+  appendPod<qint64>(&m_buffer, value);
+  writeEvent(m_buffer, false);
+}
+
+void TraceRecordingBackend::writeEvent(const QByteArray &event, bool flush) {
+  std::fwrite(event.constData(), 1, static_cast<size_t>(event.size()), m_file);
+  if (flush) {
+    std::fflush(m_file);
+  }
+}
+
+std::unique_ptr<TraceReplayBackend> TraceReplayBackend::open(const QString &path,
+                                                             QString *error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = QString("Khong mo duoc trace: %1").arg(path);
+    return nullptr;
+  }
+  std::unique_ptr<TraceReplayBackend> backend(new TraceReplayBackend());
+  if (!backend->parse(file.readAll(), error)) {
+    return nullptr;
+  }
+  return backend;
+}
+
+bool TraceReplayBackend::parse(const QByteArray &bytes, QString *error) {
+  TraceReader reader{bytes.constData(), bytes.constData() + bytes.size()};
+  if (bytes.size() < static_cast<qsizetype>(sizeof(kTraceMagic)) ||
+      std::memcmp(bytes.constData(), kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    *error = "File khong phai trace cua FansController.";
+    return false;
+  }
+  reader.cursor += sizeof(kTraceMagic);
+  if (reader.pod<quint32>() != kTraceVersion) {
+    *error = "Phien ban trace khong duoc ho tro.";
+    return false;
+  }
+  const QByteArray manifest = reader.bytes();
+  if (!reader.ok || !DeviceProbe::decodeManifest(manifest.constData(),
+                                                 static_cast<size_t>(manifest.size()),
+                                                 &m_capabilities)) {
+    *error = "Header trace (manifest phan cung) khong hop le.";
+    return false;
+  }
+
+  while (reader.ok && reader.cursor < reader.end) {
+    Event event;
+    event.type = reader.pod<quint8>();
+    event.timeNs = reader.pod<qint64>();
+    switch (event.type) {
+      case kEventAttributes: {
+        const quint32 count = reader.pod<quint32>();
+        for (quint32 i = 0; i < count && reader.ok; ++i) {
+          event.paths.append(reader.bytes());
+        }
+        break;
+      }
+      case kEventFrame: {
+        const quint32 count = reader.pod<quint32>();
+        event.values.reserve(static_cast<qsizetype>(count));
+        for (quint32 i = 0; i < count && reader.ok; ++i) {
+          RawReading reading;
+          reading.value = reader.pod<qint64>();
+          reading.ok = reader.pod<quint8>() != 0;
+          event.values.append(reading);
+        }
+        break;
+      }
+      case kEventReadText:
+      case kEventWriteText:
+        event.path = reader.bytes();
+        event.ok = reader.pod<quint8>() != 0;
+        event.data = reader.bytes();
+        if (event.type == kEventReadText && event.ok && !m_firstText.contains(event.path)) {
+          m_firstText.insert(event.path, event.data);
+        }
+        break;
+      case kEventAnnotation:
+        event.path = reader.bytes();
+        event.value = reader.pod<qint64>();
+        break;
+      default:
+        reader.ok = false;
+        break;
+    }
+    if (!reader.ok) {
+      // Su kien cuoi bi cat (vd. tien trinh ghi bi kill): giu phan truoc do.
+      break;
+    }
+    m_events.append(std::move(event));
+  }
+  return true;
+}
+
+bool TraceReplayBackend::setAttributes(const QVector<QByteArray> &paths) {
+  m_requestedPaths = paths;
+  rebuildAttributeMap();
+  return true;
+}
+
+void TraceReplayBackend::rebuildAttributeMap() {
+  QHash<QByteArray, int> recordedIndex;
+  for (qsizetype i = 0; i < m_recordedPaths.size(); ++i) {
+    recordedIndex.insert(m_recordedPaths[i], static_cast<int>(i));
+  }
+  m_attributeMap.resize(m_requestedPaths.size());
+  for (qsizetype i = 0; i < m_requestedPaths.size(); ++i) {
+    m_attributeMap[i] = recordedIndex.value(m_requestedPaths[i], -1);
+  }
+}
+
+bool TraceReplayBackend::readAll(QVector<RawReading> *out) {
+  while (m_cursor < m_events.size()) {
+    const Event &event = m_events[m_cursor++];
+    switch (event.type) {
+      case kEventAttributes:
+        m_recordedPaths = event.paths;
+        rebuildAttributeMap();
+        break;
+      case kEventReadText:
+        if (event.ok) {
+          m_lastText.insert(event.path, event.data);
+        }
+        break;
+      case kEventAnnotation:
+        m_annotations.append({event.timeNs, event.path, event.value});
+        break;
+      case kEventFrame: {
+        out->resize(m_requestedPaths.size());
+        for (qsizetype i = 0; i < m_requestedPaths.size(); ++i) {
+          const int index = m_attributeMap[i];
+          RawReading reading;
+          if (index >= 0 && index < event.values.size()) {
+            reading = event.values[index];
+          }
+          const auto written = m_overrides.constFind(m_requestedPaths[i]);
+          if (written != m_overrides.constEnd()) {
+            reading = parseReading(written->constData(), written->size());
+          }
+          (*out)[i] = reading;
+        }
+        for (qsizetype i = 0; i < m_recordedPaths.size() && i < event.values.size(); ++i) {
+          if (event.values[i].ok) {
+            m_lastText.insert(m_recordedPaths[i], QByteArray::number(event.values[i].value));
+          }
+        }
+        m_frameTimeNs = event.timeNs;
+        pace(event.timeNs);
+        recordRefresh(0, 0.0);
+        return true;
+      }
+      default:
+        // writeText() goc: controller dang thu tu quyet dinh lenh ghi cua no.
+        break;
+    }
+  }
+  m_finished = true;
+  out->fill(RawReading(), m_requestedPaths.size());
+  return false;
+}
+
+bool TraceReplayBackend::readText(const QByteArray &path, QByteArray *out) {
+  for (const auto *source : {&m_overrides, &m_lastText, &m_firstText}) {
+    const auto it = source->constFind(path);
+    if (it != source->constEnd()) {
+      *out = *it;
+      return true;
+    }
+  }
+  out->clear();
+  return false;
+}
+
+bool TraceReplayBackend::writeText(const QByteArray &path, const QByteArray &data) {
+  m_overrides.insert(path, data);
+  ++m_writes;
+  return true;
+}
+
+QVector<TraceReplayBackend::Annotation> TraceReplayBackend::takeAnnotations() {
+  QVector<Annotation> taken;
+  taken.swap(m_annotations);
+  return taken;
+}
+
+TraceReplayBackend::RecordedControl TraceReplayBackend::recordedControl(const QByteArray &pwmPath,
+                                                                        int pwmMax) const {
+  RecordedControl control;
+  if (pwmMax <= 0) {
+    return control;
+  }
+  int pwmIndex = -1;
+  double fraction = -1.0;  // Chua biet gia tri PWM cho toi frame dau tien.
+  qint64 lastNs = -1;
+  const auto integrate = [&](qint64 nowNs) {
+    if (lastNs >= 0 && fraction >= 0.0) {
+      control.fanEnergy += std::pow(fraction, 3.0) * (nowNs - lastNs) / 1e9;
+    }
+    lastNs = nowNs;
+  };
+  qint64 lastFrameNs = -1;
+  for (const Event &event : m_events) {
+    if (event.type == kEventAttributes) {
+      pwmIndex = static_cast<int>(event.paths.indexOf(pwmPath));
+    } else if (event.type == kEventFrame) {
+      if (fraction < 0.0 && pwmIndex >= 0 && pwmIndex < event.values.size() &&
+          event.values[pwmIndex].ok) {
+        lastNs = event.timeNs;
+        fraction = double(event.values[pwmIndex].value) / pwmMax;
+      }
+      lastFrameNs = event.timeNs;
+    } else if (event.type == kEventWriteText && event.ok && event.path == pwmPath) {
+      integrate(event.timeNs);
+      fraction = event.data.trimmed().toDouble() / pwmMax;
+      ++control.pwmWrites;
+    }
+  }
+  if (lastFrameNs >= 0) {
+    integrate(lastFrameNs);
+  }
+  return control;
+}
+
+void TraceReplayBackend::pace(qint64 timeNs) {
+  if (m_speed <= 0.0) {
+    return;
+  }
+  if (m_traceStartNs < 0) {
+    m_traceStartNs = timeNs;
+    m_wallStartNs = monotonicNs();
+    return;
+  }
+  const qint64 wakeNs =
+      m_wallStartNs + static_cast<qint64>((timeNs - m_traceStartNs) / m_speed);
+  timespec wake{};
+  wake.tv_sec = wakeNs / 1000000000LL;
+  wake.tv_nsec = wakeNs % 1000000000LL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {
+  }
+}
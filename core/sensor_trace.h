@@ -0,0 +1,126 @@
+#ifndef FANS_CONTROLLER_SENSOR_TRACE_H
+#define FANS_CONTROLLER_SENSOR_TRACE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <cstdio>
+#include <memory>
+
+#include "device_probe.h"
+#include "sensor_io_backend.h"
+
+// Trace nhi phan cua moi gia tri tho ma TufGamingFx705ge doc/ghi qua SensorIoBackend,
+// kem moc thoi gian CLOCK_MONOTONIC (ns, tinh tu luc bat dau ghi):
+//   header: "FANSTRC\0", version, manifest DeviceProbe (de phat lai tren may khac)
+//   su kien: danh sach thuoc tinh, frame readAll(), readText(), writeText(), annotate().
+// TraceRecordingBackend boc backend that va ghi trace; TraceReplayBackend doc trace va
+// dong vai backend (khong cham sysfs), phat lai theo toc do 1x, 1000x... hoac nhanh nhat.
+class TraceRecordingBackend : public SensorIoBackend {
+ public:
+  // Boc inner neu bien moi truong FANS_CONTROLLER_TRACE chi toi file trace (ghi de).
+  // Chi device dau tien cua tien trinh duoc ghi; cac device sau chay khong ghi trace.
+  static std::unique_ptr<SensorIoBackend> wrapIfRequested(
+      std::unique_ptr<SensorIoBackend> inner, const DeviceProbe::Capabilities &caps);
+
+  TraceRecordingBackend(std::unique_ptr<SensorIoBackend> inner, std::FILE *file);
+  ~TraceRecordingBackend() override;
+
+  const char *name() const override { return m_inner->name(); }
+  bool setAttributes(const QVector<QByteArray> &paths) override;
+  bool readAll(QVector<RawReading> *out) override;
+  bool readText(const QByteArray &path, QByteArray *out) override;
+  bool writeText(const QByteArray &path, const QByteArray &data) override;
+  void annotate(const QByteArray &key, qint64 value) override;
+  Stats stats() const override { return m_inner->stats(); }
+
+ private:
+  void writeEvent(const QByteArray &event, bool flush);
+
+  std::unique_ptr<SensorIoBackend> m_inner;
+  std::FILE *m_file;
+  qint64 m_startNs;
+  QByteArray m_buffer;  // Tai su dung giua cac su kien de tranh cap phat.
+};
+
+class TraceReplayBackend : public SensorIoBackend {
+ public:
+  // Su kien annotate() da di qua trong lan readAll() gan nhat.
+  struct Annotation {
+    qint64 timeNs;
+    QByteArray key;
+    qint64 value;
+  };
+
+  // Hanh vi dieu khien da ghi trong trace cho mot file pwmN.
+  struct RecordedControl {
+    quint64 pwmWrites = 0;
+    double fanEnergy = 0.0;  // Tich phan (pwm/pwm_max)^3 theo giay.
+  };
+
+  static std::unique_ptr<TraceReplayBackend> open(const QString &path, QString *error);
+
+  const char *name() const override { return "replay"; }
+  bool setAttributes(const QVector<QByteArray> &paths) override;
+
+  // Tra ve frame ke tiep; false khi het trace (finished() = true).
+  bool readAll(QVector<RawReading> *out) override;
+
+  // Gia tri gan nhat tai vi tri phat lai; gia tri da writeText() trong luc phat lai
+  // duoc uu tien de controller dang thu thay dung ket qua ghi cua chinh no.
+  bool readText(const QByteArray &path, QByteArray *out) override;
+  bool writeText(const QByteArray &path, const QByteArray &data) override;
+
+  // 1.0 = thoi gian thuc, 1000.0 = nhanh 1000 lan, <= 0 = khong cho.
+  void setSpeed(double speed) { m_speed = speed; }
+
+  const DeviceProbe::Capabilities &capabilities() const { return m_capabilities; }
+  bool finished() const { return m_finished; }
+  qint64 frameTimeNs() const { return m_frameTimeNs; }
+  quint64 writeCount() const { return m_writes; }
+  QVector<Annotation> takeAnnotations();
+
+  // Tinh lai so lan ghi va nang luong quat cua lan chay goc tu cac su kien writeText().
+  RecordedControl recordedControl(const QByteArray &pwmPath, int pwmMax) const;
+
+ private:
+  struct Event {
+    quint8 type = 0;  // Ma su kien (xem sensor_trace.cpp).
+    qint64 timeNs = 0;
+    QByteArray path;  // Duong dan, hoac key voi annotate().
+    QByteArray data;
+    bool ok = false;
+    qint64 value = 0;
+    QVector<RawReading> values;
+    QVector<QByteArray> paths;
+  };
+
+  TraceReplayBackend() = default;
+  bool parse(const QByteArray &bytes, QString *error);
+  void rebuildAttributeMap();
+  void pace(qint64 timeNs);
+
+  DeviceProbe::Capabilities m_capabilities;
+  QVector<Event> m_events;
+  qsizetype m_cursor = 0;
+
+  QVector<QByteArray> m_requestedPaths;     // Tu setAttributes().
+  QVector<QByteArray> m_recordedPaths;      // Tu su kien danh sach thuoc tinh gan nhat.
+  QVector<int> m_attributeMap;              // requested -> recorded (-1 neu thieu).
+  QHash<QByteArray, QByteArray> m_firstText;
+  QHash<QByteArray, QByteArray> m_lastText;
+  QHash<QByteArray, QByteArray> m_overrides;
+  QVector<Annotation> m_annotations;
+
+  double m_speed = 0.0;
+  qint64 m_traceStartNs = -1;
+  qint64 m_wallStartNs = 0;
+  qint64 m_frameTimeNs = 0;
+  quint64 m_writes = 0;
+  bool m_finished = false;
+};
+
+#endif  // FANS_CONTROLLER_SENSOR_TRACE_H
@@ -0,0 +1,174 @@
+#include "simulated_sensor_backend.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+const char kSimRoot[] = "/sim/hwmon";
+constexpr int kCoreTempHwmon = 0;
+constexpr int kPchHwmon = 1;
+constexpr int kAsusHwmon = 2;
+constexpr int kPwmMax = 255;
+const char *const kHwmonNames[] = {"coretemp", "pch_cannonlake", "asus"};
+// Chenh lech cua tung core so voi package (core nong nhat bang package).
+const double kCoreOffsetsC[] = {0.0, 1.0, 2.5, 0.5, 3.0};
+constexpr int kCoreTemps = sizeof(kCoreOffsetsC) / sizeof(kCoreOffsetsC[0]);
+
+DeviceProbe::HwmonEntry hwmonEntry(int index) {
+  DeviceProbe::HwmonEntry entry{};
+  std::snprintf(entry.path, sizeof(entry.path), "%s%d", kSimRoot, index);
+  std::snprintf(entry.name, sizeof(entry.name), "%s", kHwmonNames[index]);
+  return entry;
+}
+}  // namespace
+
+DeviceProbe::Capabilities SimulatedSensorBackend::capabilities() {
+  DeviceProbe::Capabilities caps;
+  std::snprintf(caps.dmi.productName, sizeof(caps.dmi.productName), "Simulated FX705GE");
+  std::snprintf(caps.dmi.sysVendor, sizeof(caps.dmi.sysVendor), "fans-controller");
+  std::snprintf(caps.dmi.boardName, sizeof(caps.dmi.boardName), "ThermalPlant");
+
+  DeviceProbe::HwmonEntry core = hwmonEntry(kCoreTempHwmon);
+  core.tempMask = (1u << kCoreTemps) - 1;
+  DeviceProbe::HwmonEntry pch = hwmonEntry(kPchHwmon);
+  pch.tempMask = 1;
+  DeviceProbe::HwmonEntry asus = hwmonEntry(kAsusHwmon);
+  asus.fanMask = 1;
+  asus.pwmMask = 1;
+  asus.pwmWritableMask = 1;
+  asus.pwmEnableMask = 1;
+  caps.hwmons = {core, pch, asus};
+  return caps;
+}
+
+SimulatedSensorBackend::SimulatedSensorBackend(const ThermalPlant::Params &params)
+    : m_plant(params) {}
+
+SimulatedSensorBackend::Attribute SimulatedSensorBackend::decode(const QByteArray &path) {
+  Attribute attr;
+  int hwmon = -1;
+  char file[32] = {};
+  if (std::sscanf(path.constData(), "/sim/hwmon%d/%31s", &hwmon, file) != 2) {
+    return attr;
+  }
+  int channel = 0;
+  char suffix[16] = {};
+  if (std::strcmp(file, "name") == 0) {
+    attr = {Source::Name, hwmon};
+  } else if (std::sscanf(file, "temp%d_%15s", &channel, suffix) == 2 && channel >= 1) {
+    const bool label = std::strcmp(suffix, "label") == 0;
+    if (hwmon == kCoreTempHwmon && channel <= kCoreTemps) {
+      attr = {label ? Source::Label : Source::CoreTemp, channel - 1};
+    } else if (hwmon == kPchHwmon && channel == 1 && !label) {
+      attr = {Source::PchTemp, 0};
+    }
+  } else if (hwmon == kAsusHwmon && std::strcmp(file, "fan1_input") == 0) {
+    attr = {Source::FanRpm, 0};
+  } else if (hwmon == kAsusHwmon && std::strcmp(file, "pwm1") == 0) {
+    attr = {Source::Pwm, 0};
+  } else if (hwmon == kAsusHwmon && std::strcmp(file, "pwm1_enable") == 0) {
+    attr = {Source::PwmEnable, 0};
+  }
+  return attr;
+}
+
+int SimulatedSensorBackend::pwmRaw() const {
+  if (m_plant.mode() == ThermalPlant::FanMode::Manual) {
+    return m_manualPwm;
+  }
+  return static_cast<int>(std::lround(m_plant.dutyPercent() * kPwmMax / 100.0));
+}
+
+bool SimulatedSensorBackend::valueOf(const Attribute &attr, qint64 *value) const {
+  const ThermalPlant::Params &params = m_plant.params();
+  switch (attr.source) {
+    case Source::CoreTemp:
+      *value = std::llround((m_plant.dieC() - kCoreOffsetsC[attr.index]) * 1000.0);
+      return true;
+    case Source::PchTemp:
+      // PCH nam canh khoi tan nhiet: theo nhiet do tan nhiet, cham hon die.
+      *value = std::llround(
+          (params.ambientC + 0.35 * (m_plant.sinkC() - params.ambientC) + 6.0) * 1000.0);
+      return true;
+    case Source::FanRpm:
+      *value = std::llround(m_plant.rpm());
+      return true;
+    case Source::Pwm:
+      *value = pwmRaw();
+      return true;
+    case Source::PwmEnable:
+      *value = static_cast<int>(m_plant.mode());
+      return true;
+    case Source::Name:
+    case Source::Label:
+    case Source::Unknown:
+      break;
+  }
+  return false;
+}
+
+bool SimulatedSensorBackend::setAttributes(const QVector<QByteArray> &paths) {
+  m_attributes.clear();
+  m_attributes.reserve(paths.size());
+  for (const QByteArray &path : paths) {
+    m_attributes.append(decode(path));
+  }
+  return true;
+}
+
+bool SimulatedSensorBackend::readAll(QVector<RawReading> *out) {
+  out->resize(m_attributes.size());
+  for (qsizetype i = 0; i < m_attributes.size(); ++i) {
+    RawReading reading;
+    reading.ok = valueOf(m_attributes[i], &reading.value);
+    (*out)[i] = reading;
+  }
+  recordRefresh(0, 0.0);
+  return true;
+}
+
+bool SimulatedSensorBackend::readText(const QByteArray &path, QByteArray *out) {
+  const Attribute attr = decode(path);
+  out->clear();
+  if (attr.source == Source::Name && attr.index >= 0 && attr.index <= kAsusHwmon) {
+    *out = QByteArray(kHwmonNames[attr.index]) + '\n';
+    return true;
+  }
+  if (attr.source == Source::Label) {
+    *out = attr.index == 0 ? QByteArray("Package id 0\n")
+                           : "Core " + QByteArray::number(attr.index - 1) + '\n';
+    return true;
+  }
+  qint64 value = 0;
+  if (!valueOf(attr, &value)) {
+    return false;
+  }
+  *out = QByteArray::number(value) + '\n';
+  return true;
+}
+
+bool SimulatedSensorBackend::writeText(const QByteArray &path, const QByteArray &data) {
+  const Attribute attr = decode(path);
+  bool ok = false;
+  const int value = data.trimmed().toInt(&ok);
+  if (!ok) {
+    return false;
+  }
+  if (attr.source == Source::Pwm && value >= 0 && value <= kPwmMax) {
+    m_manualPwm = value;
+    m_plant.setManualDutyPercent(value * 100.0 / kPwmMax);
+    ++m_pwmWrites;
+    return true;
+  }
+  if (attr.source == Source::PwmEnable && value >= 0 && value <= 2) {
+    if (value == 1 && m_plant.mode() != ThermalPlant::FanMode::Manual) {
+      // Nhu EC that: chuyen sang manual giu nguyen duty dang chay.
+      m_manualPwm = pwmRaw();
+      m_plant.setManualDutyPercent(m_manualPwm * 100.0 / kPwmMax);
+    }
+    m_plant.setMode(static_cast<ThermalPlant::FanMode>(value));
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,52 @@
+#ifndef FANS_CONTROLLER_SIMULATED_SENSOR_BACKEND_H
+#define FANS_CONTROLLER_SIMULATED_SENSOR_BACKEND_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+#include "device_probe.h"
+#include "sensor_io_backend.h"
+#include "thermal_plant.h"
+
+// Backend gia lap sysfs tu ThermalPlant: TufGamingFx705ge dung nguyen ke hoach doc va
+// duong ghi PWM nhu tren may that, chi khac la cac duong dan /sim/hwmonN khong ton tai.
+//   /sim/hwmon0 (coretemp):       temp1 "Package id 0", temp2..5 "Core 0..3"
+//   /sim/hwmon1 (pch_cannonlake): temp1
+//   /sim/hwmon2 (asus):           fan1_input, pwm1, pwm1_enable (khong co pwm1_max -> 255)
+// Thoi gian khong tu troi: noi goi tien mo hinh bang advance() nen chay nhanh hon thuc.
+class SimulatedSensorBackend : public SensorIoBackend {
+ public:
+  // Manifest phan cung tuong ung voi cac duong dan gia lap o tren.
+  static DeviceProbe::Capabilities capabilities();
+
+  explicit SimulatedSensorBackend(const ThermalPlant::Params &params = ThermalPlant::Params());
+
+  const char *name() const override { return "simulated"; }
+  bool setAttributes(const QVector<QByteArray> &paths) override;
+  bool readAll(QVector<RawReading> *out) override;
+  bool readText(const QByteArray &path, QByteArray *out) override;
+  bool writeText(const QByteArray &path, const QByteArray &data) override;
+
+  void advance(double dtS, double powerW) { m_plant.step(dtS, powerW); }
+  const ThermalPlant &plant() const { return m_plant; }
+  quint64 pwmWrites() const { return m_pwmWrites; }
+
+ private:
+  enum class Source { Unknown, CoreTemp, PchTemp, FanRpm, Pwm, PwmEnable, Name, Label };
+  struct Attribute {
+    Source source = Source::Unknown;
+    int index = 0;  // Kenh temp (0 = package) hoac hwmon voi Name.
+  };
+
+  static Attribute decode(const QByteArray &path);
+  bool valueOf(const Attribute &attr, qint64 *value) const;
+  int pwmRaw() const;
+
+  ThermalPlant m_plant;
+  QVector<Attribute> m_attributes;
+  int m_manualPwm = 0;
+  quint64 m_pwmWrites = 0;
+};
+
+#endif  // FANS_CONTROLLER_SIMULATED_SENSOR_BACKEND_H
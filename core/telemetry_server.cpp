@@ -0,0 +1,96 @@
+#include "telemetry_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+constexpr int kListenBacklog = 128;
+
+QString errnoText(const char *what) {
+  return QString("%1: %2").arg(what, QString::fromLocal8Bit(std::strerror(errno)));
+}
+}  // namespace
+
+TelemetryServer::~TelemetryServer() {
+  close();
+}
+
+bool TelemetryServer::listen(const QByteArray &address, quint16 port, QString *error) {
+  close();
+  sockaddr_storage storage{};
+  socklen_t length = 0;
+  auto *v4 = reinterpret_cast<sockaddr_in *>(&storage);
+  auto *v6 = reinterpret_cast<sockaddr_in6 *>(&storage);
+  if (::inet_pton(AF_INET, address.constData(), &v4->sin_addr) == 1) {
+    v4->sin_family = AF_INET;
+    v4->sin_port = htons(port);
+    length = sizeof(sockaddr_in);
+  } else if (::inet_pton(AF_INET6, address.constData(), &v6->sin6_addr) == 1) {
+    v6->sin6_family = AF_INET6;
+    v6->sin6_port = htons(port);
+    length = sizeof(sockaddr_in6);
+  } else {
+    *error = QString("Dia chi lang nghe khong hop le: %1").arg(QString::fromLatin1(address));
+    return false;
+  }
+
+  m_listenFd = ::socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_listenFd < 0) {
+    *error = errnoText("Khong tao duoc socket TCP");
+    return false;
+  }
+  const int one = 1;
+  ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  if (::bind(m_listenFd, reinterpret_cast<sockaddr *>(&storage), length) != 0 ||
+      ::listen(m_listenFd, kListenBacklog) != 0) {
+    *error = errnoText(qPrintable(QString("Khong lang nghe duoc %1:%2")
+                                      .arg(QString::fromLatin1(address))
+                                      .arg(port)));
+    close();
+    return false;
+  }
+  m_stats = Stats();
+  return true;
+}
+
+void TelemetryServer::close() {
+  for (const int client : m_clients) {
+    ::close(client);
+  }
+  m_clients.clear();
+  if (m_listenFd >= 0) {
+    ::close(m_listenFd);
+    m_listenFd = -1;
+  }
+}
+
+void TelemetryServer::acceptPending() {
+  for (;;) {
+    const int client = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client < 0) {
+      return;  // EAGAIN: het ket noi cho; loi khac (EMFILE...) thu lai o lan sau.
+    }
+    m_clients.append(client);
+    ++m_stats.accepted;
+  }
+}
+
+void TelemetryServer::broadcast(const QByteArray &line) {
+  for (int i = m_clients.size() - 1; i >= 0; --i) {
+    const ssize_t sent = ::send(m_clients[i], line.constData(), static_cast<size_t>(line.size()),
+                                MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent == line.size()) {
+      m_stats.bytesSent += static_cast<quint64>(sent);
+      continue;
+    }
+    // Gui thieu mot phan se lam hong ranh gioi dong, nen coi nhu client cham va ngat.
+    ::close(m_clients[i]);
+    m_clients.removeAt(i);
+    ++m_stats.dropped;
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef FANS_CONTROLLER_TELEMETRY_SERVER_H
+#define FANS_CONTROLLER_TELEMETRY_SERVER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Phat snapshot JSON (moi dong mot object, cung dinh dang --watch --json) toi moi client
+// TCP dang ket noi, de FleetAggregator tren may khac gom lai. Chi mot chieu: client khong
+// gui gi. Socket non-blocking; client doc khong kip (bo dem gui day) bi ngat thay vi
+// de server phai giu hang doi, nen mot client cham khong lam cham vong lay mau.
+class TelemetryServer {
+ public:
+  struct Stats {
+    quint64 accepted = 0;
+    quint64 dropped = 0;  // Client bi ngat vi dong ket noi hoac doc khong kip.
+    quint64 bytesSent = 0;
+  };
+
+  TelemetryServer() = default;
+  ~TelemetryServer();
+  TelemetryServer(const TelemetryServer &) = delete;
+  TelemetryServer &operator=(const TelemetryServer &) = delete;
+
+  // address: IPv4/IPv6 dang so ("127.0.0.1", "0.0.0.0", "::"). Tra ve false kem ly do.
+  bool listen(const QByteArray &address, quint16 port, QString *error);
+  void close();
+  int fd() const { return m_listenFd; }
+
+  // Nhan het ket noi dang cho (goi khi fd() san sang doc).
+  void acceptPending();
+  // Gui line cho moi client; client loi/cham bi dong.
+  void broadcast(const QByteArray &line);
+
+  int clientCount() const { return m_clients.size(); }
+  Stats stats() const { return m_stats; }
+
+ private:
+  int m_listenFd = -1;
+  QVector<int> m_clients;
+  Stats m_stats;
+};
+
+#endif  // FANS_CONTROLLER_TELEMETRY_SERVER_H
@@ -0,0 +1,140 @@
+#include "thermal_plant.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// splitmix64: nhieu xac dinh, khong phu thuoc thu vien ngau nhien cua nen tang.
+quint64 mix(quint64 x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// So thuc trong [0, 1) tu mot gia tri bam.
+double unit(quint64 hash) {
+  return static_cast<double>(hash >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double interpolate(double x, double x0, double y0, double x1, double y1) {
+  if (x1 <= x0) {
+    return y1;
+  }
+  const double t = std::clamp((x - x0) / (x1 - x0), 0.0, 1.0);
+  return y0 + (y1 - y0) * t;
+}
+}  // namespace
+
+ThermalPlant::LoadProfile::LoadProfile(const QString &name, const QVector<Segment> &segments,
+                                       quint64 seed)
+    : m_name(name), m_segments(segments), m_seed(seed) {
+  for (const Segment &segment : m_segments) {
+    m_periodS += segment.seconds;
+  }
+}
+
+QStringList ThermalPlant::LoadProfile::builtinNames() {
+  return {"idle", "burst", "sustained", "gaming", "compile"};
+}
+
+bool ThermalPlant::LoadProfile::fromName(const QString &name, LoadProfile *profile) {
+  const QString lower = name.trimmed().toLower();
+  if (lower == "idle") {
+    *profile = LoadProfile(lower, {{60.0, 6.0, 2.0}});
+  } else if (lower == "burst") {
+    // Mo ung dung/trinh duyet: dot ngan cong suat cao xen ke nghi.
+    *profile = LoadProfile(lower, {{8.0, 85.0, 5.0}, {52.0, 8.0, 3.0}});
+  } else if (lower == "sustained") {
+    *profile = LoadProfile(lower, {{30.0, 8.0, 2.0}, {570.0, 90.0, 3.0}});
+  } else if (lower == "gaming") {
+    *profile = LoadProfile(lower, {{60.0, 60.0, 20.0}});
+  } else if (lower == "compile") {
+    *profile = LoadProfile(lower, {{120.0, 95.0, 8.0}, {20.0, 30.0, 10.0}, {40.0, 95.0, 8.0},
+                                   {60.0, 10.0, 3.0}});
+  } else {
+    return false;
+  }
+  return true;
+}
+
+ThermalPlant::LoadProfile ThermalPlant::LoadProfile::random(quint64 seed, double durationS) {
+  QVector<Segment> segments;
+  quint64 state = mix(seed);
+  double total = 0.0;
+  while (total < durationS) {
+    state = mix(state);
+    const double seconds = 5.0 + unit(state) * 115.0;
+    state = mix(state);
+    const double draw = unit(state);
+    // Phan lon thoi gian nhe tai, thinh thoang tai nang keo dai.
+    const double watts = draw < 0.5 ? 5.0 + draw * 20.0 : 15.0 + (draw - 0.5) * 170.0;
+    state = mix(state);
+    segments.append({seconds, std::min(watts, 100.0), unit(state) * 12.0});
+    total += seconds;
+  }
+  return LoadProfile(QString("random-%1").arg(seed), segments, seed);
+}
+
+double ThermalPlant::LoadProfile::powerAt(double timeS) const {
+  if (m_segments.isEmpty() || m_periodS <= 0.0) {
+    return 0.0;
+  }
+  double offset = std::fmod(std::max(0.0, timeS), m_periodS);
+  const Segment *current = &m_segments.last();
+  for (const Segment &segment : m_segments) {
+    if (offset < segment.seconds) {
+      current = &segment;
+      break;
+    }
+    offset -= segment.seconds;
+  }
+  // Nhieu doi moi 100 ms, giong dao dong tai cua tien trinh thuc.
+  const quint64 tick = static_cast<quint64>(timeS * 10.0);
+  const double noise = (unit(mix(m_seed ^ mix(tick))) * 2.0 - 1.0) * current->noiseWatts;
+  return std::max(0.0, current->watts + noise);
+}
+
+ThermalPlant::ThermalPlant() : ThermalPlant(Params()) {}
+
+ThermalPlant::ThermalPlant(const Params &params)
+    : m_params(params), m_dieC(params.ambientC + 5.0), m_sinkC(params.ambientC + 3.0) {}
+
+void ThermalPlant::setManualDutyPercent(double percent) {
+  m_manualDutyPercent = std::clamp(percent, 0.0, 100.0);
+}
+
+double ThermalPlant::autoDutyPercent() const {
+  return interpolate(m_dieC, m_params.autoLowC, m_params.autoLowPercent, m_params.autoHighC,
+                     m_params.autoHighPercent);
+}
+
+double ThermalPlant::dutyPercent() const {
+  switch (m_mode) {
+    case FanMode::FullSpeed:
+      return 100.0;
+    case FanMode::Manual:
+      return m_manualDutyPercent;
+    case FanMode::Auto:
+      break;
+  }
+  return autoDutyPercent();
+}
+
+void ThermalPlant::step(double dtS, double powerW) {
+  // Quat: vung stall co tre (hysteresis) va do tre RPM bac nhat.
+  const double duty = dutyPercent();
+  const bool stopped = m_rpm < m_params.rpmMax * 0.01;
+  const double threshold = stopped ? m_params.startPercent : m_params.stallPercent;
+  const double targetRpm = duty < threshold ? 0.0 : m_params.rpmMax * duty / 100.0;
+  m_rpm += (targetRpm - m_rpm) * (1.0 - std::exp(-dtS / m_params.rpmTimeConstantS));
+
+  m_throttling = m_dieC >= m_params.throttleC;
+  const double power = m_throttling ? powerW * m_params.throttleFactor : powerW;
+  const double airflow = std::pow(std::max(0.0, m_rpm) / m_params.rpmMax, 0.8);
+  const double dieToSinkW = (m_dieC - m_sinkC) / m_params.dieToSinkKPerW;
+  const double sinkToAirW = (m_sinkC - m_params.ambientC) *
+                            (m_params.sinkPassiveWPerK + m_params.sinkFanWPerK * airflow);
+  m_dieC += (power - dieToSinkW) / m_params.dieCapacityJPerK * dtS;
+  m_sinkC += (dieToSinkW - sinkToAirW) / m_params.sinkCapacityJPerK * dtS;
+}
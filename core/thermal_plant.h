@@ -0,0 +1,99 @@
+#ifndef FANS_CONTROLLER_THERMAL_PLANT_H
+#define FANS_CONTROLLER_THERMAL_PLANT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+// Mo hinh nhiet gop hai nut cua laptop (die CPU va khoi tan nhiet) dung de chinh
+// preset/duong cong quat ma khong can phan cung ASUS:
+//   C_die  dTj/dt  = P - (Tj - Ths) / R_die
+//   C_sink dThs/dt = (Tj - Ths) / R_die - (Ths - Tamb) * (G_passive + G_fan * (rpm/rpmMax)^0.8)
+// Quat co do tre RPM bac nhat, vung stall (duty thap thi dung, can duty cao hon de
+// khoi dong lai) va duong cong firmware khi pwm1_enable = 2. Tren nguong throttle,
+// CPU giam cong suat nhu PROCHOT.
+class ThermalPlant {
+ public:
+  struct Params {
+    double ambientC = 28.0;
+    double dieCapacityJPerK = 25.0;
+    double sinkCapacityJPerK = 350.0;
+    double dieToSinkKPerW = 0.35;
+    double sinkPassiveWPerK = 0.8;   // Doi luu tu nhien khi quat dung.
+    double sinkFanWPerK = 5.0;       // Them vao khi quat quay o rpmMax.
+    int rpmMax = 5400;
+    double rpmTimeConstantS = 1.5;
+    double stallPercent = 18.0;      // Duoi nguong nay quat dung han.
+    double startPercent = 28.0;      // Duty toi thieu de khoi dong lai tu trang thai dung.
+    double throttleC = 100.0;
+    double throttleFactor = 0.55;    // Ti le cong suat con lai khi throttle.
+    // Duong cong EC (pwm1_enable = 2): tuyen tinh giua hai diem, kep hai dau.
+    double autoLowC = 50.0;
+    double autoLowPercent = 25.0;
+    double autoHighC = 90.0;
+    double autoHighPercent = 100.0;
+  };
+
+  // Che do quat theo ABI hwmon pwmN_enable.
+  enum class FanMode { FullSpeed = 0, Manual = 1, Auto = 2 };
+
+  // Cong suat CPU theo thoi gian: cac doan lap lai tuan hoan, kem nhieu xac dinh theo seed.
+  class LoadProfile {
+   public:
+    struct Segment {
+      double seconds;
+      double watts;
+      double noiseWatts;
+    };
+
+    LoadProfile() = default;
+    LoadProfile(const QString &name, const QVector<Segment> &segments, quint64 seed = 0);
+
+    // "idle", "burst", "sustained", "gaming", "compile".
+    static QStringList builtinNames();
+    static bool fromName(const QString &name, LoadProfile *profile);
+
+    // Kich ban ngau nhien (tai tao duoc theo seed) dai durationS giay.
+    static LoadProfile random(quint64 seed, double durationS);
+
+    QString name() const { return m_name; }
+    double powerAt(double timeS) const;
+
+   private:
+    QString m_name;
+    QVector<Segment> m_segments;
+    double m_periodS = 0.0;
+    quint64 m_seed = 0;
+  };
+
+  ThermalPlant();
+  explicit ThermalPlant(const Params &params);
+
+  // Tien mo hinh dtS giay voi cong suat CPU yeu cau powerW (Euler hien, dt nho).
+  void step(double dtS, double powerW);
+
+  void setMode(FanMode mode) { m_mode = mode; }
+  FanMode mode() const { return m_mode; }
+  void setManualDutyPercent(double percent);
+
+  const Params &params() const { return m_params; }
+  double dieC() const { return m_dieC; }
+  double sinkC() const { return m_sinkC; }
+  double rpm() const { return m_rpm; }
+  double dutyPercent() const;  // Duty thuc te dang dat len quat (theo che do).
+  bool throttling() const { return m_throttling; }
+
+ private:
+  double autoDutyPercent() const;
+
+  Params m_params;
+  FanMode m_mode = FanMode::Auto;
+  double m_manualDutyPercent = 0.0;
+  double m_dieC;
+  double m_sinkC;
+  double m_rpm = 0.0;
+  bool m_throttling = false;
+};
+
+#endif  // FANS_CONTROLLER_THERMAL_PLANT_H
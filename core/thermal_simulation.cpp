@@ -0,0 +1,113 @@
+#include "thermal_simulation.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "simulated_sensor_backend.h"
+#include "tuf_gaming_fx705ge.h"
+
+QVector<ThermalSimulation::Result> ThermalSimulation::run(const Options &options) {
+  QVector<ThermalPlant::LoadProfile> loads;
+  for (const QString &name : options.profiles) {
+    ThermalPlant::LoadProfile load;
+    if (ThermalPlant::LoadProfile::fromName(name, &load)) {
+      loads.append(load);
+    }
+  }
+  if (options.profiles.isEmpty()) {
+    for (int i = 0; i < options.scenarios; ++i) {
+      loads.append(ThermalPlant::LoadProfile::random(options.seed + static_cast<quint64>(i),
+                                                     options.durationS));
+    }
+  }
+
+  QVector<Result> results;
+  for (const Policy &policy : options.policies) {
+    Result result;
+    result.policy = policy.name;
+    QElapsedTimer wall;
+    wall.start();
+    for (const ThermalPlant::LoadProfile &load : loads) {
+      const ScenarioResult scenario = runScenario(policy, load, options);
+      result.meanPeakC += scenario.peakC;
+      result.maxPeakC = std::max(result.maxPeakC, scenario.peakC);
+      result.meanSecondsAboveCritical += scenario.secondsAboveCritical;
+      result.meanThrottleSeconds += scenario.throttleSeconds;
+      result.meanFanEnergy += scenario.fanEnergy;
+      result.meanPwmWrites += static_cast<double>(scenario.pwmWrites);
+      result.simulatedSeconds += options.durationS;
+      ++result.scenarios;
+    }
+    result.wallSeconds = wall.nsecsElapsed() / 1e9;
+    if (result.scenarios > 0) {
+      const double n = result.scenarios;
+      result.meanPeakC /= n;
+      result.meanSecondsAboveCritical /= n;
+      result.meanThrottleSeconds /= n;
+      result.meanFanEnergy /= n;
+      result.meanPwmWrites /= n;
+    }
+    results.append(result);
+  }
+  return results;
+}
+
+ThermalSimulation::ScenarioResult ThermalSimulation::runScenario(
+    const Policy &policy, const ThermalPlant::LoadProfile &load, const Options &options) {
+  auto backend = std::make_unique<SimulatedSensorBackend>(options.plant);
+  SimulatedSensorBackend *sim = backend.get();  // Thuoc so huu cua device ben duoi.
+  TufGamingFx705ge device(SimulatedSensorBackend::capabilities(), std::move(backend));
+
+  const int channel = device.fanPwmChannel();
+  const qint64 stepMs = std::max<qint64>(1, std::llround(options.stepS * 1000.0));
+  const qint64 sampleMs = std::max<qint64>(stepMs, std::llround(options.sampleS * 1000.0));
+  const qint64 durationMs = std::llround(options.durationS * 1000.0);
+  const double stepS = stepMs / 1000.0;
+  const double rpmMax = options.plant.rpmMax;
+
+  PwmRamp ramp(options.rampRatePercentPerSecond);
+  int pwmMax = 0;
+  int lastPercent = -1;
+  ScenarioResult result;
+  for (qint64 nowMs = 0, nextSampleMs = 0; nowMs < durationMs; nowMs += stepMs) {
+    if (nowMs >= nextSampleMs) {
+      // Controller chi thay du lieu qua duong doc sensor nhu tren may that.
+      nextSampleMs += sampleMs;
+      device.refreshSensors();
+      if (policy.kind != Policy::Kind::FirmwareAuto) {
+        const int percent = policy.percentFor(device.cpuPackageTempC());
+        QString error;
+        if ((lastPercent < 0 || std::abs(percent - lastPercent) >= FanPolicy::kCurveDeadbandPercent) &&
+            device.preparePwmChannel(channel, &pwmMax, &error)) {
+          const int startPwm = ramp.contains(channel) ? 0 : device.readPwmRaw(channel);
+          ramp.setTarget(channel, static_cast<int>(percent / 100.0 * pwmMax), pwmMax, startPwm,
+                         nowMs);
+          lastPercent = percent;
+        }
+      }
+    }
+    while (ramp.isActive() && ramp.nextDeadlineMs() <= nowMs) {
+      const QVector<PwmRamp::Step> steps = ramp.advance(ramp.nextDeadlineMs());
+      QString error;
+      if (!steps.isEmpty()) {
+        device.writePwmSteps(steps, &error);
+      }
+    }
+
+    sim->advance(stepS, load.powerAt(nowMs / 1000.0));
+    const ThermalPlant &plant = sim->plant();
+    result.peakC = std::max(result.peakC, plant.dieC());
+    if (plant.dieC() >= options.criticalC) {
+      result.secondsAboveCritical += stepS;
+    }
+    if (plant.throttling()) {
+      result.throttleSeconds += stepS;
+    }
+    result.fanEnergy += std::pow(plant.rpm() / rpmMax, 3.0) * stepS;
+  }
+  result.pwmWrites = sim->pwmWrites();
+  return result;
+}
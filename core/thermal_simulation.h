@@ -0,0 +1,62 @@
+#ifndef FANS_CONTROLLER_THERMAL_SIMULATION_H
+#define FANS_CONTROLLER_THERMAL_SIMULATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include "fan_policy.h"
+#include "pwm_ramp.h"
+#include "thermal_plant.h"
+
+// Chay cac chinh sach quat (firmware auto, preset, duong cong nhiet do -> %) qua
+// TufGamingFx705ge + SimulatedSensorBackend tren nhieu kich ban tai, nhanh hon thoi gian
+// thuc, va tong hop chi so de so sanh/chinh preset ma khong can may ASUS.
+class ThermalSimulation {
+ public:
+  using Policy = FanPolicy;
+
+  struct Options {
+    int scenarios = 100;          // So kich ban ngau nhien khi profiles rong.
+    quint64 seed = 1;
+    double durationS = 600.0;     // Thoi gian mo phong moi kich ban.
+    double stepS = 0.05;          // Buoc tich phan mo hinh nhiet.
+    double sampleS = 1.0;         // Chu ky doc sensor va ra quyet dinh cua controller.
+    double criticalC = 90.0;      // Nguong tinh thoi gian qua nhiet.
+    double rampRatePercentPerSecond = PwmRamp::kDefaultRatePercentPerSecond;
+    QStringList profiles;         // Ten LoadProfile co san; rong = kich ban ngau nhien.
+    QVector<Policy> policies;
+    ThermalPlant::Params plant;
+  };
+
+  // Chi so trung binh tren moi kich ban cua mot chinh sach.
+  struct Result {
+    QString policy;
+    int scenarios = 0;
+    double meanPeakC = 0.0;
+    double maxPeakC = 0.0;
+    double meanSecondsAboveCritical = 0.0;
+    double meanThrottleSeconds = 0.0;
+    double meanFanEnergy = 0.0;   // Tich phan (rpm/rpmMax)^3 theo giay.
+    double meanPwmWrites = 0.0;
+    double simulatedSeconds = 0.0;
+    double wallSeconds = 0.0;
+  };
+
+  static QVector<Result> run(const Options &options);
+
+ private:
+  struct ScenarioResult {
+    double peakC = 0.0;
+    double secondsAboveCritical = 0.0;
+    double throttleSeconds = 0.0;
+    double fanEnergy = 0.0;
+    quint64 pwmWrites = 0;
+  };
+
+  static ScenarioResult runScenario(const Policy &policy, const ThermalPlant::LoadProfile &load,
+                                    const Options &options);
+};
+
+#endif  // FANS_CONTROLLER_THERMAL_SIMULATION_H
@@ -0,0 +1,147 @@
+#include "trace_replay.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <cmath>
+#include <cstdlib>
+
+#include "fan_policy.h"
+#include "sensor_trace.h"
+#include "tuf_gaming_fx705ge.h"
+
+bool TraceReplay::run(const QString &tracePath, const Options &options, Summary *summary,
+                      QString *error) {
+  std::unique_ptr<TraceReplayBackend> backend = TraceReplayBackend::open(tracePath, error);
+  if (!backend) {
+    return false;
+  }
+  TraceReplayBackend *replay = backend.get();  // Thuoc so huu cua device ben duoi.
+  replay->setSpeed(options.speed);
+  const DeviceProbe::Capabilities capabilities = replay->capabilities();
+  TufGamingFx705ge device(capabilities, std::move(backend));
+
+  const bool usePolicy = !options.policy.isEmpty();
+  FanPolicy policy;
+  if (usePolicy && !FanPolicy::parse(options.policy, &policy, error, device.model())) {
+    return false;
+  }
+
+  const int channel = device.fanPwmChannel();
+  const QByteArray pwmPath =
+      QFile::encodeName(device.fanHwmonPath() + QString("/pwm%1").arg(channel));
+  PwmRamp ramp(options.rampRatePercentPerSecond);
+  int pwmMax = 0;
+  int currentPwm = -1;  // Chua biet cho toi frame dau tien.
+  qint64 lastMs = -1;
+
+  *summary = Summary();
+  summary->policy = usePolicy ? policy.name : QString("recorded");
+  const auto integrate = [&](qint64 nowMs) {
+    if (lastMs >= 0 && pwmMax > 0 && currentPwm >= 0) {
+      summary->fanEnergy += std::pow(double(currentPwm) / pwmMax, 3.0) * (nowMs - lastMs) / 1e3;
+    }
+    lastMs = nowMs;
+  };
+  // Chay ramp toi moc nowMs, ghi tung lo buoc dung thoi diem nhu FanCommandActor.
+  const auto runRampUntil = [&](qint64 nowMs) {
+    while (ramp.isActive() && ramp.nextDeadlineMs() <= nowMs) {
+      const qint64 deadline = ramp.nextDeadlineMs();
+      const QVector<PwmRamp::Step> steps = ramp.advance(deadline);
+      if (steps.isEmpty()) {
+        continue;
+      }
+      integrate(deadline);
+      QString writeError;
+      device.writePwmSteps(steps, &writeError);
+      summary->pwmWrites += static_cast<quint64>(steps.size());
+      for (const PwmRamp::Step &step : steps) {
+        if (step.channel == channel) {
+          currentPwm = step.pwm;
+        }
+      }
+    }
+  };
+
+  // Dua setpoint moi vao ramp tai moc atMs (sau khi chay het cac buoc truoc moc).
+  const auto commandFan = [&](int percent, qint64 atMs) {
+    runRampUntil(atMs);
+    QString prepareError;
+    if (!device.preparePwmChannel(channel, &pwmMax, &prepareError)) {
+      return;
+    }
+    const int startPwm = ramp.contains(channel) ? 0 : qMax(currentPwm, 0);
+    const int targetPwm = static_cast<int>(qBound(0, percent, 100) / 100.0 * pwmMax);
+    ramp.setTarget(channel, targetPwm, pwmMax, startPwm, atMs);
+    ++summary->commands;
+  };
+
+  QElapsedTimer wall;
+  wall.start();
+  qint64 firstFrameMs = -1;
+  int recordedPercent = -1;  // Setpoint da ghi dang co hieu luc.
+  int policyPercent = -1;    // Setpoint chinh sach da gui gan nhat.
+  double deltaSum = 0.0;
+  for (;;) {
+    device.refreshSensors();
+    if (replay->finished()) {
+      break;
+    }
+    const qint64 frameMs = replay->frameTimeNs() / 1000000;
+    if (firstFrameMs < 0) {
+      firstFrameMs = frameMs;
+    }
+    if (currentPwm < 0 && !device.fanHwmonPath().isEmpty()) {
+      currentPwm = device.readPwmRaw(channel);
+    }
+
+    for (const TraceReplayBackend::Annotation &note : replay->takeAnnotations()) {
+      if (note.key != TufGamingFx705ge::kFanTargetAnnotation) {
+        continue;
+      }
+      recordedPercent = static_cast<int>(qBound<qint64>(0, note.value, 100));
+      ++summary->recordedCommands;
+      if (!usePolicy) {
+        commandFan(recordedPercent, note.timeNs / 1000000);
+      }
+    }
+
+    // Sensor loi thi giu setpoint hien tai, nhu MainWindow::applyRuleCurve().
+    const TufGamingFx705ge::TemperatureSample cpuPackage = device.cpuPackageTemperature();
+    if (usePolicy && cpuPackage.valid) {
+      const int percent = policy.percentFor(cpuPackage.celsius);
+      const int deadband = policy.kind == FanPolicy::Kind::Curve
+                               ? FanPolicy::kCurveDeadbandPercent
+                               : 1;
+      if (percent >= 0 && (policyPercent < 0 || std::abs(percent - policyPercent) >= deadband)) {
+        policyPercent = percent;
+        commandFan(percent, frameMs);
+      }
+    }
+    if (usePolicy && policyPercent >= 0 && recordedPercent >= 0) {
+      deltaSum += std::abs(policyPercent - recordedPercent);
+      ++summary->setpointFrames;
+    }
+
+    runRampUntil(frameMs);
+    integrate(frameMs);
+    if (cpuPackage.valid) {
+      summary->peakCpuPackageC = qMax(summary->peakCpuPackageC, cpuPackage.celsius);
+    }
+    summary->traceSeconds = (frameMs - firstFrameMs) / 1e3;
+    ++summary->frames;
+  }
+  summary->wallSeconds = wall.nsecsElapsed() / 1e9;
+  if (summary->setpointFrames > 0) {
+    summary->meanSetpointDeltaPercent = deltaSum / summary->setpointFrames;
+  }
+
+  if (pwmMax <= 0 && !device.fanHwmonPath().isEmpty()) {
+    QString prepareError;
+    device.preparePwmChannel(channel, &pwmMax, &prepareError);
+  }
+  const TraceReplayBackend::RecordedControl recorded = replay->recordedControl(pwmPath, pwmMax);
+  summary->recordedPwmWrites = recorded.pwmWrites;
+  summary->recordedFanEnergy = recorded.fanEnergy;
+  return true;
+}
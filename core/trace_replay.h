@@ -0,0 +1,47 @@
+#ifndef FANS_CONTROLLER_TRACE_REPLAY_H
+#define FANS_CONTROLLER_TRACE_REPLAY_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include "pwm_ramp.h"
+
+// Chay lai mot trace (TraceReplayBackend) qua TufGamingFx705ge va duong dieu khien hien
+// tai: moi setpoint quat da ghi (annotate "fan_target_percent") duoc dua vao PwmRamp
+// theo thoi gian trong trace, cac buoc ramp ghi qua writePwmSteps() nhu FanCommandActor.
+// Voi Options::policy, setpoint duoc tinh lai tu nhiet do phat lai bang FanPolicy (cung
+// deadband nhu GUI) thay cho setpoint da ghi, de so chinh sach moi voi lan chay goc.
+// Ket qua dung de so sanh cac phien ban controller tren cung du lieu nhiet that.
+class TraceReplay {
+ public:
+  struct Summary {
+    QString policy;                // Chinh sach da dung; "recorded" = setpoint trong trace.
+    quint64 frames = 0;            // So lan refreshSensors() da phat lai.
+    quint64 commands = 0;          // So setpoint quat da dua vao ramp.
+    double traceSeconds = 0.0;     // Do dai trace (thoi gian ghi).
+    double wallSeconds = 0.0;      // Thoi gian phat lai thuc te.
+    double peakCpuPackageC = 0.0;
+    quint64 pwmWrites = 0;         // So lan ghi pwmN cua controller hien tai.
+    double fanEnergy = 0.0;        // Tich phan (pwm/pwm_max)^3 theo giay (luat quat).
+    quint64 recordedCommands = 0;  // Cung chi so cua lan chay goc, de doi chieu.
+    quint64 recordedPwmWrites = 0;
+    double recordedFanEnergy = 0.0;
+    // Trung binh |setpoint chinh sach - setpoint da ghi| (%) tren cac frame co ca hai;
+    // setpointFrames = 0 khi khong dung policy hoac trace khong co setpoint.
+    double meanSetpointDeltaPercent = 0.0;
+    quint64 setpointFrames = 0;
+  };
+
+  struct Options {
+    double speed = 0.0;  // 1 = thoi gian thuc, 1000 = nhanh 1000 lan, <= 0 = nhanh nhat.
+    double rampRatePercentPerSecond = PwmRamp::kDefaultRatePercentPerSecond;
+    // Rong: phat lai setpoint da ghi; khac: spec FanPolicy::parse() (preset theo model
+    // cua trace), vd. "silent", "safe", "curve:50:20:90:100".
+    QString policy;
+  };
+
+  static bool run(const QString &tracePath, const Options &options, Summary *summary,
+                  QString *error);
+};
+
+#endif  // FANS_CONTROLLER_TRACE_REPLAY_H
@@ -1,184 +1,393 @@
 #include "tuf_gaming_fx705ge.h"
 
+#include "sensor_trace.h"
+
 namespace {
-// Ten file thuong dung cho hwmon ASUS tren FX705GE (tham khao file report).
-const QString kHwmonBase = "/sys/class/hwmon";
-const QStringList kAsusNeedles = {"asus", "asus-nb-wmi"};
-const QStringList kCoreTempNeedles = {"coretemp"};
-const QStringList kPchNeedles = {"pch", "pch_cannonlake"};
-const QStringList kNvmeNeedles = {"nvme"};
-const QStringList kAcpiNeedles = {"acpitz", "acpi"};
+// Gioi han su kien loi cho khi khong ai goi takeSensorFaultEvents() (vd. --once).
+constexpr int kMaxFaultEvents = 128;
+
+QString pathOf(const DeviceProbe::HwmonEntry *hwmon) {
+  return hwmon ? QString::fromUtf8(hwmon->path) : QString();
+}
+
+QStringList needleList(const ModelProfile::Needles &needles) {
+  QStringList list;
+  for (const char *needle : needles) {
+    if (needle) {
+      list.append(QString::fromLatin1(needle));
+    }
+  }
+  return list;
+}
 }  // namespace
 
-TufGamingFx705ge::TufGamingFx705ge() {
-  loadMockData();
+TufGamingFx705ge::TufGamingFx705ge(SensorIoBackend::Kind ioBackend)
+    : m_capabilities(DeviceProbe::load()),
+      m_model(ModelProfile::select(m_capabilities.dmi.productName)),
+      m_asusHwmonPath(pathOf(findHwmonByName(m_model.fanHwmon))),
+      m_backend(TraceRecordingBackend::wrapIfRequested(SensorIoBackend::create(ioBackend),
+                                                       m_capabilities)) {
+  buildSensorPlan();
+  loadMockData(&m_readings);
+}
+
+TufGamingFx705ge::TufGamingFx705ge(const DeviceProbe::Capabilities &capabilities,
+                                   std::unique_ptr<SensorIoBackend> backend)
+    : m_capabilities(capabilities),
+      m_model(ModelProfile::select(m_capabilities.dmi.productName)),
+      m_asusHwmonPath(pathOf(findHwmonByName(m_model.fanHwmon))),
+      m_backend(std::move(backend)) {
+  buildSensorPlan();
+  loadMockData(&m_readings);
 }
 
 bool TufGamingFx705ge::refreshSensors() {
   // Thu doc thuc te; neu that bai thi mock 0.0 de khong gay nham lan.
-  m_lastError.clear();
-  loadFromSysfs();
+  QMutexLocker ioLock(&m_ioMutex);
+  Readings readings;
+  {
+    QMutexLocker stateLock(&m_stateMutex);
+    readings.fan.percent = m_readings.fan.percent;  // Giu % khi khong doc duoc pwm1.
+  }
+  loadFromSysfs(&readings);
+  readings.faults = m_detector.activeFaults();
+  const QVector<SensorAnomalyDetector::Event> events = m_detector.takeEvents();
+
+  QMutexLocker stateLock(&m_stateMutex);
+  m_readings = std::move(readings);
+  m_ioStats = m_backend->stats();
+  m_faultEvents += events;
+  if (m_faultEvents.size() > kMaxFaultEvents) {
+    m_faultEvents.remove(0, m_faultEvents.size() - kMaxFaultEvents);
+  }
   return true;
 }
 
+QString TufGamingFx705ge::fanHwmonPath() const {
+  return m_asusHwmonPath;
+}
+
+QString TufGamingFx705ge::cpuPackageTempPath() const {
+  return m_cpuPackageTempPath;
+}
+
+QString TufGamingFx705ge::ioBackendName() const {
+  return QString::fromLatin1(m_backend->name());
+}
+
+SensorIoBackend::Stats TufGamingFx705ge::ioStats() const {
+  QMutexLocker lock(&m_stateMutex);
+  return m_ioStats;
+}
+
 double TufGamingFx705ge::cpuPackageTempC() const {
-  return m_cpuPackage.celsius;
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.cpuPackage.celsius;
 }
 
 double TufGamingFx705ge::pchTempC() const {
-  return m_pch.celsius;
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.pch.celsius;
+}
+
+TufGamingFx705ge::TemperatureSample TufGamingFx705ge::cpuPackageTemperature() const {
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.cpuPackage;
+}
+
+TufGamingFx705ge::TemperatureSample TufGamingFx705ge::pchTemperature() const {
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.pch;
 }
 
 TufGamingFx705ge::FanSample TufGamingFx705ge::fan() const {
-  return m_fan;
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.fan;
 }
 
 QVector<TufGamingFx705ge::TemperatureSample> TufGamingFx705ge::detailTemperatures() const {
-  return m_details;
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.details;
 }
 
-bool TufGamingFx705ge::setFixedFanPercent(int percent) {
-  const int clamped = std::clamp(percent, 0, 100);
-  m_lastError.clear();
+QString TufGamingFx705ge::lastError() const {
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.lastError;
+}
 
-  // Neu chua biet duong dan ASUS, co gang tim lai.
-  if (m_asusHwmonPath.isEmpty()) {
-    m_asusHwmonPath = findHwmonByName(kAsusNeedles);
-  }
+QVector<SensorAnomalyDetector::Event> TufGamingFx705ge::sensorFaults() const {
+  QMutexLocker lock(&m_stateMutex);
+  return m_readings.faults;
+}
+
+QVector<SensorAnomalyDetector::Event> TufGamingFx705ge::takeSensorFaultEvents() {
+  QMutexLocker lock(&m_stateMutex);
+  QVector<SensorAnomalyDetector::Event> events;
+  events.swap(m_faultEvents);
+  return events;
+}
+
+void TufGamingFx705ge::noteFanTarget(int percent) {
+  QMutexLocker ioLock(&m_ioMutex);
+  m_backend->annotate(kFanTargetAnnotation, percent);
+}
 
+bool TufGamingFx705ge::preparePwmChannel(int channel, int *pwmMax, QString *error) {
+  QMutexLocker ioLock(&m_ioMutex);
   if (m_asusHwmonPath.isEmpty()) {
     // Khong co hwmon ASUS -> khong the dieu khien.
-    m_fan.percent = clamped;
-    m_fan.rpm = 0;
-    m_lastError = "Khong tim thay hwmon ASUS (asus / asus-nb-wmi).";
+    *error = QString("Khong tim thay hwmon quat (%1).")
+                 .arg(needleList(m_model.fanHwmon).join(" / "));
     return false;
   }
-
   // Dat che do manual truoc khi ghi PWM.
-  if (!writePwmEnableManual(m_asusHwmonPath)) {
-    m_fan.percent = clamped;
-    m_lastError = "Khong ghi duoc pwm1_enable (yeu cau quyen root hoac pwm1_enable ton tai).";
+  if (!writePwmEnableManual(m_asusHwmonPath, channel)) {
+    *error = QString("Khong ghi duoc pwm%1_enable (yeu cau quyen root hoac pwm%1_enable ton tai).")
+                 .arg(channel);
     return false;
   }
-
-  const int pwmMax = readPwmMax(m_asusHwmonPath);
-  if (pwmMax <= 0) {
-    m_fan.percent = clamped;
-    m_lastError = "Khong doc duoc pwm1_max hop le.";
+  *pwmMax = readPwmMax(m_asusHwmonPath, channel);
+  if (*pwmMax <= 0) {
+    *error = QString("Khong doc duoc pwm%1_max hop le.").arg(channel);
     return false;
   }
+  if (channel == m_model.fanPwmChannel) {
+    QMutexLocker stateLock(&m_stateMutex);
+    m_fanPwmMax = *pwmMax;
+  }
+  return true;
+}
 
-  const int pwmValue = static_cast<int>(clamped / 100.0 * pwmMax);
-  if (!writePwmValue(m_asusHwmonPath, pwmValue)) {
-    m_fan.percent = clamped;
-    m_lastError = "Khong ghi duoc pwm1 (yeu cau quyen root hoac tep khong ghi duoc).";
-    return false;
+bool TufGamingFx705ge::writePwmSteps(const QVector<PwmRamp::Step> &steps, QString *error) {
+  {
+    // Mot lan giu khoa cho ca lo buoc de refresh khong chen vao giua cac kenh.
+    QMutexLocker ioLock(&m_ioMutex);
+    for (const PwmRamp::Step &step : steps) {
+      if (!writePwmValue(m_asusHwmonPath, step.channel, step.pwm)) {
+        *error = QString("Khong ghi duoc pwm%1 (yeu cau quyen root hoac tep khong ghi duoc).")
+                     .arg(step.channel);
+        return false;
+      }
+    }
   }
 
-  // Cap nhat cache: doc lai rpm neu co.
-  m_fan.percent = clamped;
-  m_fan.rpm = readFanRpm(m_asusHwmonPath);
-  m_lastError.clear();
+  // Cache % theo buoc vua ghi de UI/CLI thay duoc tien trinh ramp.
+  QMutexLocker stateLock(&m_stateMutex);
+  for (const PwmRamp::Step &step : steps) {
+    if (step.channel == m_model.fanPwmChannel && m_fanPwmMax > 0) {
+      m_readings.fan.percent = qRound(step.pwm * 100.0 / m_fanPwmMax);
+    }
+  }
   return true;
 }
 
-bool TufGamingFx705ge::applyPresetMode(const QString &presetName) {
-  // Map preset sang % co dinh.
+int TufGamingFx705ge::readPwmRaw(int channel) {
+  QMutexLocker ioLock(&m_ioMutex);
+  return m_asusHwmonPath.isEmpty() ? 0 : readPwmValue(m_asusHwmonPath, channel);
+}
+
+int TufGamingFx705ge::readFanRpmNow() {
+  QMutexLocker ioLock(&m_ioMutex);
+  const auto *asus = findHwmonByName(m_model.fanHwmon);
+  return asus ? readFanRpm(*asus) : 0;
+}
+
+int TufGamingFx705ge::presetPercent(const QString &presetName, const ModelProfile &model) {
+  // Map preset sang % co dinh cua profile.
   if (presetName.compare("Silent", Qt::CaseInsensitive) == 0) {
-    return setFixedFanPercent(30);
+    return model.silentPercent;
   }
   if (presetName.compare("Performance", Qt::CaseInsensitive) == 0) {
-    return setFixedFanPercent(65);
+    return model.performancePercent;
   }
   if (presetName.compare("Turbo", Qt::CaseInsensitive) == 0) {
-    return setFixedFanPercent(85);
+    return model.turboPercent;
   }
-  // Custom: giu nguyen gia tri hien tai.
-  return true;
+  return -1;
 }
 
-void TufGamingFx705ge::loadFromSysfs() {
-  // Reset cache truoc khi doc lai.
-  m_cpuPackage = {"CPU Package", 0.0};
-  m_pch = {"PCH", 0.0};
-  m_fan = {0, m_fan.percent};
-  m_details.clear();
-  bool anySensor = false;
-
-  // 1) Coretemp: CPU package + cac core chi tiet.
-  const QString corePath = findHwmonByName(kCoreTempNeedles);
-  if (!corePath.isEmpty()) {
-    const auto temps = readTemps(corePath);
-    for (const auto &t : temps) {
-      anySensor = true;
-      if (t.label.contains("Package", Qt::CaseInsensitive) ||
-          t.label.contains("id 0", Qt::CaseInsensitive)) {
-        m_cpuPackage = {"CPU Package", t.celsius};
+void TufGamingFx705ge::buildSensorPlan() {
+  // Xac dinh mot lan danh sach thuoc tinh can doc moi refresh (kem nhan va vai tro),
+  // de refresh chi con mot lan doc hang loat qua backend, khong so khop chuoi.
+  QVector<QByteArray> paths;
+  const auto addAttribute = [&](AttributeRole role, const QString &hwmonPath,
+                                const QString &file, const QString &label, int flags) {
+    m_plan.append({role, label, flags});
+    if (role == AttributeRole::Temperature) {
+      // Kenh CPU package/PCH mang ten cua the thong ke de UI gan loi dung the.
+      const QString faultLabel = (flags & kCpuPackage) ? QString("CPU Package")
+                                 : (flags & kPchTemp)  ? QString("PCH")
+                                                       : label;
+      m_plan.last().detectorChannel =
+          m_detector.addChannel(SensorAnomalyDetector::ChannelKind::Temperature, faultLabel);
+    }
+    paths.append(QFile::encodeName(hwmonPath + "/" + file));
+  };
+  const auto addTemps = [&](const DeviceProbe::HwmonEntry &hwmon, int maxCount,
+                            const QString &fixedLabel, int flags) {
+    const QString hwmonPath = QString::fromUtf8(hwmon.path);
+    int added = 0;
+    for (int i = 0; i < DeviceProbe::kMaxChannels && added < maxCount; ++i) {
+      if (!(hwmon.tempMask & (1u << i))) {
+        continue;
+      }
+      const QString baseName = QString("temp%1").arg(i + 1);
+      QString label = fixedLabel;
+      if (label.isEmpty()) {
+        const QString labelRaw = readTextFile(hwmonPath + "/" + baseName + "_label");
+        label = labelRaw.isEmpty() ? baseName : labelRaw;
+      } else if (label.contains("%1")) {
+        label = label.arg(added + 1);
+      }
+      int attrFlags = flags;
+      if (flags & kCoreTemp) {
+        for (const char *needle : m_model.packageLabels) {
+          if (needle && label.contains(QString::fromLatin1(needle), Qt::CaseInsensitive)) {
+            attrFlags |= kCpuPackage;
+            break;
+          }
+        }
       }
-      m_details.append(t);
+      addAttribute(AttributeRole::Temperature, hwmonPath, baseName + "_input", label, attrFlags);
+      if ((attrFlags & kCpuPackage) && m_cpuPackageTempPath.isEmpty()) {
+        m_cpuPackageTempPath = hwmonPath + "/" + baseName + "_input";
+      }
+      ++added;
     }
-  }
+  };
 
-  // 2) PCH.
-  const QString pchPath = findHwmonByName(kPchNeedles);
-  if (!pchPath.isEmpty()) {
-    const auto temps = readTemps(pchPath);
-    if (!temps.isEmpty()) {
-      anySensor = true;
-      m_pch = {"PCH", temps.first().celsius};
-      m_details.append(temps.first());
-    }
+  // 1) Coretemp/k10temp: CPU package + cac core chi tiet.
+  if (const auto *core = findHwmonByName(m_model.cpuHwmon)) {
+    addTemps(*core, DeviceProbe::kMaxChannels, QString(), kCoreTemp);
+  }
+  // 2) PCH: chi lay kenh dau tien.
+  if (const auto *pch = findHwmonByName(m_model.pchHwmon)) {
+    addTemps(*pch, 1, QString(), kPchTemp);
   }
-
   // 3) NVMe (bo sung vao details).
-  const QString nvmePath = findHwmonByName(kNvmeNeedles);
-  if (!nvmePath.isEmpty()) {
-    const auto temps = readTemps(nvmePath);
-    for (const auto &t : temps) {
-      anySensor = true;
-      m_details.append({"NVMe Drive", t.celsius});
+  if (const auto *nvme = findHwmonByName(m_model.nvmeHwmon)) {
+    addTemps(*nvme, DeviceProbe::kMaxChannels, "NVMe Drive", 0);
+  }
+  // 4) ACPI zones (acpitz) neu co.
+  if (const auto *acpi = findHwmonByName(m_model.acpiHwmon)) {
+    addTemps(*acpi, DeviceProbe::kMaxChannels, "ACPI Zone %1", 0);
+  }
+  // 5) ASUS fan/pwm.
+  if (const auto *asus = findHwmonByName(m_model.fanHwmon)) {
+    for (int i = 0; i < DeviceProbe::kMaxChannels; ++i) {
+      if (asus->fanMask & (1u << i)) {
+        const QString label = QString("Fan %1").arg(i + 1);
+        addAttribute(AttributeRole::FanInput, m_asusHwmonPath, QString("fan%1_input").arg(i + 1),
+                     label, 0);
+        if (i + 1 == m_model.fanPwmChannel) {
+          // Chi fanN cung kenh voi pwmN moi so duoc RPM voi PWM.
+          m_plan.last().detectorChannel =
+              m_detector.addChannel(SensorAnomalyDetector::ChannelKind::Fan, label);
+        }
+      }
     }
+    addAttribute(AttributeRole::PwmValue, m_asusHwmonPath,
+                 QString("pwm%1").arg(m_model.fanPwmChannel), QString(), 0);
+    addAttribute(AttributeRole::PwmMax, m_asusHwmonPath,
+                 QString("pwm%1_max").arg(m_model.fanPwmChannel), QString(), 0);
   }
 
-  // 4) ACPI zones (acpitz) neu co.
-  const QString acpiPath = findHwmonByName(kAcpiNeedles);
-  if (!acpiPath.isEmpty()) {
-    const auto temps = readTemps(acpiPath);
-    int idx = 1;
-    for (const auto &t : temps) {
-      anySensor = true;
-      m_details.append({QString("ACPI Zone %1").arg(idx++), t.celsius});
+  if (!m_backend->setAttributes(paths)) {
+    // Vd. kernel cu khong cho dang ky fd rong vao io_uring: lui ve doc tuan tu.
+    m_backend = SensorIoBackend::create(SensorIoBackend::Kind::Plain);
+    m_backend->setAttributes(paths);
+  }
+}
+
+void TufGamingFx705ge::loadFromSysfs(Readings *readings) {
+  // Reset cache truoc khi doc lai.
+  readings->cpuPackage = {"CPU Package", 0.0};
+  readings->pch = {"PCH", 0.0};
+  readings->fan.rpm = 0;
+  readings->details.clear();
+  readings->details.reserve(m_plan.size());
+  readings->lastError.clear();
+
+  // Loi giua chung: chi so chua doc co ok = false nen kenh do bao khong hop le thay vi
+  // lap lai gia tri cu.
+  const bool readOk = m_backend->readAll(&m_rawReadings);
+  m_rawReadings.resize(m_plan.size());
+  m_detector.beginSample();
+
+  bool anySensor = !m_asusHwmonPath.isEmpty();
+  bool haveRpm = false;
+  int fanChannel = -1;
+  SensorIoBackend::RawReading fanRpm;
+  SensorIoBackend::RawReading pwmValue;
+  SensorIoBackend::RawReading pwmMax;
+  for (qsizetype i = 0; i < m_plan.size(); ++i) {
+    const SensorAttribute &attr = m_plan[i];
+    const SensorIoBackend::RawReading &raw = m_rawReadings[i];
+    switch (attr.role) {
+      case AttributeRole::Temperature: {
+        anySensor = true;
+        const double celsius = celsiusFromMilli(raw);
+        if (attr.flags & kCpuPackage) {
+          readings->cpuPackage = {"CPU Package", celsius, raw.ok};
+        }
+        if (attr.flags & kPchTemp) {
+          readings->pch = {"PCH", celsius, raw.ok};
+        }
+        readings->details.append({attr.label, celsius, raw.ok});
+        m_detector.sampleTemperature(attr.detectorChannel, raw.ok, celsius);
+        break;
+      }
+      case AttributeRole::FanInput:
+        // Lay kenh fan*_input dau tien doc duoc.
+        if (!haveRpm && raw.ok) {
+          readings->fan.rpm = static_cast<int>(raw.value);
+          readings->fan.rpmValid = true;
+          haveRpm = true;
+        }
+        if (attr.detectorChannel >= 0) {
+          fanChannel = attr.detectorChannel;
+          fanRpm = raw;
+        }
+        break;
+      case AttributeRole::PwmValue:
+        pwmValue = raw;
+        break;
+      case AttributeRole::PwmMax:
+        pwmMax = raw;
+        break;
     }
   }
 
-  // 5) ASUS fan/pwm.
-  m_asusHwmonPath = findHwmonByName(kAsusNeedles);
   if (!m_asusHwmonPath.isEmpty()) {
-    m_fan.rpm = readFanRpm(m_asusHwmonPath);
-
-    const int pwmMax = readPwmMax(m_asusHwmonPath);
-    const int pwmVal = readPwmValue(m_asusHwmonPath);
-    if (pwmMax > 0) {
-      m_fan.percent = qRound(pwmVal * 100.0 / pwmMax);
-    } else {
-      m_fan.percent = 0;
+    // Fallback theo profile (255) neu khong co file pwmN_max.
+    const qint64 maxVal = (pwmMax.ok && pwmMax.value > 0) ? pwmMax.value : m_model.pwmMaxFallback;
+    readings->fan.percent = qRound((pwmValue.ok ? pwmValue.value : 0) * 100.0 / maxVal);
+    if (fanChannel >= 0) {
+      m_detector.sampleFan(fanChannel, fanRpm.ok, static_cast<int>(fanRpm.value), pwmValue.ok,
+                           readings->fan.percent);
     }
-    anySensor = true;
   }
 
-  // 6) Neu thieu du lieu chinh, dung mock an toan.
+  if (!readOk) {
+    readings->lastError =
+        QString("Doc sysfs (backend %1) that bai giua chung; sensor chua doc duoc bi danh "
+                "dau khong hop le.")
+            .arg(QString::fromLatin1(m_backend->name()));
+  }
+
+  // Neu thieu du lieu chinh, dung mock an toan.
   if (!anySensor) {
-    loadMockData();
-    m_lastError = "Khong doc duoc sensor tu sysfs (co the thieu quyen hoac thieu hwmon).";
+    loadMockData(readings);
+    readings->lastError = "Khong doc duoc sensor tu sysfs (co the thieu quyen hoac thieu hwmon).";
   }
 }
 
-void TufGamingFx705ge::loadMockData() {
+void TufGamingFx705ge::loadMockData(Readings *readings) {
   // Du lieu an toan, tranh hieu nham khi khong doc duoc sysfs.
-  m_cpuPackage = {"CPU Package", 0.0};
-  m_pch = {"PCH", 0.0};
-  m_fan = {0, 0};
-  m_details = {
+  readings->cpuPackage = {"CPU Package", 0.0};
+  readings->pch = {"PCH", 0.0};
+  readings->fan = {0, 0};
+  readings->details = {
       {"CPU Core 1", 0.0},
       {"CPU Core 2", 0.0},
       {"NVMe Drive", 0.0},
@@ -188,41 +397,19 @@ void TufGamingFx705ge::loadMockData() {
   };
 }
 
-QString TufGamingFx705ge::findHwmonByName(const QStringList &needles) const {
-  QDir hwmonDir(kHwmonBase);
-  const auto dirs = hwmonDir.entryList(QStringList() << "hwmon*", QDir::Dirs | QDir::NoDotAndDotDot);
-  for (const QString &d : dirs) {
-    const QString path = hwmonDir.filePath(d);
-    const QString name = readTextFile(path + "/name").toLower();
-    for (const QString &needle : needles) {
-      if (name.contains(needle.toLower())) {
-        return path;
-      }
-    }
-  }
-  return {};
-}
-
-QVector<TufGamingFx705ge::TemperatureSample> TufGamingFx705ge::readTemps(const QString &hwmonPath) const {
-  QVector<TemperatureSample> result;
-  QDir dir(hwmonPath);
-  const QStringList files = dir.entryList(QStringList() << "temp*_input", QDir::Files);
-  for (const QString &f : files) {
-    const QString baseName = f.left(f.indexOf("_input"));
-    const QString labelPath = dir.filePath(baseName + "_label");
-    const QString labelRaw = readTextFile(labelPath);
-    const QString label = labelRaw.isEmpty() ? baseName : labelRaw;
-    const QString raw = readTextFile(dir.filePath(f));
-    result.append({label, parseTempMilli(raw)});
-  }
-  return result;
+const DeviceProbe::HwmonEntry *TufGamingFx705ge::findHwmonByName(
+    const ModelProfile::Needles &needles) const {
+  // Profile khong co loai hwmon nay (vd. PCH tren may AMD).
+  return needles[0] ? DeviceProbe::findHwmon(m_capabilities, needleList(needles)) : nullptr;
 }
 
-int TufGamingFx705ge::readFanRpm(const QString &hwmonPath) const {
-  QDir dir(hwmonPath);
-  const QStringList files = dir.entryList(QStringList() << "fan*_input", QDir::Files);
-  for (const QString &f : files) {
-    const QString raw = readTextFile(dir.filePath(f));
+int TufGamingFx705ge::readFanRpm(const DeviceProbe::HwmonEntry &hwmon) const {
+  const QString hwmonPath = QString::fromUtf8(hwmon.path);
+  for (int i = 0; i < DeviceProbe::kMaxChannels; ++i) {
+    if (!(hwmon.fanMask & (1u << i))) {
+      continue;
+    }
+    const QString raw = readTextFile(hwmonPath + QString("/fan%1_input").arg(i + 1));
     bool ok = false;
     int rpm = raw.toInt(&ok);
     if (ok) {
@@ -232,70 +419,56 @@ int TufGamingFx705ge::readFanRpm(const QString &hwmonPath) const {
   return 0;
 }
 
-int TufGamingFx705ge::readPwmMax(const QString &hwmonPath) const {
-  const QString maxPath = hwmonPath + "/pwm1_max";
+int TufGamingFx705ge::readPwmMax(const QString &hwmonPath, int channel) const {
+  const QString maxPath = hwmonPath + QString("/pwm%1_max").arg(channel);
   const QString rawMax = readTextFile(maxPath);
   bool ok = false;
   int maxVal = rawMax.toInt(&ok);
   if (ok && maxVal > 0) {
     return maxVal;
   }
-  // Fallback mac dinh 255 neu khong co file pwm1_max.
-  return 255;
+  // Fallback theo profile (255) neu khong co file pwmN_max.
+  return m_model.pwmMaxFallback;
 }
 
-int TufGamingFx705ge::readPwmValue(const QString &hwmonPath) const {
-  const QString raw = readTextFile(hwmonPath + "/pwm1");
+int TufGamingFx705ge::readPwmValue(const QString &hwmonPath, int channel) const {
+  const QString raw = readTextFile(hwmonPath + QString("/pwm%1").arg(channel));
   bool ok = false;
   int val = raw.toInt(&ok);
   return ok ? val : 0;
 }
 
-bool TufGamingFx705ge::writePwmValue(const QString &hwmonPath, int pwmValue) const {
-  QFile file(hwmonPath + "/pwm1");
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-    return false;
-  }
-  const QByteArray data = QByteArray::number(pwmValue);
-  const qint64 written = file.write(data);
-  file.flush();
-  return written == data.size();
+bool TufGamingFx705ge::writePwmValue(const QString &hwmonPath, int channel, int pwmValue) const {
+  return m_backend->writeText(QFile::encodeName(hwmonPath + QString("/pwm%1").arg(channel)),
+                              QByteArray::number(pwmValue));
 }
 
-bool TufGamingFx705ge::writePwmEnableManual(const QString &hwmonPath) const {
-  QFile file(hwmonPath + "/pwm1_enable");
-  if (!file.exists()) {
+bool TufGamingFx705ge::writePwmEnableManual(const QString &hwmonPath, int channel) const {
+  const QByteArray path = QFile::encodeName(hwmonPath + QString("/pwm%1_enable").arg(channel));
+  QByteArray current;
+  if (!m_backend->readText(path, &current)) {
     return false;
   }
-  if (!file.open(QIODevice::ReadWrite)) {
-    return false;
-  }
-  const QString current = QString::fromUtf8(file.readAll()).trimmed();
-  if (current == "2") {
+  // ABI hwmon: 0 = full speed, 1 = manual, 2+ = tu dong (firmware/EC dieu khien).
+  if (current.trimmed() == "1") {
     return true;  // Da o che do manual.
   }
-  file.seek(0);
-  const QByteArray data("2");
-  const qint64 written = file.write(data);
-  file.flush();
-  return written == data.size();
+  return m_backend->writeText(path, QByteArray("1"));
 }
 
 QString TufGamingFx705ge::readTextFile(const QString &path) const {
-  QFile file(path);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+  QByteArray data;
+  if (!m_backend->readText(QFile::encodeName(path), &data)) {
     return {};
   }
-  const QByteArray data = file.readAll();
   return QString::fromUtf8(data).trimmed();
 }
 
-double TufGamingFx705ge::parseTempMilli(const QString &raw) const {
-  bool ok = false;
-  double val = raw.toDouble(&ok);
-  if (!ok) {
+double TufGamingFx705ge::celsiusFromMilli(const SensorIoBackend::RawReading &raw) {
+  if (!raw.ok) {
     return 0.0;
   }
+  double val = static_cast<double>(raw.value);
   // sysfs nhiet do thuong o don vi millidegree C.
   if (val > 200.0) {
     val /= 1000.0;
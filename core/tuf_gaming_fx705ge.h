@@ -7,71 +7,172 @@
 #include <QDir>
 #include <QFile>
 #include <QIODevice>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QStringList>
 #include <QtGlobal>
 #include <algorithm>
 
-// Doc thong tin sensor va dieu khien quat cho ASUS TUF Gaming FX705GE
-// thong qua cac file sysfs (hwmon/pwm) ma script asus_fan_report.sh da phat hien.
-// Neu khong doc/ghi duoc (quyen hoac thieu thiet bi), cac gia tri tra ve se la 0.
+#include "device_probe.h"
+#include "model_profile.h"
+#include "pwm_ramp.h"
+#include "sensor_anomaly_detector.h"
+#include "sensor_io_backend.h"
+
+// Doc thong tin sensor va dieu khien quat cho ASUS TUF Gaming FX705GE (va cac may
+// TUF/ROG khac qua ModelProfile chon theo DMI) thong qua cac file sysfs (hwmon/pwm).
+// Danh sach hwmon va kenh temp/fan/pwm lay tu manifest cua DeviceProbe nen moi lan
+// refresh khong phai liet ke lai thu muc sysfs.
+// Neu khong doc/ghi duoc (quyen hoac thieu thiet bi), cac gia tri tra ve se la 0 va
+// co valid/rpmValid = false; moi lan refresh con dua mau qua SensorAnomalyDetector de
+// phan biet quat chet, sensor ket va file khong doc duoc.
+//
+// An toan khi goi tu nhieu thread: cac ham doc trang thai chi khoa m_stateMutex trong
+// thoi gian copy cache, con moi thao tac sysfs (refresh/ghi PWM) duoc tuan tu hoa bang
+// m_ioMutex nen thread GUI khong bao gio phai cho EC tra loi khi chi doc cache.
 class TufGamingFx705ge {
  public:
   // Mau du lieu nhiet do.
   struct TemperatureSample {
     QString label;
     double celsius;
+    bool valid = false;  // false neu doc that bai (celsius = 0).
   };
 
   // Mau du lieu quat.
   struct FanSample {
     int rpm;
     int percent;  // Gia tri phan tram neu dang o che do fixed.
+    bool rpmValid = false;  // false neu khong doc duoc fan*_input (rpm = 0).
+  };
+
+  // Ket qua mot lenh dieu khien quat, tra ve nguyen khoi de khong bi lastError()
+  // cua lenh khac chen vao khi goi tu thread rieng.
+  struct FanCommandResult {
+    bool ok = false;
+    int percent = 0;  // Phan tram da yeu cau (sau khi clamp 0-100).
+    int rpm = 0;      // RPM doc lai sau khi ghi.
+    bool superseded = false;  // Bi thay the boi setpoint moi hon truoc khi kip ghi.
+    QString error;
   };
 
-  TufGamingFx705ge();
+  explicit TufGamingFx705ge(SensorIoBackend::Kind ioBackend = SensorIoBackend::Kind::Auto);
+
+  // Dung kha nang phan cung va backend cho truoc thay vi sysfs that (vd. phat lai trace).
+  TufGamingFx705ge(const DeviceProbe::Capabilities &capabilities,
+                   std::unique_ptr<SensorIoBackend> backend);
+
+  // Profile phan cung chon tu DMI cua capabilities (FANS_CONTROLLER_MODEL de ep).
+  const ModelProfile &model() const { return m_model; }
+  // Kenh PWM cua quat CPU tren hwmon quat (pwm1 tren moi profile hien co).
+  int fanPwmChannel() const { return m_model.fanPwmChannel; }
 
   // Cap nhat cache sensor. Tra ve false neu doc that bai.
   bool refreshSensors();
 
   double cpuPackageTempC() const;
   double pchTempC() const;
+  // Kem co valid: doc loi thi cac ham *TempC() o tren tra 0.0, khong phan biet duoc.
+  TemperatureSample cpuPackageTemperature() const;
+  TemperatureSample pchTemperature() const;
   FanSample fan() const;
   QVector<TemperatureSample> detailTemperatures() const;
 
-  // Thiet lap che do quat co dinh theo phan tram (0-100). Tra ve true neu thanh cong.
-  bool setFixedFanPercent(int percent);
+  // Cac buoc thap dung cho ramp (FanCommandActor): dat pwmN_enable manual va doc
+  // pwmN_max; ghi mot lo gia tri PWM tho; doc lai PWM/RPM hien tai tu sysfs.
+  bool preparePwmChannel(int channel, int *pwmMax, QString *error);
+  bool writePwmSteps(const QVector<PwmRamp::Step> &steps, QString *error);
+  int readPwmRaw(int channel);
+  int readFanRpmNow();
 
-  // Ap dung preset ("Silent", "Performance", "Turbo", "Custom"...).
-  bool applyPresetMode(const QString &presetName);
+  // Ghi nhan setpoint quat (%) vao trace de phat lai qua controller moi.
+  void noteFanTarget(int percent);
+  static constexpr const char *kFanTargetAnnotation = "fan_target_percent";
+
+  // % quat cua preset theo profile (FX705GE: "Silent" 30, "Performance" 65, "Turbo" 85);
+  // -1 neu khong co.
+  static int presetPercent(const QString &presetName,
+                           const ModelProfile &model = ModelProfile::detected());
 
   // Tra ve chuoi loi gan nhat (neu co) de hien thi cho nguoi dung.
-  QString lastError() const { return m_lastError; }
+  QString lastError() const;
+
+  // Loi sensor/quat dang bat sau lan refresh gan nhat, va cac su kien bat/het loi tich
+  // luy tu lan goi takeSensorFaultEvents() truoc (lay xong thi xoa).
+  QVector<SensorAnomalyDetector::Event> sensorFaults() const;
+  QVector<SensorAnomalyDetector::Event> takeSensorFaultEvents();
+
+  // Backend doc sysfs dang dung ("plain"/"io_uring") va chi phi syscall/thoi gian
+  // cua cac lan refreshSensors().
+  QString ioBackendName() const;
+  SensorIoBackend::Stats ioStats() const;
+
+  // Duong dan sysfs cho FanWatchdog: thu muc hwmon chua pwmN va temp*_input cua CPU
+  // package (rong neu khong co).
+  QString fanHwmonPath() const;
+  QString cpuPackageTempPath() const;
 
  private:
-  // Doc tu sysfs; neu that bai thi tra ve 0 an toan.
-  void loadFromSysfs();
+  // Toan bo cache sensor, duoc thay the nguyen khoi sau moi lan doc.
+  struct Readings {
+    TemperatureSample cpuPackage;
+    TemperatureSample pch;
+    FanSample fan;
+    QVector<TemperatureSample> details;
+    QVector<SensorAnomalyDetector::Event> faults;
+    QString lastError;
+  };
+
+  // Vai tro cua mot thuoc tinh trong ke hoach doc.
+  enum class AttributeRole { Temperature, FanInput, PwmValue, PwmMax };
+  enum AttributeFlag { kCoreTemp = 1, kCpuPackage = 2, kPchTemp = 4 };
+  struct SensorAttribute {
+    AttributeRole role;
+    QString label;  // Nhan hien thi (Temperature, FanInput).
+    int flags;      // To hop AttributeFlag.
+    int detectorChannel = -1;  // Kenh trong m_detector; -1 neu khong theo doi.
+  };
+
+  // Lap ke hoach doc mot lan tu manifest va dang ky duong dan voi backend.
+  void buildSensorPlan();
+
+  // Doc tu sysfs vao readings; neu that bai thi tra ve 0 an toan.
+  void loadFromSysfs(Readings *readings);
 
   // Du lieu gia lap an toan (0.0) khi khong doc duoc.
-  void loadMockData();
-
-  QString findHwmonByName(const QStringList &needles) const;
-  QVector<TemperatureSample> readTemps(const QString &hwmonPath) const;
-  int readFanRpm(const QString &hwmonPath) const;
-  int readPwmMax(const QString &hwmonPath) const;
-  int readPwmValue(const QString &hwmonPath) const;
-  bool writePwmValue(const QString &hwmonPath, int pwmValue) const;
-  bool writePwmEnableManual(const QString &hwmonPath) const;
+  static void loadMockData(Readings *readings);
+
+  const DeviceProbe::HwmonEntry *findHwmonByName(const ModelProfile::Needles &needles) const;
+  int readFanRpm(const DeviceProbe::HwmonEntry &hwmon) const;
+  int readPwmMax(const QString &hwmonPath, int channel) const;
+  int readPwmValue(const QString &hwmonPath, int channel) const;
+  bool writePwmValue(const QString &hwmonPath, int channel, int pwmValue) const;
+  bool writePwmEnableManual(const QString &hwmonPath, int channel) const;
   QString readTextFile(const QString &path) const;
-  double parseTempMilli(const QString &raw) const;
+  static double celsiusFromMilli(const SensorIoBackend::RawReading &raw);
+
+  // Kha nang phan cung da do (tu manifest hoac probe moi); khong doi sau constructor.
+  const DeviceProbe::Capabilities m_capabilities;
+  const ModelProfile &m_model;
+
+  // Duong dan hwmon asus de set PWM, xac dinh mot lan tu manifest.
+  const QString m_asusHwmonPath;
+
+  // temp*_input cua CPU package, xac dinh trong buildSensorPlan().
+  QString m_cpuPackageTempPath;
 
-  TemperatureSample m_cpuPackage;
-  TemperatureSample m_pch;
-  FanSample m_fan;
-  QVector<TemperatureSample> m_details;
+  // Ke hoach doc va backend; chi dung khi giu m_ioMutex.
+  QVector<SensorAttribute> m_plan;
+  std::unique_ptr<SensorIoBackend> m_backend;
+  QVector<SensorIoBackend::RawReading> m_rawReadings;
+  SensorAnomalyDetector m_detector;
 
-  // Luu duong dan hwmon asus de set PWM sau khi da phat hien o refreshSensors.
-  QString m_asusHwmonPath;
-  QString m_lastError;
+  mutable QMutex m_stateMutex;  // Bao ve m_readings, m_ioStats, m_faultEvents, m_fanPwmMax.
+  QMutex m_ioMutex;             // Tuan tu hoa cac lan doc/ghi sysfs.
+  Readings m_readings;
+  SensorIoBackend::Stats m_ioStats;
+  QVector<SensorAnomalyDetector::Event> m_faultEvents;
+  int m_fanPwmMax = 0;          // pwm1_max doc duoc o lan preparePwmChannel gan nhat.
 };
 
 #endif  // FANS_CONTROLLER_TUF_GAMING_FX705GE_H
@@ -1,6 +1,11 @@
 #!/usr/bin/env bash
 # ASUS TUF Fan & Sensor Capability Inspector (full check, safe syntax)
 # Usage: sudo bash device-check/asus_fan_report.sh
+#
+# The application does not depend on this script: `FansController --probe` runs the
+# same hwmon / thermal zone / PWM / DMI discovery natively in a few milliseconds and
+# refreshes the capability manifest the app loads at startup. Keep this script for
+# the extra diagnostics it collects (packages, modules, lspci, sensors output).
 
 set -euo pipefail
 
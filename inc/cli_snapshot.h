@@ -0,0 +1,97 @@
+#ifndef FANS_CONTROLLER_CLI_SNAPSHOT_H
+#define FANS_CONTROLLER_CLI_SNAPSHOT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <ctime>
+
+#include "fleet_aggregator.h"
+#include "self_overhead.h"
+#include "tuf_gaming_fx705ge.h"
+
+// Che do dong lenh khong giao dien: doc sensor bang TufGamingFx705ge::refreshSensors()
+// roi in ra stdout (text hoac JSON). Khong tao QApplication, khong nap stylesheet va
+// khong can display de script giam sat/cron co the goi voi tan suat cao.
+//
+//   FansController --once [--json]     Doc mot lan roi thoat.
+//   FansController --watch N [--json]  Doc lap lai moi N giay (JSON: moi dong mot object).
+//   FansController --probe             Do lai kha nang phan cung va ghi manifest moi.
+//   FansController --bench-io N        So sanh backend doc sysfs (plain / io_uring).
+//   FansController --watchdog-test N   Do thoi gian phan ung cua FanWatchdog (hwmon gia).
+//   FansController --bench-history N   Do kich thuoc/toc do SensorHistory voi N kenh.
+//   FansController --replay FILE        Phat lai trace qua duong dieu khien hien tai
+//                                       (--policy P: tinh setpoint bang FanPolicy).
+//   FansController --simulate           Chay chinh sach quat tren mo hinh nhiet gia lap.
+//   FansController --serve [ADDR:]PORT  Phat snapshot JSON qua TCP cho FleetAggregator.
+//   FansController --aggregate H:P,...  Gom luong snapshot cua nhieu may (FleetAggregator).
+//   FansController --overhead SEC       Do chi phi CPU/wakeup/syscall/heap cua chinh app.
+//   --budget cpu=0.1,...                Ngan sach cho --overhead va panel Diagnostics.
+//   --io-backend plain|io_uring|auto    Chon backend doc sysfs cho cac che do tren.
+//   --record FILE                       Ghi trace tho (ca GUI) vao FILE.
+class CliSnapshot {
+ public:
+  struct Options {
+    bool headless = false;      // Co it nhat mot co dong lenh cua che do nay.
+    bool json = false;          // In JSON thay vi text.
+    bool once = false;          // Doc mot lan roi thoat.
+    double watchSeconds = 0.0;  // > 0: chu ky doc lap lai (giay).
+    bool probe = false;         // Do lai phan cung (DeviceProbe) va in bao cao.
+    int benchIoRefreshes = 0;   // > 0: do chi phi refresh cua tung backend.
+    int watchdogTrips = 0;      // > 0: so lan kich hoat watchdog khi do phan ung.
+    int benchHistoryChannels = 0;  // > 0: do SensorHistory voi 24 gio du lieu tong hop.
+    QString replayPath;         // Trace can phat lai (--replay).
+    double replaySpeed = 0.0;   // <= 0: phat lai nhanh nhat co the.
+    double rampRate = PwmRamp::kDefaultRatePercentPerSecond;  // --replay/--simulate.
+    bool simulate = false;      // Chay ThermalSimulation (--simulate).
+    int simScenarios = 100;
+    quint64 simSeed = 1;
+    double simDurationS = 600.0;
+    QStringList simPolicies;    // --policy; voi --replay chi nhan mot chinh sach.
+    QStringList simProfiles;
+    SensorIoBackend::Kind ioBackend = SensorIoBackend::Kind::Auto;
+    QByteArray serveAddress = "127.0.0.1";  // --serve: mac dinh chi loopback.
+    int servePort = 0;          // > 0: --serve, phat snapshot qua TCP.
+    int simInstances = 0;       // > 0: --serve N may gia lap o cac cong PORT..PORT+N-1.
+    QStringList aggregateEndpoints;  // --aggregate (lap lai duoc).
+    int aggregateSimInstances = 0;   // > 0: --aggregate-sim, tu chay N may gia lap.
+    double overheadSeconds = 0.0;  // > 0: --overhead, do chi phi cua chinh app.
+    bool help = false;          // In huong dan su dung.
+    QString error;              // Loi phan tich tham so (neu co).
+  };
+
+  // Phan tich argv. Tra ve true neu nguoi dung yeu cau che do dong lenh; khi do
+  // main() phai goi run() va khong tao QApplication.
+  static bool parseArguments(int argc, char *argv[], Options *options);
+
+  // Chay che do dong lenh va tra ve exit code cho main().
+  static int run(const Options &options);
+
+ private:
+  static QByteArray formatJson(const TufGamingFx705ge &device, qint64 timestampMs);
+  static QByteArray formatText(const TufGamingFx705ge &device);
+  static int runIoBenchmark(int refreshes, bool json);
+  static int runWatchdogTest(int trips, bool json);
+  static int runHistoryBenchmark(int channels, bool json);
+  static int runReplay(const Options &options);
+  static int runSimulation(const Options &options);
+  static int runServe(const Options &options);
+  static int runAggregate(const Options &options);
+  static int runOverhead(const Options &options);
+  static QByteArray formatOverheadReport(const SelfOverhead::Report &report,
+                                         const QString &ioBackend, bool json);
+  static QByteArray formatFleetReport(const FleetAggregator::SlotReport &report,
+                                      double cpuPercent, bool json);
+  static void writeStdout(const QByteArray &data);
+  static QByteArray usage();
+
+  // Tien ich chung cua cac che do (cli_snapshot.cpp), dung ca trong cli_fleet.cpp.
+  static QByteArray jsonString(const QString &text);
+  static QByteArray oneDecimal(double value);
+  static void installStopHandlers();
+  static bool stopRequested();  // Da nhan SIGINT/SIGTERM sau installStopHandlers().
+  static void addSeconds(timespec *ts, double seconds);
+};
+
+#endif  // FANS_CONTROLLER_CLI_SNAPSHOT_H
@@ -1,6 +1,7 @@
 #ifndef FANS_CONTROLLER_MAIN_H
 #define FANS_CONTROLLER_MAIN_H
 
+#include "cli_snapshot.h"
 #include "mainwindow.h"
 #include <QString>
 #include <QApplication>
@@ -0,0 +1,306 @@
+#include "cli_snapshot.h"
+
+#include <QDateTime>
+
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "process_footprint.h"
+#include "simulated_sensor_backend.h"
+#include "telemetry_server.h"
+#include "thermal_plant.h"
+
+// Che do fleet cua CliSnapshot: --serve (phat snapshot qua TCP, co the N may gia lap) va
+// --aggregate/--aggregate-sim (gom luong cua nhieu may bang FleetAggregator).
+namespace {
+constexpr quint16 kSimBasePort = 47000;
+constexpr double kSimStepS = 0.1;
+constexpr double kSimPhaseSpreadS = 30.0;
+
+// Vai tram socket vuot gioi han mem 1024 fd mac dinh; nang len gioi han cung.
+void raiseFileLimit() {
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+}  // namespace
+
+int CliSnapshot::runServe(const Options &options) {
+  raiseFileLimit();
+  installStopHandlers();
+
+  // Moi feed: mot cong TCP + mot thiet bi (that, hoac may gia lap rieng cho moi cong).
+  struct Feed {
+    std::unique_ptr<TelemetryServer> server;
+    std::unique_ptr<TufGamingFx705ge> device;
+    SimulatedSensorBackend *sim = nullptr;  // Thuoc so huu cua device.
+    double simTimeS = 0.0;
+  };
+  const bool simulated = options.simInstances > 0;
+  ThermalPlant::LoadProfile load = ThermalPlant::LoadProfile::random(options.simSeed, 3600.0);
+  std::vector<Feed> feeds(static_cast<size_t>(simulated ? options.simInstances : 1));
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    Feed &feed = feeds[i];
+    feed.server = std::make_unique<TelemetryServer>();
+    QString error;
+    const quint16 port = static_cast<quint16>(options.servePort + static_cast<int>(i));
+    if (!feed.server->listen(options.serveAddress, port, &error)) {
+      std::fprintf(stderr, "%s\n", qPrintable(error));
+      return 1;
+    }
+    if (!simulated) {
+      feed.device = std::make_unique<TufGamingFx705ge>(options.ioBackend);
+      continue;
+    }
+    // Cung mot tai (nhu ca phong lab chay cung job) lech pha vai giay, moi hop tan nhiet
+    // hoi khac nhau; may dau tien bi bam bui (tan nhiet kem) de aggregator co may lech.
+    std::mt19937_64 rng(options.simSeed * 1000003ULL + i);
+    ThermalPlant::Params params;
+    params.ambientC = std::uniform_real_distribution<double>(25.0, 31.0)(rng);
+    params.sinkFanWPerK = std::uniform_real_distribution<double>(4.5, 5.5)(rng);
+    if (i == 0) {
+      params.sinkFanWPerK *= 0.35;
+    }
+    auto backend = std::make_unique<SimulatedSensorBackend>(params);
+    feed.sim = backend.get();
+    feed.device = std::make_unique<TufGamingFx705ge>(SimulatedSensorBackend::capabilities(),
+                                                     std::move(backend));
+    feed.simTimeS = std::uniform_real_distribution<double>(0.0, kSimPhaseSpreadS)(rng);
+  }
+
+  std::vector<pollfd> fds;
+  for (const Feed &feed : feeds) {
+    fds.push_back({feed.server->fd(), POLLIN, 0});
+  }
+  const double intervalS = options.watchSeconds > 0.0 ? options.watchSeconds : 1.0;
+  timespec next{};
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (!stopRequested()) {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const qint64 waitMs = (next.tv_sec - now.tv_sec) * 1000 + (next.tv_nsec - now.tv_nsec) / 1000000;
+    if (waitMs > 0) {
+      const int ready = ::poll(fds.data(), fds.size(), static_cast<int>(waitMs));
+      for (size_t i = 0; ready > 0 && i < fds.size(); ++i) {
+        if (fds[i].revents & POLLIN) {
+          feeds[i].server->acceptPending();
+        }
+      }
+      continue;  // Kiem tra lai co dung va moc thoi gian.
+    }
+
+    const qint64 timestampMs = QDateTime::currentMSecsSinceEpoch();
+    for (Feed &feed : feeds) {
+      if (feed.sim) {
+        const long steps = std::max(1L, std::lround(intervalS / kSimStepS));
+        for (long step = 0; step < steps; ++step) {
+          feed.sim->advance(kSimStepS, load.powerAt(feed.simTimeS));
+          feed.simTimeS += kSimStepS;
+        }
+      }
+      feed.device->refreshSensors();
+      for (const auto &event : feed.device->takeSensorFaultEvents()) {
+        std::fprintf(stderr, "Sensor: %s\n", qPrintable(SensorAnomalyDetector::describe(event)));
+      }
+      feed.server->broadcast(formatJson(*feed.device, timestampMs));
+    }
+    addSeconds(&next, intervalS);
+  }
+  return 0;
+}
+
+int CliSnapshot::runAggregate(const Options &options) {
+  raiseFileLimit();
+  QVector<FleetAggregator::Endpoint> endpoints;
+  for (const QString &spec : options.aggregateEndpoints) {
+    QString error;
+    if (!FleetAggregator::parseEndpoints(spec, &endpoints, &error)) {
+      std::fprintf(stderr, "%s\n", qPrintable(error));
+      return 2;
+    }
+  }
+
+  // --aggregate-sim: mot tien trinh con phat N may gia lap tren loopback (nhe hon N
+  // tien trinh); aggregator van ket noi toi tung cong nhu voi fleet that.
+  pid_t child = -1;
+  if (options.aggregateSimInstances > 0) {
+    const QByteArray listen = "127.0.0.1:" + QByteArray::number(kSimBasePort);
+    const QByteArray count = QByteArray::number(options.aggregateSimInstances);
+    const QByteArray seed = QByteArray::number(options.simSeed);
+    const QByteArray interval = QByteArray::number(options.watchSeconds > 0.0 ? options.watchSeconds : 1.0);
+    char *argv[] = {const_cast<char *>("FansController"), const_cast<char *>("--serve"),
+                    const_cast<char *>(listen.constData()), const_cast<char *>("--sim-instances"),
+                    const_cast<char *>(count.constData()), const_cast<char *>("--seed"),
+                    const_cast<char *>(seed.constData()), const_cast<char *>("--watch"),
+                    const_cast<char *>(interval.constData()), nullptr};
+    const int rc = posix_spawn(&child, "/proc/self/exe", nullptr, nullptr, argv, environ);
+    if (rc != 0) {
+      std::fprintf(stderr, "Khong chay duoc instance gia lap: %s\n", std::strerror(rc));
+      return 1;
+    }
+    for (int i = 0; i < options.aggregateSimInstances; ++i) {
+      endpoints.append({QString("127.0.0.1"), static_cast<quint16>(kSimBasePort + i)});
+    }
+  }
+
+  installStopHandlers();
+  int exitCode = 0;
+  {
+    FleetAggregator aggregator;
+    QString error;
+    if (!aggregator.start(endpoints, &error)) {
+      std::fprintf(stderr, "%s\n", qPrintable(error));
+      exitCode = 1;
+    }
+    ProcessFootprint previous = ProcessFootprint::sample();
+    QVector<FleetAggregator::SlotReport> reports;
+    while (exitCode == 0 && !stopRequested()) {
+      // Con thoat som (vd. cong 47000+N da bi chiem nen listen() loi): aggregator se ket
+      // noi lai mai mai toi cac cong khong ai mo, nen bao loi va dung.
+      int status = 0;
+      if (child > 0 && waitpid(child, &status, WNOHANG) == child) {
+        child = -1;
+        if (!stopRequested()) {
+          std::fprintf(stderr, "Instance gia lap (--serve %u..%u) da thoat som (%s %d); xem "
+                       "loi phia tren, vd. cong da bi chiem.\n",
+                       static_cast<unsigned>(kSimBasePort),
+                       static_cast<unsigned>(kSimBasePort + options.aggregateSimInstances - 1),
+                       WIFSIGNALED(status) ? "tin hieu" : "ma thoat",
+                       WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+          exitCode = 1;
+        }
+        break;
+      }
+      reports.clear();
+      if (!aggregator.poll(1000, &reports, &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        exitCode = 1;
+        break;
+      }
+      if (reports.isEmpty()) {
+        continue;
+      }
+      // CPU cua chinh aggregator (mot thread) tu lan in truoc.
+      const ProcessFootprint current = ProcessFootprint::sample();
+      const qint64 wallMs = std::max<qint64>(1, current.monotonicMs - previous.monotonicMs);
+      const double cpuPercent = (current.cpuUs - previous.cpuUs) / (10.0 * wallMs);
+      previous = current;
+      for (const auto &report : reports) {
+        writeStdout(formatFleetReport(report, cpuPercent, options.json));
+      }
+      if (std::ferror(stdout)) {
+        break;
+      }
+    }
+  }
+
+  if (child > 0) {
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+  }
+  return exitCode;
+}
+
+QByteArray CliSnapshot::formatFleetReport(const FleetAggregator::SlotReport &report,
+                                          double cpuPercent, bool json) {
+  const auto &loop = report.loop;
+  QByteArray out;
+  if (!json) {
+    out.append(QDateTime::fromMSecsSinceEpoch(report.slotMs).toString("HH:mm:ss").toUtf8());
+    out.append("  ").append(QByteArray::number(report.reporting)).append('/');
+    out.append(QByteArray::number(report.hosts.size())).append(" hosts reporting, ");
+    out.append(QByteArray::number(loop.connected)).append(" connected, CPU ");
+    out.append(QByteArray::number(cpuPercent, 'f', 2)).append("%\n");
+    for (const auto &summary : report.summaries) {
+      out.append("  ").append(summary.sensor.toUtf8());
+      out.append(": n ").append(QByteArray::number(summary.hosts));
+      out.append(", min ").append(oneDecimal(summary.minimum));
+      out.append(", max ").append(oneDecimal(summary.maximum));
+      out.append(", p50 ").append(oneDecimal(summary.p50));
+      out.append(", p95 ").append(oneDecimal(summary.p95));
+      out.append(", p99 ").append(oneDecimal(summary.p99)).append('\n');
+    }
+    for (const auto &outlier : report.outliers) {
+      out.append("  Outlier: ").append(outlier.host.toUtf8()).append(' ');
+      out.append(outlier.sensor.toUtf8()).append(' ').append(oneDecimal(outlier.value));
+      out.append(" (fleet median ").append(oneDecimal(outlier.fleetMedian));
+      out.append(", z ").append(oneDecimal(outlier.robustZ));
+      out.append(", ").append(QByteArray::number(outlier.streak)).append(" slots)\n");
+    }
+    return out;
+  }
+
+  out.append("{\"slot_ms\":").append(QByteArray::number(report.slotMs));
+  out.append(",\"hosts\":").append(QByteArray::number(report.hosts.size()));
+  out.append(",\"reporting\":").append(QByteArray::number(report.reporting));
+  out.append(",\"connected\":").append(QByteArray::number(loop.connected));
+  out.append(",\"sensors\":[");
+  for (int i = 0; i < report.summaries.size(); ++i) {
+    const auto &summary = report.summaries[i];
+    out.append(i ? ",{\"sensor\":" : "{\"sensor\":").append(jsonString(summary.sensor));
+    out.append(",\"hosts\":").append(QByteArray::number(summary.hosts));
+    out.append(",\"min\":").append(oneDecimal(summary.minimum));
+    out.append(",\"max\":").append(oneDecimal(summary.maximum));
+    out.append(",\"p50\":").append(oneDecimal(summary.p50));
+    out.append(",\"p95\":").append(oneDecimal(summary.p95));
+    out.append(",\"p99\":").append(oneDecimal(summary.p99)).append('}');
+  }
+  out.append("],\"outliers\":[");
+  for (int i = 0; i < report.outliers.size(); ++i) {
+    const auto &outlier = report.outliers[i];
+    out.append(i ? ",{\"host\":" : "{\"host\":").append(jsonString(outlier.host));
+    out.append(",\"sensor\":").append(jsonString(outlier.sensor));
+    out.append(",\"value\":").append(oneDecimal(outlier.value));
+    out.append(",\"fleet_median\":").append(oneDecimal(outlier.fleetMedian));
+    out.append(",\"robust_z\":").append(oneDecimal(outlier.robustZ));
+    out.append(",\"streak\":").append(QByteArray::number(outlier.streak)).append('}');
+  }
+  // Bang can theo slot: host -> {sensor: gia tri}, bo o trong.
+  out.append("],\"table\":{");
+  const int sensors = report.sensors.size();
+  bool firstHost = true;
+  for (int host = 0; host < report.hosts.size(); ++host) {
+    bool firstValue = true;
+    for (int sensor = 0; sensor < sensors; ++sensor) {
+      const double value = report.table[host * sensors + sensor];
+      if (std::isnan(value)) {
+        continue;
+      }
+      if (firstValue) {
+        out.append(firstHost ? "" : ",").append(jsonString(report.hosts[host])).append(":{");
+        firstHost = false;
+      }
+      out.append(firstValue ? "" : ",").append(jsonString(report.sensors[sensor]));
+      out.append(':').append(oneDecimal(value));
+      firstValue = false;
+    }
+    if (!firstValue) {
+      out.append('}');
+    }
+  }
+  out.append("},\"loop\":{\"wakeups\":").append(QByteArray::number(loop.wakeups));
+  out.append(",\"reads\":").append(QByteArray::number(loop.reads));
+  out.append(",\"bytes\":").append(QByteArray::number(loop.bytes));
+  out.append(",\"lines\":").append(QByteArray::number(loop.lines));
+  out.append(",\"bad_lines\":").append(QByteArray::number(loop.badLines));
+  out.append(",\"late_lines\":").append(QByteArray::number(loop.lateLines));
+  out.append(",\"reconnects\":").append(QByteArray::number(loop.reconnects));
+  out.append(",\"cpu_percent\":").append(QByteArray::number(cpuPercent, 'f', 2));
+  out.append("}}\n");
+  return out;
+}
@@ -0,0 +1,991 @@
+#include "cli_snapshot.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <signal.h>
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <vector>
+
+#include "fan_watchdog.h"
+#include "process_footprint.h"
+#include "self_overhead.h"
+#include "sensor_history.h"
+#include "sensor_sampler.h"
+#include "simulated_sensor_backend.h"
+#include "thermal_simulation.h"
+#include "trace_replay.h"
+
+namespace {
+// --serve/--aggregate-sim: gioi han theo so fd (moi may gia lap mot socket lang nghe).
+constexpr int kMaxSimInstances = 1000;
+// --simulate: gioi han de mot lenh go nham khong chay vo han.
+constexpr int kMaxSimScenarios = 100000;
+constexpr double kMaxSimDurationS = 7 * 24 * 3600.0;
+
+volatile std::sig_atomic_t g_stopRequested = 0;
+
+void requestStop(int) {
+  g_stopRequested = 1;
+}
+
+// Gia tri doc loi in la null (JSON, FleetAggregator bo qua) hoac "n/a" (text), khong in
+// 0 de khong lan vao phan vi/median nhu mot so do that.
+QByteArray orMissing(bool valid, const QByteArray &value, bool json) {
+  return valid ? value : QByteArray(json ? "null" : "n/a");
+}
+
+QByteArray celsiusOrMissing(const TufGamingFx705ge::TemperatureSample &sample, bool json) {
+  const QByteArray value = QByteArray::number(sample.celsius, 'f', 1);
+  return orMissing(sample.valid, json ? value : value + " C", json);
+}
+}  // namespace
+
+// Escape chuoi cho JSON; nhan sensor lay tu sysfs nen chi can xu ly ky tu co ban.
+QByteArray CliSnapshot::jsonString(const QString &text) {
+  QByteArray out;
+  out.reserve(text.size() + 2);
+  out.append('"');
+  for (const char c : text.toUtf8()) {
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+          out.append(buf);
+        } else {
+          out.append(c);
+        }
+    }
+  }
+  out.append('"');
+  return out;
+}
+
+QByteArray CliSnapshot::oneDecimal(double value) {
+  return QByteArray::number(value, 'f', 1);
+}
+
+// SIGINT/SIGTERM chi dat co (khong SA_RESTART) de poll()/epoll_wait() tra ve EINTR va
+// vong lap don dep socket, tien trinh con truoc khi thoat.
+void CliSnapshot::installStopHandlers() {
+  struct sigaction action {};
+  action.sa_handler = requestStop;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+}
+
+bool CliSnapshot::stopRequested() {
+  return g_stopRequested != 0;
+}
+
+// Cong them mot khoang (giay) vao moc thoi gian tuyet doi, dung cho clock_nanosleep.
+void CliSnapshot::addSeconds(timespec *ts, double seconds) {
+  const double whole = std::floor(seconds);
+  ts->tv_sec += static_cast<time_t>(whole);
+  ts->tv_nsec += static_cast<long>((seconds - whole) * 1e9);
+  while (ts->tv_nsec >= 1000000000L) {
+    ts->tv_nsec -= 1000000000L;
+    ++ts->tv_sec;
+  }
+}
+
+bool CliSnapshot::parseArguments(int argc, char *argv[], Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const QByteArray arg(argv[i]);
+    if (arg == "--once") {
+      options->headless = true;
+      options->once = true;
+    } else if (arg == "--json") {
+      options->headless = true;
+      options->json = true;
+    } else if (arg == "--watch") {
+      options->headless = true;
+      if (i + 1 >= argc) {
+        options->error = "--watch can mot gia tri N (giay).";
+        continue;
+      }
+      bool ok = false;
+      const double seconds = QByteArray(argv[++i]).toDouble(&ok);
+      if (!ok || !std::isfinite(seconds) || seconds <= 0.0) {
+        options->error = QString("Gia tri --watch khong hop le: %1").arg(argv[i]);
+        continue;
+      }
+      options->watchSeconds = seconds;
+    } else if (arg == "--io-backend") {
+      if (i + 1 >= argc) {
+        options->error = "--io-backend can mot gia tri (plain, io_uring, auto).";
+        continue;
+      }
+      bool ok = false;
+      options->ioBackend = SensorIoBackend::parseKind(QString::fromLocal8Bit(argv[++i]), &ok);
+      if (!ok) {
+        options->error = QString("Gia tri --io-backend khong hop le: %1").arg(argv[i]);
+      }
+    } else if (arg == "--bench-io") {
+      options->headless = true;
+      bool ok = false;
+      options->benchIoRefreshes = (i + 1 < argc) ? QByteArray(argv[++i]).toInt(&ok) : 0;
+      if (!ok || options->benchIoRefreshes <= 0) {
+        options->error = "--bench-io can so lan refresh N > 0.";
+      }
+    } else if (arg == "--watchdog-test") {
+      options->headless = true;
+      bool ok = false;
+      options->watchdogTrips = (i + 1 < argc) ? QByteArray(argv[++i]).toInt(&ok) : 0;
+      if (!ok || options->watchdogTrips <= 0) {
+        options->error = "--watchdog-test can so lan kich hoat N > 0.";
+      }
+    } else if (arg == "--bench-history") {
+      options->headless = true;
+      bool ok = false;
+      options->benchHistoryChannels = (i + 1 < argc) ? QByteArray(argv[++i]).toInt(&ok) : 0;
+      if (!ok || options->benchHistoryChannels <= 0) {
+        options->error = "--bench-history can so kenh N > 0.";
+      }
+    } else if (arg == "--record") {
+      // Chi dat bien moi truong: ca GUI lan --once/--watch deu ghi trace qua backend.
+      if (i + 1 >= argc) {
+        options->error = "--record can duong dan file trace.";
+        continue;
+      }
+      qputenv("FANS_CONTROLLER_TRACE", QByteArray(argv[++i]));
+    } else if (arg == "--budget") {
+      // Nhu --record: dat bien moi truong de ca GUI lan --overhead dung cung ngan sach.
+      SelfOverhead::Budgets budgets;
+      QString error;
+      const QString spec = (i + 1 < argc) ? QString::fromLocal8Bit(argv[++i]) : QString();
+      if (spec.isEmpty() || !SelfOverhead::Budgets::parse(spec, &budgets, &error)) {
+        options->headless = true;
+        options->error = spec.isEmpty() ? "--budget can danh sach khoa=gia tri." : error;
+        continue;
+      }
+      qputenv("FANS_CONTROLLER_BUDGETS", spec.toLocal8Bit());
+    } else if (arg == "--overhead") {
+      options->headless = true;
+      bool ok = false;
+      options->overheadSeconds = (i + 1 < argc) ? QByteArray(argv[++i]).toDouble(&ok) : 0.0;
+      if (!ok || !std::isfinite(options->overheadSeconds) || options->overheadSeconds <= 0.0) {
+        options->error = "--overhead can so giay > 0.";
+      }
+    } else if (arg == "--replay") {
+      options->headless = true;
+      if (i + 1 >= argc) {
+        options->error = "--replay can duong dan file trace.";
+        continue;
+      }
+      options->replayPath = QString::fromLocal8Bit(argv[++i]);
+    } else if (arg == "--speed" || arg == "--ramp-rate") {
+      bool ok = false;
+      const double value = (i + 1 < argc) ? QByteArray(argv[++i]).toDouble(&ok) : 0.0;
+      // --speed 0/am lam hong nhip phat lai (bo --speed de phat nhanh nhat); --ramp-rate 0
+      // la "khong ramp", NaN/vo cuc lam PwmRamp tinh sai moc thoi gian.
+      const bool speed = arg == "--speed";
+      if (!ok || !std::isfinite(value) || (speed ? value <= 0.0 : value < 0.0)) {
+        options->error = speed ? QString("--speed can he so > 0.")
+                               : QString("--ramp-rate can so %/s >= 0.");
+        continue;
+      }
+      (speed ? options->replaySpeed : options->rampRate) = value;
+    } else if (arg == "--simulate") {
+      options->headless = true;
+      options->simulate = true;
+    } else if (arg == "--policy" || arg == "--profile") {
+      if (i + 1 >= argc) {
+        options->error = QString("%1 can mot gia tri.").arg(arg.constData());
+        continue;
+      }
+      (arg == "--policy" ? options->simPolicies : options->simProfiles)
+          .append(QString::fromLocal8Bit(argv[++i]));
+    } else if (arg == "--scenarios") {
+      bool ok = false;
+      const int count = (i + 1 < argc) ? QByteArray(argv[++i]).toInt(&ok) : 0;
+      if (!ok || count < 1 || count > kMaxSimScenarios) {
+        options->error = QString("--scenarios can so kich ban 1..%1.").arg(kMaxSimScenarios);
+        continue;
+      }
+      options->simScenarios = count;
+    } else if (arg == "--seed") {
+      bool ok = false;
+      const QByteArray text = (i + 1 < argc) ? QByteArray(argv[++i]).trimmed() : QByteArray();
+      const quint64 seed = text.toULongLong(&ok);
+      if (!ok || text.startsWith('-')) {
+        options->error = "--seed can so nguyen khong am (trong pham vi 64 bit).";
+        continue;
+      }
+      options->simSeed = seed;
+    } else if (arg == "--duration") {
+      bool ok = false;
+      const double value = (i + 1 < argc) ? QByteArray(argv[++i]).toDouble(&ok) : 0.0;
+      if (!ok || !std::isfinite(value) || value < 1.0 || value > kMaxSimDurationS) {
+        options->error =
+            QString("--duration can so giay 1..%1.").arg(static_cast<qint64>(kMaxSimDurationS));
+        continue;
+      }
+      options->simDurationS = value;
+    } else if (arg == "--serve") {
+      options->headless = true;
+      const QByteArray spec = (i + 1 < argc) ? QByteArray(argv[++i]) : QByteArray();
+      const int colon = spec.lastIndexOf(':');
+      if (colon >= 0) {
+        // "[::]:47000" -> "::"; "0.0.0.0:47000" -> "0.0.0.0".
+        options->serveAddress = spec.left(colon);
+        if (options->serveAddress.startsWith("[") && options->serveAddress.endsWith("]")) {
+          options->serveAddress = options->serveAddress.mid(1, options->serveAddress.size() - 2);
+        }
+      }
+      bool ok = false;
+      options->servePort = spec.mid(colon + 1).toInt(&ok);
+      if (!ok || options->servePort <= 0 || options->servePort > 65535) {
+        options->error = "--serve can [ADDR:]PORT hop le.";
+      }
+    } else if (arg == "--sim-instances" || arg == "--aggregate-sim") {
+      options->headless = true;
+      bool ok = false;
+      const int count = (i + 1 < argc) ? QByteArray(argv[++i]).toInt(&ok) : 0;
+      if (!ok || count <= 0 || count > kMaxSimInstances) {
+        options->error = QString("%1 can so may 1..%2.").arg(arg.constData()).arg(kMaxSimInstances);
+        continue;
+      }
+      (arg == "--sim-instances" ? options->simInstances : options->aggregateSimInstances) = count;
+    } else if (arg == "--aggregate") {
+      options->headless = true;
+      if (i + 1 >= argc) {
+        options->error = "--aggregate can danh sach host:port.";
+        continue;
+      }
+      options->aggregateEndpoints.append(QString::fromLocal8Bit(argv[++i]));
+    } else if (arg == "--probe") {
+      options->headless = true;
+      options->probe = true;
+    } else if (arg == "--help" || arg == "-h") {
+      options->headless = true;
+      options->help = true;
+    }
+    // Cac tham so khac (vd. -platform cua Qt) de lai cho QApplication.
+  }
+
+  if (options->headless && options->once && options->watchSeconds > 0.0) {
+    options->error = "Khong the dung dong thoi --once va --watch.";
+  }
+  if (options->simInstances > 0 &&
+      (options->servePort <= 0 || options->servePort + options->simInstances - 1 > 65535)) {
+    options->error = "--sim-instances can --serve PORT va du cong cho N may.";
+  }
+  // Chi co --json thi mac dinh doc mot lan.
+  if (options->headless && options->watchSeconds <= 0.0) {
+    options->once = true;
+  }
+  return options->headless;
+}
+
+int CliSnapshot::run(const Options &options) {
+  if (options.help) {
+    writeStdout(usage());
+    return 0;
+  }
+  if (!options.error.isEmpty()) {
+    std::fprintf(stderr, "%s\n\n", qPrintable(options.error));
+    std::fputs(usage().constData(), stderr);
+    return 2;
+  }
+
+  if (options.probe) {
+    // Bo qua manifest cu: luon liet ke lai sysfs roi ghi de manifest.
+    DeviceProbe::Capabilities caps = DeviceProbe::probe();
+    caps.fingerprint = DeviceProbe::computeFingerprint();
+    const QString manifestPath = DeviceProbe::defaultManifestPath();
+    writeStdout(DeviceProbe::formatReport(caps));
+    if (!DeviceProbe::writeManifest(manifestPath, caps)) {
+      std::fprintf(stderr, "Khong ghi duoc manifest: %s\n", qPrintable(manifestPath));
+      return 1;
+    }
+    return 0;
+  }
+
+  if (options.benchIoRefreshes > 0) {
+    return runIoBenchmark(options.benchIoRefreshes, options.json);
+  }
+
+  if (options.benchHistoryChannels > 0) {
+    return runHistoryBenchmark(options.benchHistoryChannels, options.json);
+  }
+
+  if (options.watchdogTrips > 0) {
+    return runWatchdogTest(options.watchdogTrips, options.json);
+  }
+
+  if (options.overheadSeconds > 0.0) {
+    return runOverhead(options);
+  }
+
+  if (!options.replayPath.isEmpty()) {
+    return runReplay(options);
+  }
+
+  if (options.simulate) {
+    return runSimulation(options);
+  }
+
+  if (!options.aggregateEndpoints.isEmpty() || options.aggregateSimInstances > 0) {
+    return runAggregate(options);
+  }
+
+  if (options.servePort > 0) {
+    return runServe(options);
+  }
+
+  TufGamingFx705ge device(options.ioBackend);
+  if (options.once) {
+    device.refreshSensors();
+    writeStdout(options.json ? formatJson(device, QDateTime::currentMSecsSinceEpoch())
+                             : formatText(device));
+    if (!device.lastError().isEmpty()) {
+      std::fprintf(stderr, "%s\n", qPrintable(device.lastError()));
+      return 1;
+    }
+    return 0;
+  }
+
+  // --watch: dung moc thoi gian tuyet doi de chu ky khong bi troi theo thoi gian doc.
+  timespec next{};
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  for (;;) {
+    device.refreshSensors();
+    // Su kien bat/het loi ra stderr de stdout van la luong du lieu thuan.
+    for (const auto &event : device.takeSensorFaultEvents()) {
+      std::fprintf(stderr, "Sensor: %s\n", qPrintable(SensorAnomalyDetector::describe(event)));
+    }
+    writeStdout(options.json ? formatJson(device, QDateTime::currentMSecsSinceEpoch())
+                             : formatText(device) + "\n");
+    if (std::ferror(stdout)) {
+      return 0;  // Dau ong da dong (vd. `| head`), thoat im lang.
+    }
+
+    addSeconds(&next, options.watchSeconds);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {
+    }
+  }
+}
+
+QByteArray CliSnapshot::formatJson(const TufGamingFx705ge &device, qint64 timestampMs) {
+  const auto fan = device.fan();
+  QByteArray out;
+  out.reserve(512);
+  out.append("{\"timestamp_ms\":").append(QByteArray::number(timestampMs));
+  out.append(",\"cpu_package_c\":")
+      .append(celsiusOrMissing(device.cpuPackageTemperature(), true));
+  out.append(",\"pch_c\":").append(celsiusOrMissing(device.pchTemperature(), true));
+  out.append(",\"fan\":{\"rpm\":")
+      .append(orMissing(fan.rpmValid, QByteArray::number(fan.rpm), true));
+  out.append(",\"percent\":").append(QByteArray::number(fan.percent)).append('}');
+  out.append(",\"temperatures\":[");
+  bool first = true;
+  for (const auto &sample : device.detailTemperatures()) {
+    if (!first) {
+      out.append(',');
+    }
+    first = false;
+    out.append("{\"label\":").append(jsonString(sample.label));
+    out.append(",\"celsius\":").append(celsiusOrMissing(sample, true)).append('}');
+  }
+  const auto io = device.ioStats();
+  out.append("],\"io\":{\"backend\":").append(jsonString(device.ioBackendName()));
+  out.append(",\"syscalls\":").append(QByteArray::number(io.lastSyscalls));
+  out.append(",\"wall_us\":").append(oneDecimal(io.lastWallUs)).append('}');
+  out.append(",\"faults\":[");
+  first = true;
+  for (const auto &fault : device.sensorFaults()) {
+    if (!first) {
+      out.append(',');
+    }
+    first = false;
+    out.append("{\"channel\":").append(jsonString(fault.label));
+    out.append(",\"fault\":\"").append(SensorAnomalyDetector::faultName(fault.fault));
+    out.append("\",\"value\":").append(oneDecimal(fault.value)).append('}');
+  }
+  out.append("],\"error\":");
+  out.append(device.lastError().isEmpty() ? QByteArray("null") : jsonString(device.lastError()));
+  out.append("}\n");
+  return out;
+}
+
+QByteArray CliSnapshot::formatText(const TufGamingFx705ge &device) {
+  const auto fan = device.fan();
+  QByteArray out;
+  const QByteArray rpm = orMissing(fan.rpmValid, QByteArray::number(fan.rpm) + " RPM", false);
+  out.append("CPU Package: ").append(celsiusOrMissing(device.cpuPackageTemperature(), false));
+  out.append("\nPCH: ").append(celsiusOrMissing(device.pchTemperature(), false));
+  out.append("\nFan: ").append(rpm).append(", ");
+  out.append(QByteArray::number(fan.percent)).append("% PWM\n");
+  for (const auto &sample : device.detailTemperatures()) {
+    out.append("  ").append(sample.label.toUtf8()).append(": ");
+    out.append(celsiusOrMissing(sample, false)).append('\n');
+  }
+  for (const auto &fault : device.sensorFaults()) {
+    out.append("Fault: ").append(SensorAnomalyDetector::describe(fault).toUtf8()).append('\n');
+  }
+  return out;
+}
+
+int CliSnapshot::runIoBenchmark(int refreshes, bool json) {
+  // Chay cung so lan refresh voi tung backend de chon backend phu hop cho tung may.
+  const SensorIoBackend::Kind kinds[] = {SensorIoBackend::Kind::Plain,
+                                         SensorIoBackend::Kind::IoUring};
+  QByteArray out = json ? QByteArray("[") : QByteArray("backend    refreshes  syscalls/refresh  wall_us/refresh\n");
+  bool first = true;
+  for (const auto kind : kinds) {
+    TufGamingFx705ge device(kind);
+    const QString name = device.ioBackendName();
+    if (kind == SensorIoBackend::Kind::IoUring && name != "io_uring") {
+      std::fprintf(stderr, "io_uring khong kha dung tren may nay, bo qua.\n");
+      continue;
+    }
+    device.refreshSensors();  // Lan dau lam nong cache dentry/inode.
+    const auto warm = device.ioStats();
+    for (int i = 0; i < refreshes; ++i) {
+      device.refreshSensors();
+    }
+    const auto stats = device.ioStats();
+    const double syscalls = double(stats.totalSyscalls - warm.totalSyscalls) / refreshes;
+    const double wallUs = (stats.totalWallUs - warm.totalWallUs) / refreshes;
+    if (json) {
+      out.append(first ? "" : ",").append("{\"backend\":").append(jsonString(name));
+      out.append(",\"refreshes\":").append(QByteArray::number(refreshes));
+      out.append(",\"syscalls_per_refresh\":").append(oneDecimal(syscalls));
+      out.append(",\"wall_us_per_refresh\":").append(oneDecimal(wallUs)).append('}');
+    } else {
+      char line[128];
+      std::snprintf(line, sizeof(line), "%-10s %9d %17.1f %16.1f\n", qPrintable(name), refreshes,
+                    syscalls, wallUs);
+      out.append(line);
+    }
+    first = false;
+  }
+  if (json) {
+    out.append("]\n");
+  }
+  writeStdout(out);
+  return 0;
+}
+
+int CliSnapshot::runHistoryBenchmark(int channels, bool json) {
+  // 24 gio mau 1 Hz: nhiet do buoc 1 C (do phan giai coretemp) doi ngau nhien, kenh cuoi
+  // la RPM quat dao dong cham, thinh thoang mau loi (NaN); chu ky lech vai ms nhu sampler.
+  constexpr int kSamples = 24 * 60 * 60;
+  constexpr int kBuckets = 600;
+  SensorHistory history;
+  QStringList labels;
+  for (int c = 0; c < channels; ++c) {
+    labels.append(QString("Sensor %1").arg(c + 1));
+  }
+  history.setChannels(labels);
+
+  std::mt19937_64 rng(1);
+  std::uniform_int_distribution<int> jitterMs(-3, 3);
+  std::uniform_int_distribution<int> step(-1, 1);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  QVector<double> temps(channels, 50.0);
+  QVector<double> values(channels);
+  // Dau vao giu lai de so round trip: timestamp, kenh 0 (co NaN) va kenh cuoi (RPM).
+  QVector<qint64> inputTimes;
+  QVector<double> inputFirst;
+  QVector<double> inputLast;
+  inputTimes.reserve(kSamples);
+  inputFirst.reserve(kSamples);
+  inputLast.reserve(kSamples);
+  qint64 timestampMs = QDateTime::currentMSecsSinceEpoch();
+  QElapsedTimer timer;
+  qint64 encodeNs = 0;
+  for (int s = 0; s < kSamples; ++s) {
+    timestampMs += 1000 + jitterMs(rng);
+    for (int c = 0; c < channels; ++c) {
+      if (chance(rng) < 0.2) {
+        temps[c] += step(rng);
+      }
+      values[c] = temps[c];
+    }
+    values[channels - 1] = std::round(2000.0 + 300.0 * std::sin(s / 300.0));
+    if (s % 1000 == 7) {
+      values[0] = std::nan("");
+    }
+    timer.start();
+    history.append(timestampMs, values);
+    encodeNs += timer.nsecsElapsed();
+    inputTimes.append(timestampMs);
+    inputFirst.append(values[0]);
+    inputLast.append(values[channels - 1]);
+  }
+
+  const qint64 fromMs = history.firstTimestampMs();
+  const qint64 toMs = history.lastTimestampMs() + 1;
+  QVector<qint64> decodedTimes;
+  QVector<double> decodedValues;
+  timer.start();
+  for (int c = 0; c < channels; ++c) {
+    history.samples(c, fromMs, toMs, &decodedTimes, &decodedValues);
+  }
+  const qint64 decodeNs = timer.nsecsElapsed();
+  timer.start();
+  for (int c = 0; c < channels; ++c) {
+    history.aggregate(c, fromMs, toMs, kBuckets);
+  }
+  const double aggregateMs = timer.nsecsElapsed() / 1e6 / channels;
+
+  const SensorHistory::Stats stats = history.stats();
+  // Round trip: giai nen phai trung tung bit voi dau vao (ke ca NaN); chunk het han
+  // (jitter lam 24 h mau dai hon retention mot chut) chi duoc bo o dau.
+  QString mismatch;
+  for (const int c : {0, channels - 1}) {
+    history.samples(c, fromMs, toMs, &decodedTimes, &decodedValues);
+    const QVector<double> &input = c == 0 ? inputFirst : inputLast;
+    const qsizetype offset = inputTimes.size() - decodedTimes.size();
+    if (offset < 0 || decodedTimes.size() != static_cast<qsizetype>(stats.samples)) {
+      mismatch = QString("channel %1: %2 samples decoded, %3 stored")
+                     .arg(c + 1)
+                     .arg(decodedTimes.size())
+                     .arg(stats.samples);
+      break;
+    }
+    for (qsizetype i = 0; i < decodedTimes.size() && mismatch.isEmpty(); ++i) {
+      if (decodedTimes[i] != inputTimes[offset + i] ||
+          std::memcmp(&decodedValues[i], &input[offset + i], sizeof(double)) != 0) {
+        mismatch = QString("channel %1, sample %2").arg(c + 1).arg(offset + i);
+      }
+    }
+    if (!mismatch.isEmpty()) {
+      break;
+    }
+  }
+  const double totalValues = double(kSamples) * channels;
+  const double storedValues = double(stats.samples) * channels;
+  // Luu tho: double + timestamp qint64 cho moi gia tri (chua tinh nhan QString).
+  constexpr double kRawBytesPerValue = sizeof(double) + sizeof(qint64);
+  QByteArray out;
+  if (json) {
+    out.append("{\"channels\":").append(QByteArray::number(channels));
+    out.append(",\"samples\":").append(QByteArray::number(stats.samples));
+    out.append(",\"chunks\":").append(QByteArray::number(stats.chunks));
+    out.append(",\"encoded_bytes\":").append(QByteArray::number(stats.encodedBytes));
+    out.append(",\"bytes_per_value\":").append(QByteArray::number(stats.bytesPerValue, 'f', 3));
+    out.append(",\"raw_bytes_per_value\":").append(oneDecimal(kRawBytesPerValue));
+    out.append(",\"encode_ns_per_value\":").append(oneDecimal(encodeNs / totalValues));
+    out.append(",\"decode_ns_per_value\":").append(oneDecimal(decodeNs / storedValues));
+    out.append(",\"aggregate_ms\":").append(QByteArray::number(aggregateMs, 'f', 3));
+    out.append(",\"aggregate_buckets\":").append(QByteArray::number(kBuckets));
+    out.append(",\"roundtrip\":").append(mismatch.isEmpty() ? "true" : "false").append("}\n");
+  } else {
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "channels %d, %llu samples in %d chunks: %llu bytes\n"
+                  "  %.3f bytes/value (raw double + timestamp: %.0f)\n"
+                  "  encode %.1f ns/value, sequential decode %.1f ns/value\n"
+                  "  24 h -> %d buckets: %.3f ms per channel\n"
+                  "  round trip (channels 1 and %d): %s\n",
+                  channels, static_cast<unsigned long long>(stats.samples), stats.chunks,
+                  static_cast<unsigned long long>(stats.encodedBytes), stats.bytesPerValue,
+                  kRawBytesPerValue, encodeNs / totalValues, decodeNs / storedValues, kBuckets,
+                  aggregateMs, channels, mismatch.isEmpty() ? "bit-exact" : "MISMATCH");
+    out.append(text);
+  }
+  writeStdout(out);
+  if (!mismatch.isEmpty()) {
+    std::fprintf(stderr, "Lich su giai nen khong khop dau vao: %s\n", qPrintable(mismatch));
+    return 1;
+  }
+  return 0;
+}
+
+int CliSnapshot::runWatchdogTest(int trips, bool json) {
+  // Dung thu muc hwmon gia (file thuong) de do thoi gian phan ung ma khong dong vao quat that.
+  QTemporaryDir dir;
+  if (!dir.isValid()) {
+    std::fprintf(stderr, "Khong tao duoc thu muc tam cho watchdog test.\n");
+    return 1;
+  }
+  const auto writeFile = [&dir](const QString &name, const QByteArray &data) {
+    QFile file(dir.filePath(name));
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+  };
+  const auto readFile = [&dir](const QString &name) {
+    QFile file(dir.filePath(name));
+    return file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+  };
+  writeFile("pwm1", "0");
+  writeFile("pwm1_max", "255");
+  writeFile("pwm1_enable", "1");
+
+  FanWatchdog::Config config;
+  config.hwmonPath = dir.path();
+  config.channel = 1;
+  config.heartbeatTimeoutMs = 250;
+  config.periodMs = 50;
+  FanWatchdog watchdog;
+  QString error;
+  if (!watchdog.arm(config, &error)) {
+    std::fprintf(stderr, "%s\n", qPrintable(error));
+    return 1;
+  }
+
+  int restored = 0;
+  for (int i = 0; i < trips; ++i) {
+    // Gia lap controller dat manual va song binh thuong, roi ngung heartbeat.
+    writeFile("pwm1_enable", "1");
+    for (int beat = 0; beat < 10; ++beat) {
+      watchdog.heartbeat();
+      QThread::msleep(20);
+    }
+    const quint64 before = watchdog.stats().trips;
+    for (int waited = 0; waited < 2000 && watchdog.stats().trips == before; waited += 5) {
+      QThread::msleep(5);
+    }
+    if (readFile("pwm1_enable") == "2") {
+      ++restored;
+    }
+  }
+  const FanWatchdog::Stats stats = watchdog.stats();
+  watchdog.disarm();
+
+  const qint64 boundUs = stats.worstCaseBoundUs(config.periodMs);
+  QByteArray out;
+  if (json) {
+    out.append("{\"trips\":").append(QByteArray::number(stats.trips));
+    out.append(",\"restored\":").append(QByteArray::number(restored));
+    out.append(",\"max_reaction_us\":").append(QByteArray::number(stats.maxReactionUs));
+    out.append(",\"max_wake_lateness_us\":").append(QByteArray::number(stats.maxWakeLatenessUs));
+    out.append(",\"max_write_us\":").append(QByteArray::number(stats.maxWriteUs));
+    out.append(",\"worst_case_bound_us\":").append(QByteArray::number(boundUs));
+    out.append(",\"realtime\":").append(stats.realtime ? "true" : "false");
+    out.append(",\"memory_locked\":").append(stats.memoryLocked ? "true" : "false");
+    out.append("}\n");
+  } else {
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "Watchdog trips:         %llu/%d (restored auto: %d)\n"
+                  "Max reaction:           %lld us\n"
+                  "Max wake lateness:      %lld us\n"
+                  "Max failsafe write:     %lld us\n"
+                  "Worst-case bound:       %lld us (period %d ms)\n"
+                  "SCHED_FIFO: %s, mlock: %s\n",
+                  static_cast<unsigned long long>(stats.trips), trips, restored,
+                  static_cast<long long>(stats.maxReactionUs),
+                  static_cast<long long>(stats.maxWakeLatenessUs),
+                  static_cast<long long>(stats.maxWriteUs), static_cast<long long>(boundUs),
+                  config.periodMs, stats.realtime ? "yes" : "no (need CAP_SYS_NICE)",
+                  stats.memoryLocked ? "yes" : "no");
+    out.append(text);
+  }
+  writeStdout(out);
+  return restored == trips ? 0 : 1;
+}
+
+int CliSnapshot::runReplay(const Options &options) {
+  TraceReplay::Options replayOptions;
+  replayOptions.speed = options.replaySpeed;
+  replayOptions.rampRatePercentPerSecond = options.rampRate;
+  if (options.simPolicies.size() > 1) {
+    std::fprintf(stderr, "--replay chi nhan mot --policy.\n");
+    return 2;
+  }
+  replayOptions.policy = options.simPolicies.value(0);
+  TraceReplay::Summary summary;
+  QString error;
+  if (!TraceReplay::run(options.replayPath, replayOptions, &summary, &error)) {
+    std::fprintf(stderr, "%s\n", qPrintable(error));
+    return 1;
+  }
+
+  QByteArray out;
+  if (options.json) {
+    out.append("{\"policy\":").append(jsonString(summary.policy));
+    out.append(",\"frames\":").append(QByteArray::number(summary.frames));
+    out.append(",\"commands\":").append(QByteArray::number(summary.commands));
+    out.append(",\"trace_s\":").append(oneDecimal(summary.traceSeconds));
+    out.append(",\"wall_s\":").append(QByteArray::number(summary.wallSeconds, 'f', 3));
+    out.append(",\"peak_cpu_package_c\":").append(oneDecimal(summary.peakCpuPackageC));
+    out.append(",\"pwm_writes\":").append(QByteArray::number(summary.pwmWrites));
+    out.append(",\"fan_energy\":").append(QByteArray::number(summary.fanEnergy, 'f', 3));
+    out.append(",\"setpoint_delta_percent\":")
+        .append(summary.setpointFrames > 0 ? oneDecimal(summary.meanSetpointDeltaPercent)
+                                           : QByteArray("null"));
+    out.append(",\"recorded\":{\"commands\":")
+        .append(QByteArray::number(summary.recordedCommands));
+    out.append(",\"pwm_writes\":").append(QByteArray::number(summary.recordedPwmWrites));
+    out.append(",\"fan_energy\":")
+        .append(QByteArray::number(summary.recordedFanEnergy, 'f', 3))
+        .append("}}\n");
+  } else {
+    char text[768];
+    std::snprintf(text, sizeof(text),
+                  "Policy:            %s\n"
+                  "Frames:            %llu (%.1f s of trace replayed in %.3f s)\n"
+                  "Peak CPU package:  %.1f C\n"
+                  "                   replayed    recorded\n"
+                  "Fan commands:      %8llu    %8llu\n"
+                  "PWM writes:        %8llu    %8llu\n"
+                  "Fan energy:        %8.3f    %8.3f  (full-speed seconds, duty^3)\n",
+                  qPrintable(summary.policy), static_cast<unsigned long long>(summary.frames),
+                  summary.traceSeconds, summary.wallSeconds, summary.peakCpuPackageC,
+                  static_cast<unsigned long long>(summary.commands),
+                  static_cast<unsigned long long>(summary.recordedCommands),
+                  static_cast<unsigned long long>(summary.pwmWrites),
+                  static_cast<unsigned long long>(summary.recordedPwmWrites), summary.fanEnergy,
+                  summary.recordedFanEnergy);
+    out.append(text);
+    if (summary.setpointFrames > 0) {
+      out.append("Setpoint delta:    ")
+          .append(oneDecimal(summary.meanSetpointDeltaPercent))
+          .append(" % mean |policy - recorded| over ")
+          .append(QByteArray::number(summary.setpointFrames))
+          .append(" frames\n");
+    }
+  }
+  writeStdout(out);
+  return 0;
+}
+
+int CliSnapshot::runSimulation(const Options &options) {
+  ThermalSimulation::Options simOptions;
+  simOptions.scenarios = options.simScenarios;
+  simOptions.seed = options.simSeed;
+  simOptions.durationS = options.simDurationS;
+  simOptions.rampRatePercentPerSecond = options.rampRate;
+  for (const QString &name : options.simProfiles) {
+    ThermalPlant::LoadProfile load;
+    if (!ThermalPlant::LoadProfile::fromName(name, &load)) {
+      std::fprintf(stderr, "Profile tai khong ton tai: %s (co: %s)\n", qPrintable(name),
+                   qPrintable(ThermalPlant::LoadProfile::builtinNames().join(", ")));
+      return 2;
+    }
+    simOptions.profiles.append(name);
+  }
+  const QStringList specs = options.simPolicies.isEmpty()
+                                ? QStringList{"auto", "silent", "performance", "turbo"}
+                                : options.simPolicies;
+  for (const QString &spec : specs) {
+    ThermalSimulation::Policy policy;
+    QString error;
+    // Preset/"safe" theo may gia lap (FX705GE), khong theo may dang chay.
+    if (!ThermalSimulation::Policy::parse(
+            spec, &policy, &error,
+            ModelProfile::select(SimulatedSensorBackend::capabilities().dmi.productName))) {
+      std::fprintf(stderr, "%s\n", qPrintable(error));
+      return 2;
+    }
+    simOptions.policies.append(policy);
+  }
+
+  const QVector<ThermalSimulation::Result> results = ThermalSimulation::run(simOptions);
+  QByteArray out = options.json ? QByteArray("[")
+                                : QByteArray("policy              peak_c  max_c  >90C_s  throttle_s"
+                                             "  fan_energy  pwm_writes  speedup\n");
+  bool first = true;
+  for (const ThermalSimulation::Result &result : results) {
+    const double speedup = result.wallSeconds > 0.0 ? result.simulatedSeconds / result.wallSeconds
+                                                    : 0.0;
+    if (options.json) {
+      out.append(first ? "" : ",").append("{\"policy\":").append(jsonString(result.policy));
+      out.append(",\"scenarios\":").append(QByteArray::number(result.scenarios));
+      out.append(",\"mean_peak_c\":").append(oneDecimal(result.meanPeakC));
+      out.append(",\"max_peak_c\":").append(oneDecimal(result.maxPeakC));
+      out.append(",\"mean_s_above_critical\":").append(oneDecimal(result.meanSecondsAboveCritical));
+      out.append(",\"mean_throttle_s\":").append(oneDecimal(result.meanThrottleSeconds));
+      out.append(",\"mean_fan_energy\":").append(oneDecimal(result.meanFanEnergy));
+      out.append(",\"mean_pwm_writes\":").append(oneDecimal(result.meanPwmWrites));
+      out.append(",\"simulated_s\":").append(oneDecimal(result.simulatedSeconds));
+      out.append(",\"wall_s\":").append(QByteArray::number(result.wallSeconds, 'f', 3));
+      out.append(",\"speedup\":").append(QByteArray::number(speedup, 'f', 0)).append('}');
+    } else {
+      char line[192];
+      std::snprintf(line, sizeof(line), "%-18s %7.1f %6.1f %7.1f %11.1f %11.1f %11.1f %7.0fx\n",
+                    qPrintable(result.policy), result.meanPeakC, result.maxPeakC,
+                    result.meanSecondsAboveCritical, result.meanThrottleSeconds,
+                    result.meanFanEnergy, result.meanPwmWrites, speedup);
+      out.append(line);
+    }
+    first = false;
+  }
+  out.append(options.json ? "]\n" : "");
+  writeStdout(out);
+  return 0;
+}
+
+void CliSnapshot::writeStdout(const QByteArray &data) {
+  // Ghi mot lan va flush ngay de cac tien trinh doc qua pipe nhan du lieu kip thoi.
+  std::fwrite(data.constData(), 1, static_cast<size_t>(data.size()), stdout);
+  std::fflush(stdout);
+}
+
+// Chay SensorSampler nhu GUI (chu ky mac dinh, backend --io-backend) trong SEC giay roi
+// bao chi phi cua chinh tien trinh so voi ngan sach; exit code 1 neu vuot.
+int CliSnapshot::runOverhead(const Options &options) {
+  QString error;
+  const SelfOverhead::Budgets budgets = SelfOverhead::Budgets::fromEnvironment(&error);
+  if (!error.isEmpty()) {
+    std::fprintf(stderr, "FANS_CONTROLLER_BUDGETS: %s\n", qPrintable(error));
+    return 2;
+  }
+
+  installStopHandlers();
+  TufGamingFx705ge device(options.ioBackend);
+  SelfOverhead::Report report;
+  {
+    SensorSampler sampler(device);
+    SelfOverhead overhead(budgets, sampler.overheadCounters());
+    // Thread chinh ngu mot mach toi het khoang do de khong tu cong them wakeup; Ctrl+C
+    // (EINTR) ket thuc som va van in bao cao.
+    timespec deadline{};
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    addSeconds(&deadline, options.overheadSeconds);
+    while (!g_stopRequested &&
+           clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+    report = overhead.sample(sampler.overheadCounters());
+  }
+
+  writeStdout(formatOverheadReport(report, device.ioBackendName(), options.json));
+  for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+    const auto metric = static_cast<SelfOverhead::Metric>(i);
+    if (report.values[i].exceeded()) {
+      std::fprintf(stderr, "Vuot ngan sach: %s\n",
+                   qPrintable(SelfOverhead::describe(metric, report.values[i])));
+    }
+  }
+  return report.anyExceeded() ? 1 : 0;
+}
+
+QByteArray CliSnapshot::formatOverheadReport(const SelfOverhead::Report &report,
+                                             const QString &ioBackend, bool json) {
+  QByteArray out;
+  if (json) {
+    out.append("{\"seconds\":").append(oneDecimal(report.seconds));
+    out.append(",\"refreshes\":").append(QByteArray::number(report.refreshes));
+    out.append(",\"io_backend\":").append(jsonString(ioBackend));
+    out.append(",\"counts_allocations\":")
+        .append(SelfOverhead::countsAllocations() ? "true" : "false");
+    out.append(",\"metrics\":{");
+    for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+      const auto metric = static_cast<SelfOverhead::Metric>(i);
+      const SelfOverhead::Value &value = report.values[i];
+      out.append(i == 0 ? "\"" : ",\"").append(SelfOverhead::metricKey(metric)).append("\":{");
+      out.append("\"value\":")
+          .append(value.available ? QByteArray::number(value.value, 'f', 4) : "null");
+      out.append(",\"budget\":").append(QByteArray::number(value.budget, 'f', 4));
+      out.append(",\"unit\":").append(jsonString(SelfOverhead::metricUnit(metric)));
+      out.append(",\"exceeded\":").append(value.exceeded() ? "true" : "false").append('}');
+    }
+    out.append("},\"threads\":[");
+    for (qsizetype i = 0; i < report.threads.size(); ++i) {
+      const SelfOverhead::ThreadUsage &thread = report.threads[i];
+      out.append(i == 0 ? "{" : ",{");
+      out.append("\"tid\":").append(QByteArray::number(thread.tid));
+      out.append(",\"name\":").append(jsonString(thread.name));
+      out.append(",\"cpu_percent\":").append(QByteArray::number(thread.cpuPercent, 'f', 4));
+      out.append(",\"wakeups_per_s\":").append(oneDecimal(thread.wakeupsPerSecond)).append('}');
+    }
+    out.append("],\"exceeded\":").append(report.anyExceeded() ? "true" : "false").append("}\n");
+    return out;
+  }
+
+  out.append("Self overhead over ").append(oneDecimal(report.seconds)).append(" s (");
+  out.append(QByteArray::number(report.refreshes)).append(" refreshes, ");
+  out.append(ioBackend.toUtf8()).append(" backend)\n");
+  for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+    const auto metric = static_cast<SelfOverhead::Metric>(i);
+    const SelfOverhead::Value &value = report.values[i];
+    out.append("  ").append(SelfOverhead::describe(metric, value).toUtf8());
+    out.append(value.exceeded() ? "  OVER BUDGET\n" : "\n");
+  }
+  out.append("Threads:\n");
+  for (const SelfOverhead::ThreadUsage &thread : report.threads) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-16s tid %-7d CPU %.3f%%  %.1f wakeups/s\n",
+                  qPrintable(thread.name), thread.tid, thread.cpuPercent,
+                  thread.wakeupsPerSecond);
+    out.append(line);
+  }
+  return out;
+}
+
+QByteArray CliSnapshot::usage() {
+  return "Usage: FansController [--once | --watch N | --bench-io N | --watchdog-test N] [--json]\n"
+         "                      [--io-backend plain|io_uring|auto] [--record FILE] | --probe\n"
+         "       FansController --replay FILE [--policy P] [--speed X] [--ramp-rate R]\n"
+         "                      [--json]\n"
+         "       FansController --simulate [--policy P]... [--profile L]... [--scenarios N]\n"
+         "                      [--seed S] [--duration SEC] [--ramp-rate R] [--json]\n"
+         "  --once          Read all sensors once and exit (default when --json is given).\n"
+         "  --watch N       Read sensors every N seconds until interrupted.\n"
+         "  --json          Print one JSON object per reading instead of text.\n"
+         "  --bench-io N    Time N sensor refreshes with each sysfs read backend and\n"
+         "                  report syscalls and wall time per refresh.\n"
+         "  --io-backend B  Sysfs read backend (default auto: io_uring when available;\n"
+         "                  also settable with FANS_CONTROLLER_IO_BACKEND).\n"
+         "  --bench-history N\n"
+         "                  Fill the compressed 24 h sensor history with N synthetic\n"
+         "                  channels and report bytes/value, decode and zoom-out speed.\n"
+         "  --watchdog-test N\n"
+         "                  Trip the fan watchdog N times against a fake hwmon directory\n"
+         "                  and report the measured worst-case reaction time.\n"
+         "  --record FILE   Record every raw sysfs read/write with timestamps to FILE\n"
+         "                  (also works for the GUI; same as FANS_CONTROLLER_TRACE=FILE).\n"
+         "  --replay FILE   Feed a recorded trace through the current fan control path and\n"
+         "                  report fan energy, peak temperature and PWM writes. With one\n"
+         "                  --policy P, setpoints are computed from the replayed\n"
+         "                  temperatures instead of the recorded ones.\n"
+         "  --speed X       Replay speed: 1 = real time, 1000 = 1000x (default: unthrottled).\n"
+         "  --ramp-rate R   PWM ramp rate in %/s for replay/simulation (0 = no ramp).\n"
+         "  --simulate      Run fan policies against a simulated thermal plant (no hardware)\n"
+         "                  faster than real time and report mean peak temperature, time\n"
+         "                  above 90 C, throttling, fan energy and PWM writes.\n"
+         "  --policy P      auto, silent, performance, turbo, safe, fixed:N or curve:T0:P0:T1:P1\n"
+         "                  (repeatable; default: auto, silent, performance, turbo).\n"
+         "  --profile L     Load profile: idle, burst, sustained, gaming, compile\n"
+         "                  (repeatable; default: --scenarios random profiles from --seed).\n"
+         "  --duration SEC  Simulated seconds per scenario, 1..604800 (default 600).\n"
+         "  --serve [ADDR:]PORT\n"
+         "                  Stream one JSON snapshot per --watch interval (default 1 s) to\n"
+         "                  every TCP client on PORT (ADDR defaults to 127.0.0.1).\n"
+         "  --sim-instances N\n"
+         "                  With --serve: serve N simulated machines on PORT..PORT+N-1\n"
+         "                  instead of the real sensors (machine 1 has a clogged heatsink).\n"
+         "  --aggregate E   Merge snapshot streams from many instances (comma-separated\n"
+         "                  host:port or host:port-port2, repeatable) into per-second\n"
+         "                  fleet percentiles, outlier machines and a host x sensor table.\n"
+         "  --aggregate-sim N\n"
+         "                  Spawn N simulated instances on 127.0.0.1:47000.. and aggregate.\n"
+         "  --overhead SEC  Run the sensor sampler as the GUI does for SEC seconds and report\n"
+         "                  the app's own CPU (per thread), wakeups/s, syscalls, sysfs reads\n"
+         "                  and heap allocations per refresh, and RSS against budgets.\n"
+         "                  Exits with 1 when a budget is exceeded.\n"
+         "  --budget SPEC   Override budgets, e.g. cpu=0.1,wakeups=20,allocations=256\n"
+         "                  (also for the GUI; same as FANS_CONTROLLER_BUDGETS=SPEC).\n"
+         "  --probe         Re-detect hwmon, thermal zones, PWM and DMI model, rewrite\n"
+         "                  the capability manifest and print a report.\n"
+         "\n"
+         "Without these options the graphical interface is started. GUI-only options:\n"
+         "  --tray          Start the GUI hidden in the system tray.\n";
+}
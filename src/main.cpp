@@ -1,6 +1,13 @@
 #include "main.h"
 
 int main(int argc, char *argv[]) {
+  // Che do dong lenh (--once/--watch/--json) duoc xu ly truoc khi tao QApplication:
+  // khong can display, khong nap stylesheet, chi doc sensor va in ket qua.
+  CliSnapshot::Options cliOptions;
+  if (CliSnapshot::parseArguments(argc, argv, &cliOptions)) {
+    return CliSnapshot::run(cliOptions);
+  }
+
   // Khoi tao QApplication (bat buoc cho ung dung Qt Widgets).
   QApplication app(argc, argv);
 
@@ -10,7 +17,10 @@ int main(int argc, char *argv[]) {
   // Tao cua so chinh va hien thi. Logic can giua man hinh duoc xu ly trong
   // MainWindow::showEvent de dam bao kich thuoc cuoi cung da on dinh.
   MainWindow window;
-  window.show();
+  // --tray: chi hien icon khay; cay widget chi duoc dung lai khi nguoi dung mo cua so.
+  if (!QApplication::arguments().contains("--tray") || !window.enterTrayMode()) {
+    window.show();
+  }
 
   return app.exec();
 }
@@ -0,0 +1,302 @@
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "sensor_history.h"
+
+// Test round trip cua SensorHistory (ctest -R sensor_history): ghi du lieu dung de cham
+// tung nhanh ma hoa (NaN, dung lai cua so leading/trailing zero, 64 bit co nghia, moi
+// bucket delta-of-delta ke ca escape 64 bit, sang chunk moi, het han) roi giai nen va so
+// tung bit voi dau vao. In cac loi ra stderr va tra ve 1 neu co loi.
+namespace {
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+int g_failures = 0;
+
+void fail(const char *test, const QString &what) {
+  ++g_failures;
+  std::fprintf(stderr, "FAIL %s: %s\n", test, qPrintable(what));
+}
+
+double fromBits(quint64 bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// So sanh bit (NaN khac payload, -0.0 va 0.0 la khac nhau).
+bool sameBits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+QStringList labelsFor(int channels) {
+  QStringList labels;
+  for (int c = 0; c < channels; ++c) {
+    labels << QString("ch%1").arg(c);
+  }
+  return labels;
+}
+
+// channels[c][i]: gia tri kenh c o mau i. Ghi toan bo vao mot SensorHistory moi, ky vong
+// chi con lai cac mau tu firstKept (het han) va moi kenh giai nen ra dung tung bit.
+void checkRoundTrip(const char *test, const QVector<qint64> &times,
+                    const QVector<QVector<double>> &channels,
+                    qint64 retentionMs = SensorHistory::kDefaultRetentionMs, int firstKept = 0) {
+  SensorHistory history(retentionMs);
+  history.setChannels(labelsFor(static_cast<int>(channels.size())));
+  for (qsizetype i = 0; i < times.size(); ++i) {
+    QVector<double> row;
+    for (const QVector<double> &channel : channels) {
+      row.append(channel[i]);
+    }
+    if (!history.append(times[i], row)) {
+      fail(test, QString("append() tu choi mau %1").arg(i));
+      return;
+    }
+  }
+  if (history.firstTimestampMs() != times[firstKept] ||
+      history.lastTimestampMs() != times.last()) {
+    fail(test, QString("khoang giu [%1, %2], ky vong [%3, %4]")
+                   .arg(history.firstTimestampMs())
+                   .arg(history.lastTimestampMs())
+                   .arg(times[firstKept])
+                   .arg(times.last()));
+  }
+
+  for (qsizetype c = 0; c < channels.size(); ++c) {
+    QVector<qint64> decodedTimes;
+    QVector<double> decodedValues;
+    history.samples(static_cast<int>(c), times.first(), times.last() + 1, &decodedTimes,
+                    &decodedValues);
+    if (decodedTimes.size() != times.size() - firstKept ||
+        decodedValues.size() != decodedTimes.size()) {
+      fail(test, QString("kenh %1: giai nen %2 mau, ky vong %3")
+                     .arg(c)
+                     .arg(decodedTimes.size())
+                     .arg(times.size() - firstKept));
+      continue;
+    }
+    for (qsizetype i = 0; i < decodedTimes.size(); ++i) {
+      const qsizetype source = firstKept + i;
+      if (decodedTimes[i] != times[source] ||
+          !sameBits(decodedValues[i], channels[c][source])) {
+        fail(test, QString("kenh %1 mau %2: (%3, %4), ky vong (%5, %6)")
+                       .arg(c)
+                       .arg(source)
+                       .arg(decodedTimes[i])
+                       .arg(decodedValues[i], 0, 'g', 17)
+                       .arg(times[source])
+                       .arg(channels[c][source], 0, 'g', 17));
+        break;
+      }
+    }
+  }
+}
+
+QVector<qint64> regularTimes(int count, qint64 stepMs) {
+  QVector<qint64> times;
+  for (int i = 0; i < count; ++i) {
+    times.append(1700000000000LL + i * stepMs);
+  }
+  return times;
+}
+
+// Mau loi o mau dau chunk, lien tiep, xen ke; NaN co payload khac, vo cuc, +-0.
+void testNanDropouts() {
+  const QVector<double> values = {kNaN, kNaN, 40.0, kNaN, kNaN, 41.0, fromBits(0x7ff8000000000001ULL),
+                                  -0.0, 0.0, kInfinity, -kInfinity, 40.0, kNaN};
+  checkRoundTrip("nan_dropouts", regularTimes(static_cast<int>(values.size()), 1000), {values});
+}
+
+// 50 -> 51 mo cua so, cac thay doi sau nam trong cua so do ('10'), roi mot thay doi
+// rong hon bat buoc mo cua so moi ('11').
+void testWindowReuse() {
+  const QVector<double> values = {50.0, 51.0, 50.0, 51.0, 50.5, 50.0, 50.0, 1e-300, 50.0, 51.0};
+  checkRoundTrip("window_reuse", regularTimes(static_cast<int>(values.size()), 1000), {values});
+}
+
+// XOR 0x8000000000000001: khong co leading/trailing zero, 64 bit co nghia (ghi thanh 0
+// trong 6 bit); lap lai thi dung lai cua so 64 bit.
+void testMeaningful64() {
+  const QVector<double> values = {fromBits(0x1ULL), fromBits(0x8000000000000000ULL),
+                                  fromBits(0x1ULL), fromBits(0x8000000000000000ULL),
+                                  fromBits(0xffffffffffffffffULL), fromBits(0x0ULL)};
+  checkRoundTrip("meaningful_64", regularTimes(static_cast<int>(values.size()), 1000), {values});
+}
+
+// Moi bien cua ba bucket ('10'+7: [-63, 64], '110'+9: [-255, 256], '1110'+12:
+// [-2047, 2048]), gia tri ngay ngoai bien, va escape '1111'+64 ca duong lan am.
+void testDeltaOfDeltaBuckets() {
+  const qint64 dods[] = {0,     1,     -1,    64,    -63,   65,    -64,   256,   -255,
+                         257,   -256,  2048,  -2047, 2049,  -2048, 5000,  -5000, 0,
+                         1000000000LL, -1000000000LL, 1LL << 40, -(1LL << 40)};
+  QVector<qint64> times = {1700000000000LL};
+  // Delta dau tien cua chunk so voi 0 (cung la escape); du lon de delta khong am.
+  qint64 delta = 1000000;
+  times.append(times.last() + delta);
+  for (const qint64 dod : dods) {
+    delta += dod;
+    times.append(times.last() + delta);
+  }
+  // Delta 0 (hai mau cung timestamp) sau mot delta lon: dod am rat lon.
+  times.append(times.last());
+  times.append(times.last() + 1);
+  QVector<double> values;
+  for (qsizetype i = 0; i < times.size(); ++i) {
+    values.append(40.0 + (i % 3));
+  }
+  checkRoundTrip("delta_of_delta", times, {values});
+}
+
+// Chu ky 1 s co jitter vai ms qua nhieu chunk; kenh nhiet thay doi cham, kenh RPM nhay.
+QVector<qint64> jitteredTimes(int count) {
+  QVector<qint64> times;
+  for (int i = 0; i < count; ++i) {
+    times.append(1700000000000LL + i * 1000LL + ((i * 7919) % 7) - 3);
+  }
+  return times;
+}
+
+QVector<QVector<double>> jitteredChannels(int count) {
+  QVector<QVector<double>> channels(3);
+  for (int i = 0; i < count; ++i) {
+    channels[0].append(i % 97 == 5 ? kNaN : 45.0 + ((i / 13) % 20) * 0.5);
+    channels[1].append(std::round(60.0 + 15.0 * std::sin(i / 50.0)));
+    channels[2].append(i % 40 < 20 ? 0.0 : 2400.0 + (i % 11) * 37.0);
+  }
+  return channels;
+}
+
+void testChunkRollover() {
+  const int count = 3 * SensorHistory::kSamplesPerChunk + 17;
+  checkRoundTrip("chunk_rollover", jitteredTimes(count), jitteredChannels(count));
+
+  SensorHistory history;
+  history.setChannels(labelsFor(1));
+  for (int i = 0; i < count; ++i) {
+    history.append(i * 1000LL, {static_cast<double>(i)});
+  }
+  const SensorHistory::Stats stats = history.stats();
+  if (stats.chunks != 4 || stats.samples != static_cast<quint64>(count)) {
+    fail("chunk_rollover", QString("%1 chunk, %2 mau; ky vong 4 chunk, %3 mau")
+                               .arg(stats.chunks)
+                               .arg(stats.samples)
+                               .arg(count));
+  }
+}
+
+// Retention 600 s voi 2000 mau 1 Hz: chunk bi bo nguyen khoi khi mau cuoi cua no cu hon
+// retention, chunk con lai dau tien bat dau o boi so cua kSamplesPerChunk.
+void testExpiry() {
+  const int count = 2000;
+  const qint64 retentionMs = 600000;
+  const QVector<qint64> times = jitteredTimes(count);
+  int firstKept = 0;
+  while (times[std::min(count - 1, firstKept + SensorHistory::kSamplesPerChunk - 1)] <
+         times.last() - retentionMs) {
+    firstKept += SensorHistory::kSamplesPerChunk;
+  }
+  checkRoundTrip("expiry", times, jitteredChannels(count), retentionMs, firstKept);
+}
+
+void testAppendRejects() {
+  SensorHistory history;
+  history.setChannels(labelsFor(2));
+  if (!history.append(1000, {1.0, 2.0}) || !history.append(1000, {1.0, 2.0})) {
+    fail("append_rejects", "timestamp bang mau truoc phai duoc nhan");
+  }
+  if (history.append(999, {1.0, 2.0})) {
+    fail("append_rejects", "timestamp lui phai bi tu choi");
+  }
+  if (history.append(2000, {1.0})) {
+    fail("append_rejects", "so gia tri khong khop phai bi tu choi");
+  }
+  if (history.stats().samples != 2 || history.lastTimestampMs() != 1000) {
+    fail("append_rejects", "mau bi tu choi van duoc ghi");
+  }
+  history.setChannels(labelsFor(3));
+  if (history.stats().samples != 0) {
+    fail("append_rejects", "doi kenh phai xoa lich su");
+  }
+}
+
+// aggregate() (dung min/max luu san cua chunk khi duoc) so voi tinh truc tiep.
+void testAggregate() {
+  const int count = 5 * SensorHistory::kSamplesPerChunk + 3;
+  const QVector<qint64> times = jitteredTimes(count);
+  const QVector<QVector<double>> channels = jitteredChannels(count);
+  SensorHistory history;
+  history.setChannels(labelsFor(static_cast<int>(channels.size())));
+  for (int i = 0; i < count; ++i) {
+    history.append(times[i], {channels[0][i], channels[1][i], channels[2][i]});
+  }
+
+  const qint64 fromMs = times[100] + 1;
+  const qint64 toMs = times[count - 50];
+  for (const int buckets : {1, 3, 37, 1000}) {
+    const double width = static_cast<double>(toMs - fromMs) / buckets;
+    for (int c = 0; c < static_cast<int>(channels.size()); ++c) {
+      QVector<SensorHistory::Bucket> expected(buckets, {kInfinity, -kInfinity, 0});
+      for (int i = 0; i < count; ++i) {
+        if (times[i] < fromMs || times[i] >= toMs) {
+          continue;
+        }
+        SensorHistory::Bucket &bucket =
+            expected[std::min(buckets - 1, static_cast<int>((times[i] - fromMs) / width))];
+        bucket.minimum = std::fmin(bucket.minimum, channels[c][i]);
+        bucket.maximum = std::fmax(bucket.maximum, channels[c][i]);
+        ++bucket.count;
+      }
+      const QVector<SensorHistory::Bucket> actual = history.aggregate(c, fromMs, toMs, buckets);
+      for (int b = 0; b < buckets; ++b) {
+        SensorHistory::Bucket want = expected[b];
+        if (want.minimum > want.maximum) {
+          want.minimum = kNaN;
+          want.maximum = kNaN;
+        }
+        const SensorHistory::Bucket &got = actual.value(b, {0.0, 0.0, -1});
+        if (got.count != want.count || !sameBits(got.minimum, want.minimum) ||
+            !sameBits(got.maximum, want.maximum)) {
+          fail("aggregate", QString("%1 bucket, kenh %2, bucket %3: (%4, %5, %6), ky vong "
+                                    "(%7, %8, %9)")
+                                .arg(buckets)
+                                .arg(c)
+                                .arg(b)
+                                .arg(got.minimum)
+                                .arg(got.maximum)
+                                .arg(got.count)
+                                .arg(want.minimum)
+                                .arg(want.maximum)
+                                .arg(want.count));
+          break;
+        }
+      }
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  testNanDropouts();
+  testWindowReuse();
+  testMeaningful64();
+  testDeltaOfDeltaBuckets();
+  testChunkRollover();
+  testExpiry();
+  testAppendRejects();
+  testAggregate();
+  if (g_failures > 0) {
+    std::fprintf(stderr, "%d loi\n", g_failures);
+    return 1;
+  }
+  std::printf("sensor_history: OK\n");
+  return 0;
+}
@@ -0,0 +1,229 @@
+#include "ui_bench.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QSlider>
+#include <QString>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "mainwindow.h"
+#include "process_footprint.h"
+
+namespace {
+const int kSensorCounts[] = {6, 60, 600};
+const int kRatesHz[] = {1, 4, 10};
+constexpr int kStyleSheetRuns = 5;
+constexpr int kMinFramesPerCase = 3;
+
+// Nguong cua test: moi khung cap nhat/buoc slider (p95) phai xong trong mot khung 60 Hz;
+// dung cua so + lan ve dau va doi stylesheet chi xay ra khi mo/khoi phuc tu khay.
+constexpr double kFrameBudgetUs = 16667.0;
+constexpr double kFirstPaintBudgetMs = 2000.0;
+constexpr double kStyleSheetBudgetUs = 200000.0;
+
+QByteArray number(double value) {
+  return QByteArray::number(value, 'f', 1);
+}
+}  // namespace
+
+UiBench::Result UiBench::run(double secondsPerCase) {
+  Result result;
+  result.secondsPerCase = secondsPerCase;
+
+  // Chi do du lieu tong hop: khong sampler, watchdog hay quy tac tien trinh. Lan ve dau
+  // tien gom expose + layout + paint.
+  MainWindow::Options options;
+  options.liveSensors = false;
+  options.fanWatchdog = false;
+  options.processRules = false;
+  QElapsedTimer clock;
+  clock.start();
+  auto window = std::make_unique<MainWindow>(options);
+  result.constructMs = clock.nsecsElapsed() / 1e6;
+  window->show();
+  QCoreApplication::processEvents();
+  result.firstPaintMs = clock.nsecsElapsed() / 1e6;
+
+  QVector<qint64> styleNs;
+  for (int i = 0; i < kStyleSheetRuns; ++i) {
+    QElapsedTimer timer;
+    timer.start();
+    window->applyStyleSheet();
+    QCoreApplication::processEvents();
+    styleNs.append(timer.nsecsElapsed());
+  }
+  result.stylesheet = summarize(styleNs);
+
+  int frame = 0;
+  for (const int sensors : kSensorCounts) {
+    // Khung dau tien sau khi doi so sensor gom ca them/xoa dong: do rieng.
+    const QVector<TufGamingFx705ge::TemperatureSample> first = syntheticSamples(sensors, frame);
+    QElapsedTimer resizeTimer;
+    resizeTimer.start();
+    window->updateDetailList(first);
+    QCoreApplication::processEvents();
+    const qint64 resizeNs = resizeTimer.nsecsElapsed();
+    ++frame;
+
+    for (const int rateHz : kRatesHz) {
+      const int frames = std::max(kMinFramesPerCase,
+                                  static_cast<int>(std::lround(rateHz * secondsPerCase)));
+      QVector<qint64> frameNs;
+      QEventLoop loop;
+      QTimer ticker;
+      ticker.setTimerType(Qt::PreciseTimer);
+      ticker.setInterval(1000 / rateHz);
+      // Moi khung: cap nhat widget roi xu ly su kien (layout, UpdateRequest, paint). Du
+      // lieu tong hop tao truoc khi bat dong ho de chi do phan UI.
+      QObject::connect(&ticker, &QTimer::timeout, &loop, [&]() {
+        const QVector<TufGamingFx705ge::TemperatureSample> samples =
+            syntheticSamples(sensors, frame);
+        QElapsedTimer timer;
+        timer.start();
+        pushFrame(*window, frame, samples);
+        QCoreApplication::processEvents();
+        frameNs.append(timer.nsecsElapsed());
+        ++frame;
+        if (frameNs.size() >= frames) {
+          loop.quit();
+        }
+      });
+      const ProcessFootprint before = ProcessFootprint::sample();
+      QElapsedTimer wall;
+      wall.start();
+      ticker.start();
+      loop.exec();
+      ticker.stop();
+      const double wallUs = wall.nsecsElapsed() / 1000.0;
+      const ProcessFootprint after = ProcessFootprint::sample();
+
+      UpdateCase update;
+      update.sensors = sensors;
+      update.rateHz = rateHz;
+      update.resizeUs = resizeNs / 1000.0;
+      update.frame = summarize(frameNs);
+      update.busyPercent = 100.0 * update.frame.totalUs / wallUs;
+      update.processCpuPercent = 100.0 * (after.cpuUs - before.cpuUs) / wallUs;
+      result.updates.append(update);
+    }
+  }
+
+  // Keo slider 0 -> 100 -> 0: valueChanged (nhan %, nut Custom) + dong bo nut preset.
+  QVector<qint64> sliderNs;
+  for (int step = 0; step <= 200; ++step) {
+    const int percent = step <= 100 ? step : 200 - step;
+    QElapsedTimer timer;
+    timer.start();
+    window->m_fixedSpeedSlider->setValue(percent);
+    window->syncModeButtonForPercent(percent);
+    QCoreApplication::processEvents();
+    sliderNs.append(timer.nsecsElapsed());
+  }
+  result.slider = summarize(sliderNs);
+  result.rssKb = ProcessFootprint::sample().rssKb;
+  return result;
+}
+
+QByteArray UiBench::toJson(const Result &result) {
+  QByteArray updates;
+  for (const UpdateCase &update : result.updates) {
+    updates.append(updates.isEmpty() ? "" : ",");
+    updates.append("{\"sensors\":").append(QByteArray::number(update.sensors));
+    updates.append(",\"rate_hz\":").append(QByteArray::number(update.rateHz));
+    updates.append(",\"resize_us\":").append(number(update.resizeUs));
+    updates.append(",\"frame\":").append(summaryJson(update.frame));
+    updates.append(",\"busy_percent\":").append(number(update.busyPercent));
+    updates.append(",\"process_cpu_percent\":").append(number(update.processCpuPercent));
+    updates.append('}');
+  }
+
+  QByteArray out("{\"platform\":\"");
+  out.append(QGuiApplication::platformName().toUtf8()).append('"');
+  out.append(",\"seconds_per_case\":").append(number(result.secondsPerCase));
+  out.append(",\"construct_ms\":").append(number(result.constructMs));
+  out.append(",\"first_paint_ms\":").append(number(result.firstPaintMs));
+  out.append(",\"stylesheet\":").append(summaryJson(result.stylesheet));
+  out.append(",\"updates\":[").append(updates).append(']');
+  out.append(",\"slider\":").append(summaryJson(result.slider));
+  out.append(",\"rss_kb\":").append(QByteArray::number(result.rssKb));
+  out.append("}\n");
+  return out;
+}
+
+QStringList UiBench::overBudget(const Result &result, double budgetScale) {
+  QStringList failures;
+  const auto check = [&](const QString &what, double value, double budget, const char *unit) {
+    if (value > budget * budgetScale) {
+      failures.append(QString("%1: %2 %3 > %4 %3")
+                          .arg(what, QString::number(value, 'f', 1), QString::fromLatin1(unit),
+                               QString::number(budget * budgetScale, 'f', 1)));
+    }
+  };
+  check("first_paint_ms", result.firstPaintMs, kFirstPaintBudgetMs, "ms");
+  check("stylesheet mean", result.stylesheet.meanUs, kStyleSheetBudgetUs, "us");
+  for (const UpdateCase &update : result.updates) {
+    check(QString("frame p95 (%1 sensors, %2 Hz)").arg(update.sensors).arg(update.rateHz),
+          update.frame.p95Us, kFrameBudgetUs, "us");
+  }
+  check("slider p95", result.slider.p95Us, kFrameBudgetUs, "us");
+  return failures;
+}
+
+UiBench::Summary UiBench::summarize(QVector<qint64> samplesNs) {
+  Summary summary;
+  if (samplesNs.isEmpty()) {
+    return summary;
+  }
+  std::sort(samplesNs.begin(), samplesNs.end());
+  const auto percentile = [&samplesNs](double p) {
+    const qsizetype index = static_cast<qsizetype>(std::ceil(p * samplesNs.size())) - 1;
+    return samplesNs[std::clamp<qsizetype>(index, 0, samplesNs.size() - 1)] / 1000.0;
+  };
+  qint64 total = 0;
+  for (const qint64 ns : samplesNs) {
+    total += ns;
+  }
+  summary.count = static_cast<int>(samplesNs.size());
+  summary.totalUs = total / 1000.0;
+  summary.meanUs = summary.totalUs / summary.count;
+  summary.p50Us = percentile(0.50);
+  summary.p95Us = percentile(0.95);
+  summary.maxUs = samplesNs.last() / 1000.0;
+  return summary;
+}
+
+QByteArray UiBench::summaryJson(const Summary &summary) {
+  QByteArray out("{\"count\":");
+  out.append(QByteArray::number(summary.count));
+  out.append(",\"mean_us\":").append(number(summary.meanUs));
+  out.append(",\"p50_us\":").append(number(summary.p50Us));
+  out.append(",\"p95_us\":").append(number(summary.p95Us));
+  out.append(",\"max_us\":").append(number(summary.maxUs)).append('}');
+  return out;
+}
+
+QVector<TufGamingFx705ge::TemperatureSample> UiBench::syntheticSamples(int sensors, int frame) {
+  // Nhiet do dao dong qua nhieu muc (cool/info/caution/warning) de co ca doi chu lan
+  // polish lai pill; lech pha theo sensor de khong dong loat.
+  QVector<TufGamingFx705ge::TemperatureSample> samples;
+  samples.reserve(sensors);
+  for (int i = 0; i < sensors; ++i) {
+    const double celsius = 52.0 + 24.0 * std::sin(frame * 0.7 + i * 0.37);
+    samples.append({QString("Sensor %1").arg(i + 1), celsius, true});
+  }
+  return samples;
+}
+
+void UiBench::pushFrame(MainWindow &window, int frame,
+                        const QVector<TufGamingFx705ge::TemperatureSample> &samples) {
+  const double cpuTempC = 55.0 + 25.0 * std::sin(frame * 0.7);
+  const TufGamingFx705ge::FanSample fan{2200 + (frame * 137) % 2400, 50, true};
+  window.updateStatCards(cpuTempC, fan, cpuTempC - 9.0, {});
+  window.updateDetailList(samples);
+}
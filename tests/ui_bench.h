@@ -0,0 +1,67 @@
+#ifndef FANS_CONTROLLER_UI_BENCH_H
+#define FANS_CONTROLLER_UI_BENCH_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include "tuf_gaming_fx705ge.h"
+
+class MainWindow;
+
+// Do hieu nang GUI tren platform "offscreen" (khong can display/GPU):
+//   - thoi gian dung MainWindow, lan ve dau tien va applyStyleSheet();
+//   - chi phi moi khung khi day du lieu sensor tong hop vao ba the thong ke va danh sach
+//     Detailed Readings o 1, 4, 10 Hz voi 6, 60, 600 sensor (gom ca layout + paint);
+//   - keo slider: valueChanged + syncModeButtonForPercent() cho moi buoc.
+// MainWindow duoc dung voi MainWindow::Options tat het (khong sampler, watchdog hay quy
+// tac tien trinh). Chay qua target test ui_bench (ctest); main() cua test phai dat
+// QT_QPA_PLATFORM=offscreen truoc khi tao QApplication.
+class UiBench {
+ public:
+  struct Summary {
+    int count = 0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p95Us = 0.0;
+    double maxUs = 0.0;
+    double totalUs = 0.0;
+  };
+
+  // Mot to hop so sensor x tan so.
+  struct UpdateCase {
+    int sensors = 0;
+    int rateHz = 0;
+    double resizeUs = 0.0;  // Khung dau tien sau khi doi so sensor (them/xoa dong).
+    Summary frame;
+    double busyPercent = 0.0;         // Ty le thoi gian thuc nam trong cac khung.
+    double processCpuPercent = 0.0;
+  };
+
+  struct Result {
+    double secondsPerCase = 0.0;
+    double constructMs = 0.0;
+    double firstPaintMs = 0.0;
+    Summary stylesheet;
+    QVector<UpdateCase> updates;
+    Summary slider;
+    qint64 rssKb = 0;
+  };
+
+  // secondsPerCase: thoi gian chay thuc cho moi to hop so sensor x tan so.
+  static Result run(double secondsPerCase);
+  // Mot object JSON (mot dong) de luu/so sanh giua cac lan build.
+  static QByteArray toJson(const Result &result);
+  // Cac nguong bi vuot (rong = dat). budgetScale nhan moi nguong, cho may CI cham.
+  static QStringList overBudget(const Result &result, double budgetScale);
+
+ private:
+  static Summary summarize(QVector<qint64> samplesNs);
+  static QByteArray summaryJson(const Summary &summary);
+  static QVector<TufGamingFx705ge::TemperatureSample> syntheticSamples(int sensors, int frame);
+  static void pushFrame(MainWindow &window, int frame,
+                        const QVector<TufGamingFx705ge::TemperatureSample> &samples);
+};
+
+#endif  // FANS_CONTROLLER_UI_BENCH_H
@@ -0,0 +1,43 @@
+#include <QApplication>
+#include <QByteArray>
+#include <QStringList>
+
+#include <cmath>
+#include <cstdio>
+
+#include "ui_bench.h"
+
+// Test hieu nang GUI (ctest -R ui_bench): chay UiBench tren platform offscreen, in JSON
+// ra stdout va tra ve 1 neu co nguong bi vuot.
+//   ui_bench [--seconds SEC] [--budget-scale X]
+// SEC: thoi gian cho moi to hop sensor x tan so (mac dinh 0.5); X nhan moi nguong.
+int main(int argc, char *argv[]) {
+  double seconds = 0.5;
+  double budgetScale = 1.0;
+  for (int i = 1; i < argc; ++i) {
+    const QByteArray arg(argv[i]);
+    bool ok = false;
+    const double value = (i + 1 < argc) ? QByteArray(argv[++i]).toDouble(&ok) : 0.0;
+    if (!ok || !std::isfinite(value) || value <= 0.0 ||
+        (arg != "--seconds" && arg != "--budget-scale")) {
+      std::fprintf(stderr, "Usage: ui_bench [--seconds SEC] [--budget-scale X]\n");
+      return 2;
+    }
+    (arg == "--seconds" ? seconds : budgetScale) = value;
+  }
+
+  qputenv("QT_QPA_PLATFORM", "offscreen");
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("Fan Monitoring & Control");
+
+  const UiBench::Result result = UiBench::run(seconds);
+  const QByteArray json = UiBench::toJson(result);
+  std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+  std::fflush(stdout);
+
+  const QStringList failures = UiBench::overBudget(result, budgetScale);
+  for (const QString &failure : failures) {
+    std::fprintf(stderr, "Vuot nguong: %s\n", qPrintable(failure));
+  }
+  return failures.isEmpty() ? 0 : 1;
+}
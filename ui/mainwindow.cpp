@@ -2,14 +2,22 @@
 
 #include <QAbstractButton>
 #include <QApplication>
+#include <QColor>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QFont>
 #include <QFile>
+#include <QGridLayout>
 #include <QGuiApplication>
 #include <QHBoxLayout>
+#include <QIcon>
 #include <QLabel>
+#include <QMenu>
 #include <QMessageBox>
+#include <QPainter>
+#include <QPixmap>
+#include <QPixmapCache>
 #include <QPushButton>
 #include <QRect>
 #include <QScreen>
@@ -18,15 +26,149 @@
 #include <QStringList>
 #include <QSize>
 #include <QSlider>
+#include <QStyle>
 #include <QVBoxLayout>
 
+#include <QMetaObject>
+
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+// Deadband cua SensorBus: the/icon khay chi ve lai khi nhiet lech hon 0.5 do (rung
+// 0.1 do cua sysfs khong repaint), duong cong quy tac dung nhiet CPU lam muot EWMA.
+constexpr double kUiTemperatureDeadbandC = 0.5;
+constexpr double kUiFanDeadbandRpm = 50.0;
+constexpr double kCurveTemperatureDeadbandC = 0.5;
+constexpr double kCurveEwmaAlpha = 0.5;
+
+// Panel Diagnostics do lai chi phi cua app sau moi 10 lan lay mau (di cung sampled(),
+// khong them timer/wakeup rieng); hien toi da 3 thread ton CPU nhat.
+constexpr int kOverheadEverySamples = 10;
+constexpr int kOverheadThreadsShown = 3;
+
+// Ngan sach tu FANS_CONTROLLER_BUDGETS (hoac --budget); spec sai thi dung mac dinh.
+SelfOverhead::Budgets overheadBudgets() {
+  QString error;
+  const SelfOverhead::Budgets budgets = SelfOverhead::Budgets::fromEnvironment(&error);
+  if (!error.isEmpty()) {
+    qWarning("FANS_CONTROLLER_BUDGETS: %s", qPrintable(error));
+  }
+  return budgets;
+}
+
+// Trang thai cua the thong ke theo loi sensor dang bat (rong neu khong co loi khop).
+QString faultStatus(const QVector<SensorAnomalyDetector::Event> &faults,
+                    SensorAnomalyDetector::ChannelKind kind, const QString &label) {
+  for (const SensorAnomalyDetector::Event &fault : faults) {
+    if (fault.kind != kind || (!label.isEmpty() && fault.label != label)) {
+      continue;
+    }
+    switch (fault.fault) {
+      case SensorAnomalyDetector::Fault::Dropout:
+        return "Status: Sensor unreadable";
+      case SensorAnomalyDetector::Fault::Stuck:
+        return "Status: Sensor stuck";
+      case SensorAnomalyDetector::Fault::Spike:
+        return "Status: Implausible reading";
+      case SensorAnomalyDetector::Fault::FanStall:
+        return "Status: Fan stalled";
+      case SensorAnomalyDetector::Fault::FanRpmMismatch:
+        return "Status: RPM does not match PWM";
+    }
+  }
+  return QString();
+}
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
+// Mau nen icon khay theo muc nhiet, cung bang mau voi statIcon/pill trong stylesheet.
+QColor trayColor(const QString &severity) {
+  if (severity == "warning") {
+    return QColor("#f57f32");
+  }
+  if (severity == "caution") {
+    return QColor("#e0a235");
+  }
+  if (severity == "info") {
+    return QColor("#2a78c6");
+  }
+  return QColor("#2faa79");
+}
+}  // namespace
+
+MainWindow::MainWindow(QWidget *parent) : MainWindow(Options(), parent) {}
+
+MainWindow::MainWindow(const Options &options, QWidget *parent)
+    : QMainWindow(parent), m_overhead(overheadBudgets(), m_sampler.overheadCounters()) {
   // Cap nhat cache sensor truoc khi ve UI, sau do nap stylesheet.
   m_device.refreshSensors();
+  m_sliderPercent = m_device.fan().percent;
   buildUi();
   applyStyleSheet();
+
+  // Ket qua ghi PWM tu actor duoc chuyen ve thread GUI qua queued connection.
+  connect(&m_fanActor, &FanCommandActor::commandFinished, this,
+          &MainWindow::handleFanCommandFinished);
+  // Moi lan sampler refresh xong (thread rieng) thi xu ly su kien loi sensor tren thread
+  // GUI; the thong ke va duong cong chi cap nhat khi bus bao gia tri vuot deadband.
+  if (options.liveSensors) {
+    connect(&m_sampler, &SensorSampler::sampled, this, &MainWindow::handleSensorsSampled);
+    subscribeSensorBus();
+  }
+
+  // Khong co rules.conf thi im lang; co nhung khong theo doi duoc tien trinh thi canh bao.
+  if (options.processRules) {
+    connect(&m_profileSwitcher, &ProcessProfileSwitcher::activeRuleChanged, this,
+            &MainWindow::applyProcessRule);
+    QString rulesError;
+    if (!m_profileSwitcher.start(ProcessRules::defaultPath(), &rulesError) &&
+        !rulesError.isEmpty()) {
+      qWarning("Khong the chuyen profile theo tien trinh: %s", qPrintable(rulesError));
+    }
+  }
+
+  if (options.fanWatchdog) {
+    armFanWatchdog();
+  }
+  createTrayIcon();
+  m_modeFootprint = ProcessFootprint::sample();
+}
+
+MainWindow::~MainWindow() {
+  m_heartbeatTimer.stop();
+  m_sampler.bus().unsubscribe(m_uiSubscription);
+  m_sampler.bus().unsubscribe(m_curveSubscription);
+  if (m_watchdog.isArmed()) {
+    const FanWatchdog::Stats stats = m_watchdog.stats();
+    qWarning("Fan watchdog: %llu lan kich hoat, phan ung toi da %lld us, tre danh thuc %lld us "
+             "(can tren %lld us, realtime=%d, mlock=%d)",
+             static_cast<unsigned long long>(stats.trips),
+             static_cast<long long>(stats.maxReactionUs),
+             static_cast<long long>(stats.maxWakeLatenessUs),
+             static_cast<long long>(stats.worstCaseBoundUs(m_watchdog.config().periodMs)),
+             stats.realtime, stats.memoryLocked);
+  }
+}
+
+void MainWindow::armFanWatchdog() {
+  // Chi can watchdog khi co hwmon ASUS de ghi pwm; khong co quyen thi chi canh bao.
+  if (m_device.fanHwmonPath().isEmpty()) {
+    return;
+  }
+  FanWatchdog::Config config;
+  config.hwmonPath = m_device.fanHwmonPath();
+  config.channel = m_device.fanPwmChannel();
+  config.criticalTempPath = m_device.cpuPackageTempPath();
+  config.criticalC = m_device.model().criticalC;
+  QString error;
+  if (!m_watchdog.arm(config, &error)) {
+    qWarning("Khong the bat fan watchdog: %s", qPrintable(error));
+    return;
+  }
+  m_heartbeatTimer.setInterval(config.heartbeatTimeoutMs / 6);
+  connect(&m_heartbeatTimer, &QTimer::timeout, this, [this]() { m_watchdog.heartbeat(); });
+  m_heartbeatTimer.start();
 }
 
 void MainWindow::buildUi() {
@@ -42,6 +184,7 @@ void MainWindow::buildUi() {
   rootLayout->addWidget(createTrendAndDetailsRow());
   rootLayout->addWidget(createFanModeRow());
   rootLayout->addWidget(createFixedSpeedRow());
+  rootLayout->addWidget(createDiagnosticsRow());
   rootLayout->addStretch(1);  // Day cac phan len tren, tao khoang thoang duoi.
 
   setCentralWidget(central);
@@ -82,19 +225,21 @@ QWidget *MainWindow::createStatsRow() {
   // CPU Package
   const double cpuTemp = m_device.cpuPackageTempC();
   const QString cpuSeverity = temperatureSeverity(cpuTemp);
-  layout->addWidget(createStatCard("CPU", "CPU Package", formatTemperature(cpuTemp),
-                                   statusTextForSeverity(cpuSeverity), accentForStat(cpuSeverity)));
+  m_cpuCard = createStatCard("CPU", "CPU Package", formatTemperature(cpuTemp),
+                             statusTextForSeverity(cpuSeverity), accentForStat(cpuSeverity));
+  layout->addWidget(m_cpuCard);
 
   // Fan RPM
   const auto fan = m_device.fan();
-  layout->addWidget(createStatCard("FAN", "Fan RPM", QString::number(fan.rpm),
-                                   "Status: Normal", "ok"));
+  m_fanCard = createStatCard("FAN", "Fan RPM", QString::number(fan.rpm), "Status: Normal", "ok");
+  layout->addWidget(m_fanCard);
 
   // PCH Temperature
   const double pchTemp = m_device.pchTempC();
   const QString pchSeverity = temperatureSeverity(pchTemp);
-  layout->addWidget(createStatCard("PCH", "PCH Temperature", formatTemperature(pchTemp),
-                                   statusTextForSeverity(pchSeverity), accentForStat(pchSeverity)));
+  m_pchCard = createStatCard("PCH", "PCH Temperature", formatTemperature(pchTemp),
+                             statusTextForSeverity(pchSeverity), accentForStat(pchSeverity));
+  layout->addWidget(m_pchCard);
 
   return row;
 }
@@ -140,6 +285,34 @@ QFrame *MainWindow::createStatCard(const QString &iconText, const QString &title
   return card;
 }
 
+void MainWindow::updateStatCard(QFrame *card, const QString &valueText,
+                                const QString &statusText, const QString &accentProperty) {
+  // Cap nhat gia tri/trang thai va polish lai de stylesheet ap dung accent moi.
+  if (!card) {
+    return;
+  }
+  QLabel *icon = card->findChild<QLabel *>("statIcon");
+  QLabel *valueLabel = card->findChild<QLabel *>("statValue");
+  QLabel *statusLabel = card->findChild<QLabel *>("statStatus");
+  if (valueLabel) {
+    valueLabel->setText(valueText);
+  }
+  if (statusLabel) {
+    statusLabel->setText(statusText);
+  }
+  if (card->property("accent").toString() == accentProperty) {
+    return;
+  }
+  for (QWidget *widget : {static_cast<QWidget *>(card), static_cast<QWidget *>(icon),
+                          static_cast<QWidget *>(valueLabel)}) {
+    if (widget) {
+      widget->setProperty("accent", accentProperty);
+      widget->style()->unpolish(widget);
+      widget->style()->polish(widget);
+    }
+  }
+}
+
 QWidget *MainWindow::createTrendAndDetailsRow() {
   // Hang giua gom bieu do nhiet do va danh sach chi tiet.
   QWidget *row = new QWidget(this);
@@ -196,16 +369,11 @@ QWidget *MainWindow::createTrendAndDetailsRow() {
   QVBoxLayout *listLayout = new QVBoxLayout(scrollContent);
   listLayout->setContentsMargins(0, 0, 0, 0);
   listLayout->setSpacing(10);
-
-  const auto detailTemps = m_device.detailTemperatures();
-  for (const auto &sample : detailTemps) {
-    const QString severity = temperatureSeverity(sample.celsius);
-    listLayout->addWidget(
-        createDetailLine(sample.label, formatTemperature(sample.celsius), severity));
-  }
   listLayout->addStretch(1);
 
   scrollContent->setLayout(listLayout);
+  m_detailListLayout = listLayout;
+  updateDetailList(m_device.detailTemperatures());
   scroll->setWidget(scrollContent);
   detailLayout->addWidget(scroll);
 
@@ -215,6 +383,48 @@ QWidget *MainWindow::createTrendAndDetailsRow() {
   return row;
 }
 
+QWidget *MainWindow::createDiagnosticsRow() {
+  // Chi phi cua chinh ung dung (SelfOverhead) so voi ngan sach, moi chi so mot pill.
+  QFrame *card = new QFrame(this);
+  card->setObjectName("sectionCard");
+  QVBoxLayout *layout = new QVBoxLayout(card);
+  layout->setContentsMargins(14, 14, 14, 14);
+  layout->setSpacing(10);
+
+  QLabel *title = new QLabel("Diagnostics", card);
+  title->setObjectName("sectionTitle");
+  QLabel *subtitle = new QLabel(
+      QString("This app's own cost, measured every %1 samples against its budgets.")
+          .arg(kOverheadEverySamples),
+      card);
+  subtitle->setObjectName("sectionSubtitle");
+
+  QWidget *grid = new QWidget(card);
+  QGridLayout *gridLayout = new QGridLayout(grid);
+  gridLayout->setContentsMargins(0, 0, 0, 0);
+  gridLayout->setHorizontalSpacing(24);
+  gridLayout->setVerticalSpacing(8);
+  m_overheadLines.clear();
+  for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+    const auto metric = static_cast<SelfOverhead::Metric>(i);
+    QWidget *line = createDetailLine(QString::fromLatin1(SelfOverhead::metricLabel(metric)),
+                                     "--", "info");
+    gridLayout->addWidget(line, i / 3, i % 3);
+    m_overheadLines.append({line, line->findChild<QLabel *>("detailLabel"),
+                            line->findChild<QLabel *>("pill")});
+  }
+
+  m_overheadThreadsLabel = new QLabel(card);
+  m_overheadThreadsLabel->setObjectName("sectionSubtitle");
+
+  layout->addWidget(title);
+  layout->addWidget(subtitle);
+  layout->addWidget(grid);
+  layout->addWidget(m_overheadThreadsLabel);
+  updateDiagnostics();
+  return card;
+}
+
 QWidget *MainWindow::createDetailLine(const QString &label, const QString &value,
                                       const QString &severityProperty) {
   // Tao mot dong thong tin voi nhan va vien mau hien thi muc do nhiet.
@@ -316,11 +526,12 @@ QWidget *MainWindow::createFixedSpeedRow() {
 
   m_fixedSpeedSlider = new QSlider(Qt::Horizontal, controlRow);
   m_fixedSpeedSlider->setRange(0, 100);
-  m_fixedSpeedSlider->setValue(m_device.fan().percent);
+  m_fixedSpeedSlider->setValue(m_sliderPercent);
   m_fixedSpeedSlider->setObjectName("speedSlider");
 
   // Cap nhat nhan % khi keo slider.
   connect(m_fixedSpeedSlider, &QSlider::valueChanged, this, [this](int value) {
+    m_sliderPercent = value;
     if (m_fixedSpeedValueLabel) {
       m_fixedSpeedValueLabel->setText(QString::number(value) + "%");
     }
@@ -335,16 +546,15 @@ QWidget *MainWindow::createFixedSpeedRow() {
   controlLayout->addWidget(m_fixedSpeedSlider, 1);
   controlLayout->addWidget(applyBtn);
 
-  // Ap dung gia tri slider hien tai xuong thiet bi.
+  // Ap dung gia tri slider hien tai xuong thiet bi (khong block GUI, xem FanCommandActor).
   connect(applyBtn, &QPushButton::clicked, this, [this]() {
-    if (!m_device.setFixedFanPercent(m_fixedSpeedSlider->value())) {
-      qWarning("Khong the dat toc do quat co dinh");
-      showPwmErrorDialog("Cannot set fixed fan speed");
-    }
+    dropProcessRuleOverride();
+    m_pendingCommandTitle = "Cannot set fixed fan speed";
+    m_fanActor.submitFixedPercent(m_fixedSpeedSlider->value());
   });
 
-  // Dat gia tri ban dau theo cache sensor.
-  m_fixedSpeedValueLabel->setText(QString::number(m_device.fan().percent) + "%");
+  // Dat gia tri ban dau theo cache sensor (hoac gia tri truoc khi xuong khay).
+  m_fixedSpeedValueLabel->setText(QString::number(m_sliderPercent) + "%");
   syncModeButtonForPercent(m_fixedSpeedSlider->value());
 
   layout->addWidget(header);
@@ -361,67 +571,311 @@ void MainWindow::handleModeSelected(int buttonId) {
   if (!button) {
     return;
   }
+  m_modeName = button->text();
 
-  const QString modeName = button->text();
-  int targetPercent = -1;
-  if (modeName.compare("Silent", Qt::CaseInsensitive) == 0) {
-    targetPercent = 0;
-  } else if (modeName.compare("Performance", Qt::CaseInsensitive) == 0) {
-    targetPercent = 50;
-  } else if (modeName.compare("Turbo", Qt::CaseInsensitive) == 0) {
-    targetPercent = 100;
-  }
-
+  const int targetPercent = modePercent(button->text());
   if (targetPercent < 0) {
     return;  // Custom: khong ep gia tri slider hay PWM.
   }
 
+  // Nguoi dung tu chon thi uu tien hon quy tac tien trinh dang ap dung.
+  dropProcessRuleOverride();
+  setSliderPercent(targetPercent);
+  applyPresetPercent(targetPercent);
+}
+
+// % cua nut Fan Mode theo profile cua may (TufGamingFx705ge::presetPercent, cung bang
+// voi FanPolicy); -1 voi Custom/ten khac.
+int MainWindow::modePercent(const QString &modeName) const {
+  return TufGamingFx705ge::presetPercent(modeName, m_device.model());
+}
+
+// Dat slider bang code ma khong chuyen nut sang Custom.
+void MainWindow::setSliderPercent(int percent) {
+  m_sliderPercent = percent;
   m_updatingFromPreset = true;
   if (m_fixedSpeedSlider) {
-    m_fixedSpeedSlider->setValue(targetPercent);
+    m_fixedSpeedSlider->setValue(percent);
   }
   m_updatingFromPreset = false;
-
-  applyPresetPercent(targetPercent);
 }
 
-// Goi vao lop thiet bi de dat phan tram PWM, dong thoi cap nhat nhan hien thi.
+// Gui phan tram PWM cho actor dieu khien quat, dong thoi cap nhat nhan hien thi.
 void MainWindow::applyPresetPercent(int percent) {
   const int clamped = std::clamp(percent, 0, 100);
-  const bool ok = m_device.setFixedFanPercent(clamped);
-  if (!ok) {
-    qWarning("Khong the dat toc do quat preset");
-    showPwmErrorDialog("Cannot set fan preset");
-  }
+  m_pendingCommandTitle = "Cannot set fan preset";
+  m_fanActor.submitFixedPercent(clamped);
 
   if (m_fixedSpeedValueLabel) {
     m_fixedSpeedValueLabel->setText(QString::number(clamped) + "%");
   }
 }
 
-// Dat lai nut preset theo gia tri % hien co (0, 50, 100 thi map preset, khac se
-// chon Custom).
+// Dat lai nut preset theo gia tri % hien co (trung % cua preset trong profile thi chon
+// preset do, khac se chon Custom).
 void MainWindow::syncModeButtonForPercent(int percent) {
-  if (percent == 0) {
-    selectModeButton("Silent");
-  } else if (percent == 50) {
-    selectModeButton("Performance");
-  } else if (percent == 100) {
-    selectModeButton("Turbo");
-  } else {
-    selectModeButton("Custom");
+  for (const char *mode : {"Silent", "Performance", "Turbo"}) {
+    if (modePercent(mode) == percent) {
+      selectModeButton(mode);
+      return;
+    }
+  }
+  selectModeButton("Custom");
+}
+
+// Nhan ket qua lenh ghi PWM (da ve thread GUI) va canh bao neu that bai.
+void MainWindow::handleFanCommandFinished(const TufGamingFx705ge::FanCommandResult &result) {
+  if (result.ok) {
+    return;
+  }
+  qWarning("Khong the dat toc do quat %d%%: %s", result.percent, qPrintable(result.error));
+  showPwmErrorDialog(m_pendingCommandTitle, result.error);
+}
+
+// Dang ky hai consumer tren SensorBus. Callback chay tren thread sampler nen chi chuyen
+// viec ve thread GUI; mau khong vuot deadband khong tao event nao.
+void MainWindow::subscribeSensorBus() {
+  SensorBus::Filter ui;
+  ui.temperatureDeadbandC = kUiTemperatureDeadbandC;
+  ui.fanDeadbandRpm = kUiFanDeadbandRpm;
+  m_uiSubscription = m_sampler.bus().subscribe("ui", ui, [this](const SensorBus::Update &) {
+    QMetaObject::invokeMethod(this, [this]() { handleSensorsChanged(); }, Qt::QueuedConnection);
+  });
+
+  // Kenh 0 la "CPU Package" (thu tu kenh cua SensorSampler).
+  SensorBus::Filter curve;
+  curve.temperatureDeadbandC = kCurveTemperatureDeadbandC;
+  curve.ewmaAlpha = kCurveEwmaAlpha;
+  curve.channels = QStringList{"CPU Package"};
+  m_curveSubscription =
+      m_sampler.bus().subscribe("rule-curve", curve, [this](const SensorBus::Update &update) {
+        const double cpuTempC = update.values.value(0, std::nan(""));
+        QMetaObject::invokeMethod(this, [this, cpuTempC]() { applyRuleCurve(cpuTempC); },
+                                  Qt::QueuedConnection);
+      });
+}
+
+// Lay mau moi tu SensorSampler: ghi log su kien loi sensor; loi bat/tat doi dong trang
+// thai tren the nen ve lai ngay ca khi gia tri chua vuot deadband.
+void MainWindow::handleSensorsSampled() {
+  bool faultsChanged = false;
+  for (const SensorAnomalyDetector::Event &event : m_device.takeSensorFaultEvents()) {
+    qWarning("Sensor: %s", qPrintable(SensorAnomalyDetector::describe(event)));
+    faultsChanged = true;
+  }
+  if (faultsChanged) {
+    handleSensorsChanged();
+  }
+  if (++m_samplesSinceOverhead >= kOverheadEverySamples) {
+    m_samplesSinceOverhead = 0;
+    sampleOverhead();
+  }
+}
+
+// Do chi phi cua app tu lan truoc; canh bao mot lan moi khi mot chi so bat dau vuot
+// ngan sach (khong lap lai moi lan do khi van vuot).
+void MainWindow::sampleOverhead() {
+  m_lastOverhead = m_overhead.sample(m_sampler.overheadCounters());
+  for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+    const bool exceeded = m_lastOverhead.values[i].exceeded();
+    if (exceeded && !m_overheadExceeded[i]) {
+      qWarning("Vuot ngan sach: %s",
+               qPrintable(SelfOverhead::describe(static_cast<SelfOverhead::Metric>(i),
+                                                 m_lastOverhead.values[i])));
+    }
+    m_overheadExceeded[i] = exceeded;
+  }
+  if (!m_trayMode) {
+    updateDiagnostics();
   }
 }
 
+// Dua bao cao SelfOverhead gan nhat len panel Diagnostics (neu cua so con ton tai).
+void MainWindow::updateDiagnostics() {
+  if (m_overheadLines.isEmpty()) {
+    return;
+  }
+  const bool measured = m_lastOverhead.seconds > 0.0;
+  for (int i = 0; i < SelfOverhead::kMetricCount; ++i) {
+    const auto metric = static_cast<SelfOverhead::Metric>(i);
+    const SelfOverhead::Value &value = m_lastOverhead.values[i];
+    const DetailLine &line = m_overheadLines[i];
+    QString text = "--";
+    if (measured && value.available) {
+      text = SelfOverhead::formatValue(metric, value.value);
+    }
+    if (line.pill->text() != text) {
+      line.pill->setText(text);
+      line.pill->setToolTip(measured ? SelfOverhead::describe(metric, value) : QString());
+    }
+    const QString severity = !measured || !value.available ? "info"
+                             : value.exceeded()           ? "warning"
+                                                          : "cool";
+    if (line.pill->property("severity").toString() != severity) {
+      line.pill->setProperty("severity", severity);
+      line.pill->style()->unpolish(line.pill);
+      line.pill->style()->polish(line.pill);
+    }
+  }
+
+  QStringList threads;
+  for (const SelfOverhead::ThreadUsage &thread : m_lastOverhead.threads) {
+    if (threads.size() == kOverheadThreadsShown) {
+      break;
+    }
+    threads.append(QString("%1 %2%").arg(thread.name).arg(thread.cpuPercent, 0, 'f', 3));
+  }
+  m_overheadThreadsLabel->setText(measured ? "Top threads: " + threads.join(", ")
+                                           : "Measuring...");
+}
+
+// Co kenh vuot deadband cua UI: cap nhat icon khay, ba the thong ke va Detailed Readings
+// (khi cua so con ton tai) tu cache sensor moi nhat.
+void MainWindow::handleSensorsChanged() {
+  updateTrayIcon();
+  if (!m_trayMode) {
+    updateStatCards();
+  }
+}
+
+// Dua cache sensor moi nhat len the thong ke va danh sach chi tiet.
+void MainWindow::updateStatCards() {
+  updateStatCards(m_device.cpuPackageTempC(), m_device.fan(), m_device.pchTempC(),
+                  m_device.sensorFaults());
+  updateDetailList(m_device.detailTemperatures());
+}
+
+// Cap nhat ba the tu gia tri cho truoc (cache sensor hoac du lieu tong hop cua UiBench).
+void MainWindow::updateStatCards(double cpuTemp, const TufGamingFx705ge::FanSample &fan,
+                                 double pchTemp,
+                                 const QVector<SensorAnomalyDetector::Event> &faults) {
+  using Kind = SensorAnomalyDetector::ChannelKind;
+
+  const QString cpuSeverity = temperatureSeverity(cpuTemp);
+  const QString cpuFault = faultStatus(faults, Kind::Temperature, "CPU Package");
+  updateStatCard(m_cpuCard, formatTemperature(cpuTemp),
+                 cpuFault.isEmpty() ? statusTextForSeverity(cpuSeverity) : cpuFault,
+                 cpuFault.isEmpty() ? accentForStat(cpuSeverity) : "warning");
+
+  const QString fanFault = faultStatus(faults, Kind::Fan, QString());
+  updateStatCard(m_fanCard, fan.rpmValid ? QString::number(fan.rpm) : "--",
+                 fanFault.isEmpty() ? "Status: Normal" : fanFault,
+                 fanFault.isEmpty() ? "ok" : "warning");
+
+  const QString pchSeverity = temperatureSeverity(pchTemp);
+  const QString pchFault = faultStatus(faults, Kind::Temperature, "PCH");
+  updateStatCard(m_pchCard, formatTemperature(pchTemp),
+                 pchFault.isEmpty() ? statusTextForSeverity(pchSeverity) : pchFault,
+                 pchFault.isEmpty() ? accentForStat(pchSeverity) : "warning");
+}
+
+// Cap nhat Detailed Readings tai cho: dung lai cac dong san co (chi them/xoa khi so
+// sensor doi), chi setText khi chu doi va chi polish lai pill khi muc nhiet doi.
+void MainWindow::updateDetailList(const QVector<TufGamingFx705ge::TemperatureSample> &samples) {
+  if (!m_detailListLayout) {
+    return;
+  }
+  while (m_detailLines.size() > samples.size()) {
+    delete m_detailLines.takeLast().line;
+  }
+  while (m_detailLines.size() < samples.size()) {
+    QWidget *line = createDetailLine(QString(), QString(), QString());
+    // Chen truoc stretch o cuoi danh sach.
+    m_detailListLayout->insertWidget(static_cast<int>(m_detailLines.size()), line);
+    m_detailLines.append({line, line->findChild<QLabel *>("detailLabel"),
+                          line->findChild<QLabel *>("pill")});
+  }
+
+  for (qsizetype i = 0; i < samples.size(); ++i) {
+    const TufGamingFx705ge::TemperatureSample &sample = samples[i];
+    const DetailLine &line = m_detailLines[i];
+    if (line.label->text() != sample.label) {
+      line.label->setText(sample.label);
+    }
+    const QString value = formatTemperature(sample.celsius);
+    if (line.pill->text() != value) {
+      line.pill->setText(value);
+    }
+    const QString severity = temperatureSeverity(sample.celsius);
+    if (line.pill->property("severity").toString() != severity) {
+      line.pill->setProperty("severity", severity);
+      line.pill->style()->unpolish(line.pill);
+      line.pill->style()->polish(line.pill);
+    }
+  }
+}
+
+// Ap dung profile cua quy tac tien trinh (ProcessProfileSwitcher); -1 = khong con tien
+// trinh khop, tra ve % nguoi dung da chon truoc khi quy tac dau tien ap dung.
+void MainWindow::applyProcessRule(int ruleIndex) {
+  m_ruleCurve.reset();
+  if (ruleIndex < 0) {
+    if (m_percentBeforeRule >= 0) {
+      qInfo("Het tien trinh khop quy tac, tra quat ve %d%%", m_percentBeforeRule);
+      setSliderPercent(m_percentBeforeRule);
+      syncModeButtonForPercent(m_percentBeforeRule);
+      applyPresetPercent(m_percentBeforeRule);
+    }
+    m_percentBeforeRule = -1;
+    return;
+  }
+
+  const ProcessRules::Rule &rule = m_profileSwitcher.rules().rule(ruleIndex);
+  qInfo("Quy tac tien trinh '%s' (dong %d): %s", qPrintable(rule.pattern), rule.line,
+        qPrintable(rule.policy.name));
+  if (m_percentBeforeRule < 0) {
+    m_percentBeforeRule = m_sliderPercent;
+  }
+
+  // % lay tu chinh sach da parse (FanPolicy, cung bang preset voi --simulate va nut Fan
+  // Mode); ten preset thi chon luon nut tuong ung.
+  if (rule.policy.kind == FanPolicy::Kind::Fixed) {
+    selectModeButton(modePercent(rule.policy.name) >= 0 ? rule.policy.name : QString("Custom"));
+    setSliderPercent(rule.policy.percent);
+    applyPresetPercent(rule.policy.percent);
+    return;
+  }
+  // Con lai la duong cong ('auto' bi ProcessRules tu choi).
+  selectModeButton("Custom");
+  m_ruleCurve = rule.policy;
+  m_lastCurvePercent = -1;
+  const TufGamingFx705ge::TemperatureSample cpuPackage = m_device.cpuPackageTemperature();
+  applyRuleCurve(cpuPackage.valid ? cpuPackage.celsius : std::numeric_limits<double>::quiet_NaN());
+}
+
+// Bam duong cong cua quy tac theo nhiet do CPU (da lam muot tu bus), co deadband % de
+// khong ghi EC moi lan nhiet doi. Sensor loi (NaN) thi giu % hien tai; FanWatchdog van
+// canh nhiet nguy hiem.
+void MainWindow::applyRuleCurve(double cpuTempC) {
+  if (!m_ruleCurve || std::isnan(cpuTempC)) {
+    return;
+  }
+  const int percent = m_ruleCurve->percentFor(cpuTempC);
+  if (m_lastCurvePercent >= 0 &&
+      std::abs(percent - m_lastCurvePercent) < FanPolicy::kCurveDeadbandPercent) {
+    return;
+  }
+  m_lastCurvePercent = percent;
+  setSliderPercent(percent);
+  applyPresetPercent(percent);
+}
+
+// Nguoi dung tu dat quat: bo duong cong/khoi phuc cua quy tac dang ap dung.
+void MainWindow::dropProcessRuleOverride() {
+  m_ruleCurve.reset();
+  m_percentBeforeRule = -1;
+}
+
 // Chon mot nut preset theo ten, chan phat sinh tin hieu khong mong muon tu
 // QButtonGroup.
 void MainWindow::selectModeButton(const QString &modeName) {
+  m_modeName = modeName;
   if (!m_modeGroup) {
     return;
   }
 
   for (QAbstractButton *button : m_modeGroup->buttons()) {
-    if (button && button->text().compare(modeName, Qt::CaseSensitive) == 0) {
+    if (button && button->text().compare(modeName, Qt::CaseInsensitive) == 0) {
       QSignalBlocker blocker(m_modeGroup);
       button->setChecked(true);
       return;
@@ -429,6 +883,134 @@ void MainWindow::selectModeButton(const QString &modeName) {
   }
 }
 
+// Tao icon khay (neu desktop ho tro): click de mo lai cua so, menu Show/Quit.
+void MainWindow::createTrayIcon() {
+  if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+    return;
+  }
+  m_trayIcon = new QSystemTrayIcon(this);
+  // Menu la con cua MainWindow (khong nam trong central widget) nen song qua teardownUi().
+  QMenu *menu = new QMenu(this);
+  menu->addAction("Show", this, &MainWindow::restoreFromTray);
+  menu->addAction("Quit", this, [this]() {
+    m_quitRequested = true;
+    QCoreApplication::quit();
+  });
+  m_trayIcon->setContextMenu(menu);
+  connect(m_trayIcon, &QSystemTrayIcon::activated, this,
+          [this](QSystemTrayIcon::ActivationReason reason) {
+            if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick) {
+              restoreFromTray();
+            }
+          });
+  updateTrayIcon();
+  m_trayIcon->show();
+  // Dong cua so chi la xuong khay; thoat bang menu Quit.
+  QApplication::setQuitOnLastWindowClosed(false);
+}
+
+// Icon ve nhiet do CPU tren nen mau theo muc nhiet, tooltip them RPM quat. Chi ve lai
+// khi so hien thi doi de khay khong bi cap nhat (va danh thuc) moi lan lay mau.
+void MainWindow::updateTrayIcon() {
+  if (!m_trayIcon) {
+    return;
+  }
+  const double cpuTemp = m_device.cpuPackageTempC();
+  const auto fan = m_device.fan();
+  const QString toolTip = "CPU " + formatTemperature(cpuTemp) + "\nFan " +
+                          (fan.rpmValid ? QString::number(fan.rpm) : QString("--")) + " RPM";
+  if (m_trayIcon->toolTip() != toolTip) {
+    m_trayIcon->setToolTip(toolTip);
+  }
+
+  const QString severity = temperatureSeverity(cpuTemp);
+  const QString text = QString::number(qRound(cpuTemp));
+  const QString key = text + ":" + severity;
+  if (key == m_trayIconKey) {
+    return;
+  }
+  m_trayIconKey = key;
+
+  QPixmap pixmap(32, 32);
+  pixmap.fill(Qt::transparent);
+  QPainter painter(&pixmap);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(trayColor(severity));
+  painter.drawRoundedRect(pixmap.rect(), 6, 6);
+  QFont font = painter.font();
+  font.setBold(true);
+  font.setPixelSize(18);
+  painter.setFont(font);
+  painter.setPen(Qt::white);
+  painter.drawText(pixmap.rect(), Qt::AlignCenter, text);
+  painter.end();
+  m_trayIcon->setIcon(QIcon(pixmap));
+}
+
+bool MainWindow::enterTrayMode() {
+  if (!m_trayIcon) {
+    return false;
+  }
+  if (m_trayMode) {
+    return true;
+  }
+  // So sanh duoc hai che do: log muc tieu thu cua khoang o cua so truoc khi huy UI.
+  const QString windowed = ProcessFootprint::sample().describeSince(m_modeFootprint);
+  if (isVisible()) {
+    m_savedGeometry = saveGeometry();
+  }
+  hide();
+  teardownUi();
+  m_trayMode = true;
+  m_modeFootprint = ProcessFootprint::sample();
+  qInfo("Xuong khay. Che do cua so: %s; sau khi huy UI: RSS %lld kB", qPrintable(windowed),
+        static_cast<long long>(m_modeFootprint.rssKb));
+  return true;
+}
+
+// Huy toan bo cay widget (the, scroll area, slider...) va stylesheet da parse; destroy()
+// tra cua so native cung backing store (~4 MB voi cua so 1120x890). Sampling, quy tac
+// tien trinh, actor ghi PWM va watchdog khong phu thuoc widget nen van chay.
+void MainWindow::teardownUi() {
+  delete takeCentralWidget();
+  m_cpuCard = nullptr;
+  m_fanCard = nullptr;
+  m_pchCard = nullptr;
+  m_detailListLayout = nullptr;
+  m_detailLines.clear();
+  m_fixedSpeedValueLabel = nullptr;
+  m_fixedSpeedSlider = nullptr;
+  m_modeGroup = nullptr;  // Con cua the Fan Mode, da bi xoa cung central widget.
+  m_overheadLines.clear();
+  m_overheadThreadsLabel = nullptr;
+  setStyleSheet(QString());
+  destroy();
+  QPixmapCache::clear();
+  ProcessFootprint::releaseFreedHeap();
+}
+
+// Dung lai UI tu cache sensor moi nhat va trang thai slider/nut da giu lai.
+void MainWindow::restoreFromTray() {
+  if (m_trayMode) {
+    const ProcessFootprint now = ProcessFootprint::sample();
+    qInfo("Mo lai cua so. Che do khay: %s", qPrintable(now.describeSince(m_modeFootprint)));
+    m_trayMode = false;
+    const QString modeName = m_modeName;
+    buildUi();
+    applyStyleSheet();
+    selectModeButton(modeName);
+    updateStatCards();
+    if (!m_savedGeometry.isEmpty()) {
+      restoreGeometry(m_savedGeometry);
+    }
+    m_modeFootprint = now;
+  }
+  show();
+  raise();
+  activateWindow();
+}
+
 void MainWindow::applyStyleSheet() {
   // Thu nap file CSS tu cac duong dan kha nang nhat de ho tro chay trong build dir.
   const QString stylePath = resolveStylePath();
@@ -479,6 +1061,15 @@ void MainWindow::centerOnScreen() {
   move(x, y);
 }
 
+void MainWindow::closeEvent(QCloseEvent *event) {
+  // Co khay thi dong cua so nghia la xuong khay, tru khi dang thoat bang menu Quit.
+  if (!m_quitRequested && enterTrayMode()) {
+    event->ignore();
+    return;
+  }
+  QMainWindow::closeEvent(event);
+}
+
 void MainWindow::showEvent(QShowEvent *event) {
   // Chi can giua cua so ngay lan hien dau tien de tranh tinh toan nhieu lan.
   QMainWindow::showEvent(event);
@@ -532,7 +1123,7 @@ QString MainWindow::accentForStat(const QString &severity) const {
   return "ok";
 }
 
-void MainWindow::showPwmErrorDialog(const QString &title) {
+void MainWindow::showPwmErrorDialog(const QString &title, const QString &reason) {
   // Thong bao loi PWM chi mot lan de tranh lam phien nguoi dung.
   if (m_shownPwmErrorDialog) {
     return;
@@ -540,9 +1131,14 @@ void MainWindow::showPwmErrorDialog(const QString &title) {
   m_shownPwmErrorDialog = true;
 
   const QString detail =
-      m_device.lastError().isEmpty()
+      reason.isEmpty()
           ? "Kiem tra quyen truy cap /sys/class/hwmon/*/pwm1 va pwm1_enable (can sudo/root)."
-          : m_device.lastError();
+          : reason;
+  if (m_trayMode) {
+    // Cua so da bi huy: bao qua khay thay vi mo hop thoai khong co cha.
+    m_trayIcon->showMessage(title, detail, QSystemTrayIcon::Warning);
+    return;
+  }
 
   QMessageBox::warning(
       this, title,
@@ -3,6 +3,8 @@
 
 #include <QAbstractButton>
 #include <QButtonGroup>
+#include <QByteArray>
+#include <QCloseEvent>
 #include <QComboBox>
 #include <QCoreApplication>
 #include <QDebug>
@@ -21,28 +23,57 @@
 #include <QSignalBlocker>
 #include <QSize>
 #include <QSlider>
+#include <QSystemTrayIcon>
 #include <QStringList>
+#include <QTimer>
 #include <QVBoxLayout>
+#include <QVector>
 #include <QtGlobal>
 
 #include <algorithm>
+#include <array>
+#include <optional>
 
+#include "fan_command_actor.h"
+#include "fan_policy.h"
+#include "fan_watchdog.h"
 #include "main.h"
+#include "process_footprint.h"
+#include "process_profile_switcher.h"
+#include "self_overhead.h"
+#include "sensor_sampler.h"
 #include "tuf_gaming_fx705ge.h"
 
+class QCloseEvent;
 class QShowEvent;
 
 // MainWindow dong vai tro la cua so chinh gom toan bo bang dieu khien
 // quan ly quat. Mo ta layout, tao widget con va nap stylesheet.
 class MainWindow : public QMainWindow {
   Q_OBJECT
+  // Do hieu nang UI (tests/ui_bench) goi truc tiep cac ham cap nhat voi du lieu tong hop.
+  friend class UiBench;
 
  public:
+  // Cac phan noi voi phan cung/he thong, mac dinh bat het. UiBench tat ca ba de chi do
+  // widget voi du lieu tong hop, khong ghi PWM hay theo doi tien trinh.
+  struct Options {
+    bool liveSensors = true;   // Nhan mau tu SensorSampler/SensorBus.
+    bool fanWatchdog = true;   // Bat FanWatchdog va heartbeat.
+    bool processRules = true;  // ProcessProfileSwitcher theo rules.conf.
+  };
+
   explicit MainWindow(QWidget *parent = nullptr);
-  ~MainWindow() override = default;
+  explicit MainWindow(const Options &options, QWidget *parent = nullptr);
+  ~MainWindow() override;
+
+  // An cua so xuong khay he thong va giai phong cay widget; false neu desktop khong
+  // co system tray (khi do cua so phai duoc hien binh thuong).
+  bool enterTrayMode();
 
  protected:
   void showEvent(QShowEvent *event) override;
+  void closeEvent(QCloseEvent *event) override;
 
  private:
   // Cac ham tao cac khu vuc UI rieng le de code ro rang va de dieu chinh.
@@ -53,6 +84,7 @@ class MainWindow : public QMainWindow {
   QWidget *createFanModeRow();
   QWidget *createProfilesRow();
   QWidget *createFixedSpeedRow();
+  QWidget *createDiagnosticsRow();
 
   // Ham tro giup tao cac thanh phan nho hon.
   QFrame *createStatCard(const QString &iconText, const QString &title,
@@ -60,12 +92,36 @@ class MainWindow : public QMainWindow {
                          const QString &accentProperty);
   QWidget *createDetailLine(const QString &label, const QString &value,
                             const QString &severityProperty);
+  void updateStatCard(QFrame *card, const QString &valueText, const QString &statusText,
+                      const QString &accentProperty);
 
   // Xu ly tuong tac preset va dong bo slider.
   void handleModeSelected(int buttonId);
   void applyPresetPercent(int percent);
   void syncModeButtonForPercent(int percent);
   void selectModeButton(const QString &modeName);
+  int modePercent(const QString &modeName) const;
+  void setSliderPercent(int percent);
+  void handleFanCommandFinished(const TufGamingFx705ge::FanCommandResult &result);
+  void subscribeSensorBus();
+  void handleSensorsSampled();
+  void handleSensorsChanged();
+  void sampleOverhead();
+  void updateDiagnostics();
+  void updateStatCards();
+  void updateStatCards(double cpuTempC, const TufGamingFx705ge::FanSample &fan, double pchTempC,
+                       const QVector<SensorAnomalyDetector::Event> &faults);
+  void updateDetailList(const QVector<TufGamingFx705ge::TemperatureSample> &samples);
+  void applyProcessRule(int ruleIndex);
+  void applyRuleCurve(double cpuTempC);
+  void dropProcessRuleOverride();
+  void armFanWatchdog();
+
+  // Che do khay: huy/dung lai cay widget, cap nhat icon khay theo mau moi nhat.
+  void createTrayIcon();
+  void updateTrayIcon();
+  void teardownUi();
+  void restoreFromTray();
 
   // Xu ly stylesheet va can giua man hinh.
   void applyStyleSheet();
@@ -77,18 +133,65 @@ class MainWindow : public QMainWindow {
   QString temperatureSeverity(double tempC) const;
   QString statusTextForSeverity(const QString &severity) const;
   QString accentForStat(const QString &severity) const;
-  void showPwmErrorDialog(const QString &title);
+  void showPwmErrorDialog(const QString &title, const QString &reason);
 
   // Trang thai noi bo.
   bool m_hasCentered = false;            // Dam bao chi can giua mot lan khi hien.
+  QFrame *m_cpuCard = nullptr;               // Cac the thong ke cap nhat moi lan lay mau.
+  QFrame *m_fanCard = nullptr;
+  QFrame *m_pchCard = nullptr;
+  struct DetailLine {
+    QWidget *line;
+    QLabel *label;
+    QLabel *pill;
+  };
+  QVBoxLayout *m_detailListLayout = nullptr;  // Danh sach Detailed Readings (cuoi la stretch).
+  QVector<DetailLine> m_detailLines;         // Dung lai moi lan cap nhat.
   QLabel *m_fixedSpeedValueLabel = nullptr;  // Hien thi % cua slider.
   QSlider *m_fixedSpeedSlider = nullptr;     // Dieu khien toc do co dinh.
   QButtonGroup *m_modeGroup = nullptr;       // Nhom nut chon che do quat.
   bool m_updatingFromPreset = false;         // Co de bo qua set Custom khi set bang code.
   bool m_shownPwmErrorDialog = false;        // Chi hien canh bao quyen PWM mot lan.
+  QString m_pendingCommandTitle;             // Tieu de canh bao cho lenh quat gan nhat.
+  int m_percentBeforeRule = -1;              // % nguoi dung chon truoc khi quy tac ap dung.
+  std::optional<FanPolicy> m_ruleCurve;      // Duong cong cua quy tac dang ap dung (neu co).
+  int m_lastCurvePercent = -1;               // % gan nhat da gui theo duong cong.
+  int m_sliderPercent = 0;                   // Gia tri slider, giu ca khi UI da bi huy.
+  QString m_modeName;                        // Nut Fan Mode dang chon, de dung lai UI.
+
+  QSystemTrayIcon *m_trayIcon = nullptr;     // Null neu desktop khong co system tray.
+  bool m_trayMode = false;                   // Cua so da dong, chi con icon khay.
+  QString m_trayIconKey;                     // Noi dung icon dang ve, tranh ve lai thua.
+  QByteArray m_savedGeometry;                // Vi tri cua so truoc khi xuong khay.
+  bool m_quitRequested = false;              // Quit tu menu khay: closeEvent khong chan.
+  ProcessFootprint m_modeFootprint;          // Anh chup luc doi che do, do RSS/wakeup.
+
+  // Watchdog tra quat ve tu dong khi GUI treo/crash; khai bao truoc m_device va
+  // m_fanActor de chi disarm sau khi actor da dung ghi PWM.
+  FanWatchdog m_watchdog;
+  QTimer m_heartbeatTimer;  // Gui heartbeat tu event loop GUI.
 
   // Lop doc sensor/dieu khien quat tach rieng ra core/.
   TufGamingFx705ge m_device;
+
+  // Thuc thi lenh ghi PWM tren thread rieng; khai bao sau m_device de huy truoc no.
+  FanCommandActor m_fanActor{m_device};
+
+  // Refresh sensor va phat hien loi dinh ky ngoai thread GUI; cung huy truoc m_device.
+  SensorSampler m_sampler{m_device};
+  int m_uiSubscription = 0;     // Id consumer SensorBus cua the/icon khay.
+  int m_curveSubscription = 0;  // Id consumer SensorBus cua duong cong quy tac.
+
+  // Chi phi cua chinh app (panel Diagnostics); khai bao sau m_sampler vi lay bo dem cua no.
+  SelfOverhead m_overhead;
+  SelfOverhead::Report m_lastOverhead;
+  std::array<bool, SelfOverhead::kMetricCount> m_overheadExceeded{};
+  int m_samplesSinceOverhead = 0;
+  QVector<DetailLine> m_overheadLines;       // Mot dong moi chi so, trong khi UI bi huy.
+  QLabel *m_overheadThreadsLabel = nullptr;
+
+  // Chuyen profile khi tien trinh trong rules.conf chay/thoat (proc connector).
+  ProcessProfileSwitcher m_profileSwitcher;
 };
 
 #endif  // FANS_CONTROLLER_MAINWINDOW_H